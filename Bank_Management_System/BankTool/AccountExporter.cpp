@@ -0,0 +1,151 @@
+#include "AccountExporter.h"
+#include "DataBaseShard.h"
+#include "JsonFileEngine.h"
+
+// Number of accounts formatted together by one thread
+static const qint32 ChunkAccounts = 1024;
+
+// Constructor: Sets the data directory and the number of shards to read
+AccountExporter::AccountExporter(const QString &dataDir, qint32 shardCount)
+    : dir{dataDir}, shards{qMax(shardCount, 1)}, exportedRows{0}, err{stderr}
+{
+    ToolLogs = new Logger("Logs/BankToolLogs.txt");
+}
+
+AccountExporter::~AccountExporter()
+{
+    delete ToolLogs;
+}
+
+// Exports the accounts of every shard file
+bool AccountExporter::exportTo(const QString &outputFile, bool csv, const QString &historyFile)
+{
+    QSaveFile output(outputFile);
+    QSaveFile history(historyFile);
+    bool withHistory = csv && !historyFile.isEmpty();
+
+    if (!output.open(QIODevice::WriteOnly) || (withHistory && !history.open(QIODevice::WriteOnly)))
+    {
+        err << "Cannot open the output files" << Qt::endl;
+        return false;
+    }
+
+    if (csv)
+    {
+        output.write("UserName,FullName,AccountNumber,Age,Password,IsAdmin,AccountBalance\n");
+        if (withHistory)
+        {
+            history.write("AccountNumber,Date,Time,Type,Amount\n");
+        }
+    }
+
+    for (qint32 i = 0; i < shards; i++)
+    {
+        QString fileName = dir.filePath(DataBaseShard::shardFileName(i));
+        if (!QFile::exists(fileName))
+        {
+            continue; // A shard without accounts has no file yet
+        }
+
+        QJsonObject table;
+        if (JsonFileEngine::readDataBase(fileName, table, ToolLogs) != 0)
+        {
+            err << "Cannot read " << fileName << Qt::endl;
+            return false;
+        }
+
+        // Split the shard into chunks, one task each
+        QList<QList<QPair<QString, QJsonObject>>> chunks;
+        for (auto it = table.constBegin(); it != table.constEnd(); ++it)
+        {
+            if (chunks.isEmpty() || (chunks.last().size() == ChunkAccounts))
+            {
+                chunks.append(QList<QPair<QString, QJsonObject>>());
+            }
+            chunks.last().append(qMakePair(it.key(), it.value().toObject()));
+        }
+        table = QJsonObject(); // The chunks share the account data
+
+        QList<Output> formatted = QtConcurrent::blockingMapped<QList<Output>>(chunks, [csv](const QList<QPair<QString, QJsonObject>> &chunk) {
+            return format(chunk, csv);
+        });
+
+        for (const Output &part : formatted)
+        {
+            output.write(part.accounts);
+            if (withHistory)
+            {
+                history.write(part.history);
+            }
+        }
+
+        for (const auto &chunk : chunks)
+        {
+            exportedRows += chunk.size();
+        }
+    }
+
+    // Only replace the output files once everything was written
+    if (!output.commit() || (withHistory && !history.commit()))
+    {
+        err << "Cannot write the output files" << Qt::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// Returns the number of accounts exported
+qint64 AccountExporter::exported() const
+{
+    return exportedRows;
+}
+
+// Formats a chunk of accounts as CSV rows or as JSON lines
+AccountExporter::Output AccountExporter::format(const QList<QPair<QString, QJsonObject>> &chunk, bool csv)
+{
+    Output out;
+
+    for (const auto &entry : chunk)
+    {
+        const QJsonObject &account = entry.second;
+
+        if (!csv)
+        {
+            QJsonObject line = account;
+            line["UserName"] = entry.first;
+            out.accounts += QJsonDocument(line).toJson(QJsonDocument::Compact) + '\n';
+            continue;
+        }
+
+        QString accountNumber = account.value("AccountNumber").toString();
+        out.accounts += csvField(entry.first) + ',' + csvField(account.value("FullName").toString()) + ','
+                        + csvField(accountNumber) + ',' + csvField(account.value("Age").toString()) + ','
+                        + csvField(account.value("Password").toString()) + ','
+                        + (account.value("IsAdmin").toBool() ? "true" : "false") + ','
+                        + csvField(account.value("AccountBalance").toString()) + '\n';
+
+        for (const QJsonValue &value : account.value("TransactionHistory").toArray())
+        {
+            QJsonObject transaction = value.toObject();
+            out.history += csvField(accountNumber) + ',' + csvField(transaction.value("Date").toString()) + ','
+                           + csvField(transaction.value("Time").toString()) + ','
+                           + csvField(transaction.value("Type").toString()) + ','
+                           + csvField(transaction.value("Amount").toString()) + '\n';
+        }
+    }
+
+    return out;
+}
+
+// Quotes a CSV field holding a comma, a quote or a line break
+QByteArray AccountExporter::csvField(const QString &value)
+{
+    QByteArray field = value.toUtf8();
+    if (field.contains(',') || field.contains('"') || field.contains('\n'))
+    {
+        field.replace("\"", "\"\"");
+        field = '"' + field + '"';
+    }
+    return field;
+}
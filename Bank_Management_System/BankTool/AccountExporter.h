@@ -0,0 +1,61 @@
+#ifndef ACCOUNTEXPORTER_H
+#define ACCOUNTEXPORTER_H
+
+#include <QString>          // Includes the QString class for the file names and fields
+#include <QByteArray>       // Includes the QByteArray class for the formatted output
+#include <QList>            // Includes the QList class for the chunks of accounts
+#include <QFile>            // Includes the QFile class for writing the output files
+#include <QSaveFile>        // Includes the QSaveFile class for atomic file writes
+#include <QDir>             // Includes the QDir class for the data directory
+#include <QJsonDocument>    // Includes the QJsonDocument class for serializing accounts
+#include <QJsonObject>      // Includes the QJsonObject class for the accounts
+#include <QJsonArray>       // Includes the QJsonArray class for the transaction histories
+#include <QTextStream>      // Includes the QTextStream class for the error messages
+#include <QtConcurrent>     // Includes QtConcurrent for formatting accounts in parallel
+#include "Logger.h"
+
+// The AccountExporter class writes the accounts of the server's shard files to a CSV or JSONL file.
+// Shards are loaded one at a time and their accounts are formatted on all cores,
+// so only one shard is held in memory at once.
+// CSV output uses the columns read by AccountImporter, with the transaction history in a second
+// CSV file if one is given. Passwords are exported as their stored hashes.
+class AccountExporter
+{
+public:
+    // Constructor to set the data directory and the number of shards to read.
+    AccountExporter(const QString &dataDir, qint32 shardCount);
+    ~AccountExporter();
+
+    // Delete the copy constructor and the assignment operator to prevent copying.
+    AccountExporter(const AccountExporter&) = delete;
+    AccountExporter& operator=(const AccountExporter&) = delete;
+
+    // Method to export the accounts; historyFile is only used for CSV output.
+    // Returns false if a shard or an output file could not be read or written.
+    bool exportTo(const QString &outputFile, bool csv, const QString &historyFile);
+
+    // Method to get the number of accounts exported.
+    qint64 exported() const;
+
+private:
+    // The formatted lines of a chunk of accounts.
+    struct Output
+    {
+        QByteArray accounts;
+        QByteArray history;
+    };
+
+    // Method to format a chunk of accounts as CSV or JSONL lines.
+    static Output format(const QList<QPair<QString, QJsonObject>> &chunk, bool csv);
+
+    // Method to quote a CSV field if needed.
+    static QByteArray csvField(const QString &value);
+
+    QDir dir; // Directory holding the shard files.
+    qint32 shards; // Number of shards to read.
+    qint64 exportedRows; // Number of accounts exported.
+    Logger *ToolLogs; // Logger used when reading the shard files.
+    QTextStream err; // Standard error, for the failures.
+};
+
+#endif // ACCOUNTEXPORTER_H
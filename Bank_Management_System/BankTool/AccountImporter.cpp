@@ -0,0 +1,338 @@
+#include "AccountImporter.h"
+#include "DataBaseShard.h"
+#include "PasswordHasher.h"
+
+// Number of lines parsed together by one thread, and number of such chunks read before parsing
+static const qint32 ChunkLines = 1024;
+static const qint32 BlockChunks = 64;
+
+// Constructor: Sets the data directory and the number of shards to write
+AccountImporter::AccountImporter(const QString &dataDir, qint32 shardCount)
+    : dir{dataDir}, shards{qMax(shardCount, 1)}, importedRows{0}, skippedRows{0}, err{stderr}
+{
+}
+
+// Imports an input file into freshly written shard files
+bool AccountImporter::import(const QString &inputFile, bool csv, const QString &historyFile)
+{
+    QFile input(inputFile);
+    if (!input.open(QIODevice::ReadOnly))
+    {
+        err << "Cannot open " << inputFile << Qt::endl;
+        return false;
+    }
+
+    if (csv && !historyFile.isEmpty() && !loadHistory(historyFile))
+    {
+        return false;
+    }
+
+    // The first line of a CSV file names its columns
+    qint64 lineNumber = 0;
+    if (csv)
+    {
+        QStringList header = splitCsv(input.readLine().trimmed());
+        lineNumber++;
+        for (qint32 i = 0; i < header.size(); i++)
+        {
+            columns.insert(header[i].trimmed(), i);
+        }
+        if (!columns.contains("UserName") || !columns.contains("AccountNumber") || !columns.contains("Password"))
+        {
+            err << "The CSV header must name at least the UserName, AccountNumber and Password columns" << Qt::endl;
+            return false;
+        }
+    }
+
+    // Open a writer for every shard; the files only replace the old ones on commit
+    for (qint32 i = 0; i < shards; i++)
+    {
+        writers.push_back(std::make_unique<ShardWriter>(dir.filePath(DataBaseShard::shardFileName(i))));
+        if (!writers.back()->open())
+        {
+            err << "Cannot write " << DataBaseShard::shardFileName(i) << ": " << writers.back()->errorString() << Qt::endl;
+            return false;
+        }
+    }
+
+    // Read the input a block at a time and hand each block to the parser threads
+    QList<QByteArray> block;
+    qint64 blockStart = lineNumber + 1;
+    while (!input.atEnd())
+    {
+        block.append(input.readLine());
+        lineNumber++;
+
+        if (block.size() == ChunkLines * BlockChunks)
+        {
+            if (!flushBlock(block, blockStart, csv))
+            {
+                return false;
+            }
+            block.clear();
+            blockStart = lineNumber + 1;
+        }
+    }
+    if (!flushBlock(block, blockStart, csv))
+    {
+        return false;
+    }
+
+    // Close every shard file and rename it into place
+    for (qint32 i = 0; i < shards; i++)
+    {
+        if (!writers[i]->commit())
+        {
+            err << "Cannot write " << DataBaseShard::shardFileName(i) << ": " << writers[i]->errorString() << Qt::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Returns the number of accounts imported
+qint64 AccountImporter::imported() const
+{
+    return importedRows;
+}
+
+// Returns the number of rows skipped
+qint64 AccountImporter::skipped() const
+{
+    return skippedRows;
+}
+
+// Loads the transactions of a history CSV file and groups them by account number
+bool AccountImporter::loadHistory(const QString &historyFile)
+{
+    QFile input(historyFile);
+    if (!input.open(QIODevice::ReadOnly))
+    {
+        err << "Cannot open " << historyFile << Qt::endl;
+        return false;
+    }
+
+    QHash<QString, qint32> header;
+    QStringList names = splitCsv(input.readLine().trimmed());
+    for (qint32 i = 0; i < names.size(); i++)
+    {
+        header.insert(names[i].trimmed(), i);
+    }
+    if (!header.contains("AccountNumber"))
+    {
+        err << "The history CSV header must name the AccountNumber column" << Qt::endl;
+        return false;
+    }
+
+    while (!input.atEnd())
+    {
+        QByteArray line = input.readLine().trimmed();
+        if (line.isEmpty())
+        {
+            continue;
+        }
+
+        QStringList fields = splitCsv(line);
+        QJsonObject transaction;
+        for (const QString &name : {"Date", "Time", "Type", "Amount"})
+        {
+            transaction[name] = fields.value(header.value(name, -1));
+        }
+        histories[fields.value(header.value("AccountNumber"))].append(transaction);
+    }
+
+    return true;
+}
+
+// Parses one CSV line into a row
+AccountImporter::Row AccountImporter::parseCsv(qint64 lineNumber, const QByteArray &line) const
+{
+    QStringList fields = splitCsv(line);
+    auto field = [&](const QString &name) { return fields.value(columns.value(name, -1)).trimmed(); };
+
+    QJsonObject account;
+    account["FullName"] = field("FullName");
+    account["AccountNumber"] = field("AccountNumber");
+    account["Age"] = field("Age");
+    account["Password"] = field("Password");
+    account["IsAdmin"] = (field("IsAdmin").compare("true", Qt::CaseInsensitive) == 0) || (field("IsAdmin") == "1");
+    account["AccountBalance"] = field("AccountBalance").isEmpty() ? QString("0") : field("AccountBalance");
+    account["TransactionHistory"] = histories.value(field("AccountNumber"));
+
+    return makeRow(lineNumber, field("UserName"), account);
+}
+
+// Parses one JSONL line into a row
+AccountImporter::Row AccountImporter::parseJson(qint64 lineNumber, const QByteArray &line) const
+{
+    QJsonParseError jError;
+    QJsonDocument doc = QJsonDocument::fromJson(line, &jError);
+    if ((jError.error != QJsonParseError::NoError) || !doc.isObject())
+    {
+        return Row{lineNumber, QString(), QString(), QByteArray(), "invalid JSON"};
+    }
+
+    QJsonObject account = doc.object();
+    QString userName = account.value("UserName").toString();
+    account.remove("UserName"); // The username is the key of the account in the shard file
+
+    // The server keeps these fields as strings; accept numbers as well. The default format of
+    // QString::number() keeps 6 digits, so whole numbers are written as integers and the balance
+    // with as many decimals as it needs, never in exponent notation.
+    for (const QString &name : {"AccountNumber", "Age"})
+    {
+        if (account.value(name).isDouble())
+        {
+            account[name] = QString::number(static_cast<qint64>(account.value(name).toDouble()));
+        }
+    }
+    if (account.value("AccountBalance").isDouble())
+    {
+        account["AccountBalance"] = QString::number(account.value("AccountBalance").toDouble(), 'f', QLocale::FloatingPointShortest);
+    }
+    if (!account.contains("AccountBalance"))
+    {
+        account["AccountBalance"] = "0";
+    }
+    if (!account.value("TransactionHistory").isArray())
+    {
+        account["TransactionHistory"] = QJsonArray();
+    }
+    account["IsAdmin"] = account.value("IsAdmin").toBool();
+
+    return makeRow(lineNumber, userName, account);
+}
+
+// Checks the required fields, hashes the password and serializes the account as a shard file member
+AccountImporter::Row AccountImporter::makeRow(qint64 lineNumber, const QString &userName, QJsonObject account) const
+{
+    Row row{lineNumber, userName, account.value("AccountNumber").toString(), QByteArray(), QString()};
+
+    if (userName.isEmpty() || row.accountNumber.isEmpty() || account.value("Password").toString().isEmpty())
+    {
+        row.error = "missing UserName, AccountNumber or Password";
+        return row;
+    }
+
+    // Exported databases already carry hashes; everything else is hashed like CreateUser does
+    QString password = account.value("Password").toString();
+    if (!password.startsWith("pbkdf2-sha256$"))
+    {
+        account["Password"] = PasswordHasher::hash(password);
+    }
+
+    // Serialize {"<username>":{...}} and drop the outer braces to get the member
+    QJsonObject member;
+    member.insert(userName, account);
+    QByteArray doc = QJsonDocument(member).toJson(QJsonDocument::Compact);
+    row.entry = doc.mid(1, doc.size() - 2);
+    return row;
+}
+
+// Parses a block of lines in parallel, then streams the rows into their shards in input order
+bool AccountImporter::flushBlock(const QList<QByteArray> &lines, qint64 firstLine, bool csv)
+{
+    // Split the block into chunks, one task each
+    QList<QPair<qint64, QList<QByteArray>>> chunks;
+    for (qint32 i = 0; i < lines.size(); i += ChunkLines)
+    {
+        chunks.append(qMakePair(firstLine + i, lines.mid(i, ChunkLines)));
+    }
+
+    QList<QList<Row>> parsed = QtConcurrent::blockingMapped<QList<QList<Row>>>(chunks, [this, csv](const QPair<qint64, QList<QByteArray>> &chunk) {
+        QList<Row> rows;
+        for (qint32 i = 0; i < chunk.second.size(); i++)
+        {
+            QByteArray line = chunk.second[i].trimmed();
+            if (!line.isEmpty())
+            {
+                rows.append(csv ? parseCsv(chunk.first + i, line) : parseJson(chunk.first + i, line));
+            }
+        }
+        return rows;
+    });
+
+    // Duplicates are only known once all earlier rows were seen, so this part runs in order
+    for (const QList<Row> &rows : parsed)
+    {
+        for (const Row &row : rows)
+        {
+            QString error = row.error;
+            if (error.isEmpty() && userNames.contains(row.userName))
+            {
+                error = "duplicate UserName " + row.userName;
+            }
+            else if (error.isEmpty() && accountNumbers.contains(row.accountNumber))
+            {
+                error = "duplicate AccountNumber " + row.accountNumber;
+            }
+
+            if (!error.isEmpty())
+            {
+                err << "Line " << row.lineNumber << " skipped: " << error << Qt::endl;
+                skippedRows++;
+                continue;
+            }
+
+            userNames.insert(row.userName);
+            accountNumbers.insert(row.accountNumber);
+
+            ShardWriter *writer = writers[DataBaseShard::shardOf(row.accountNumber, shards)].get();
+            if (!writer->append(row.entry))
+            {
+                err << "Cannot write the shard files: " << writer->errorString() << Qt::endl;
+                return false;
+            }
+            importedRows++;
+        }
+    }
+
+    return true;
+}
+
+// Splits a CSV line into fields; quoted fields may hold commas and doubled quotes
+QStringList AccountImporter::splitCsv(const QByteArray &line)
+{
+    QStringList fields;
+    QString text = QString::fromUtf8(line);
+    QString field;
+    bool quoted = false;
+
+    for (qsizetype i = 0; i < text.size(); i++)
+    {
+        QChar c = text[i];
+        if (quoted)
+        {
+            if ((c == '"') && (i + 1 < text.size()) && (text[i + 1] == '"'))
+            {
+                field += '"'; // Escaped quote
+                i++;
+            }
+            else if (c == '"')
+            {
+                quoted = false;
+            }
+            else
+            {
+                field += c;
+            }
+        }
+        else if (c == '"')
+        {
+            quoted = true;
+        }
+        else if (c == ',')
+        {
+            fields.append(field);
+            field.clear();
+        }
+        else
+        {
+            field += c;
+        }
+    }
+    fields.append(field);
+
+    return fields;
+}
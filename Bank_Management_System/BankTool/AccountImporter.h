@@ -0,0 +1,85 @@
+#ifndef ACCOUNTIMPORTER_H
+#define ACCOUNTIMPORTER_H
+
+#include <QString>          // Includes the QString class for the file names and fields
+#include <QStringList>      // Includes the QStringList class for the CSV fields
+#include <QByteArray>       // Includes the QByteArray class for the input lines
+#include <QList>            // Includes the QList class for the blocks of lines
+#include <QHash>            // Includes the QHash class for the CSV columns and the transaction histories
+#include <QSet>             // Includes the QSet class for detecting duplicate accounts
+#include <QFile>            // Includes the QFile class for reading the input files
+#include <QDir>             // Includes the QDir class for the data directory
+#include <QJsonDocument>    // Includes the QJsonDocument class for parsing and serializing accounts
+#include <QJsonObject>      // Includes the QJsonObject class for the accounts
+#include <QJsonArray>       // Includes the QJsonArray class for the transaction histories
+#include <QTextStream>      // Includes the QTextStream class for the progress and error messages
+#include <QLocale>          // Includes QLocale::FloatingPointShortest for formatting imported balances
+#include <QtConcurrent>     // Includes QtConcurrent for parsing blocks of lines in parallel
+#include <memory>           // Includes smart pointers such as std::unique_ptr
+#include <vector>           // Includes std::vector for the shard writers
+#include "ShardWriter.h"
+
+// The AccountImporter class bulk-loads accounts from a CSV or JSONL file into the server's shard files.
+// The input is read in blocks of lines; the lines of a block are parsed and their passwords hashed
+// on all cores, then each account is streamed into the file of its shard, so memory use does not
+// grow with the size of the input.
+//
+// CSV files start with a header naming the columns:
+//   UserName,FullName,AccountNumber,Age,Password,IsAdmin,AccountBalance
+// and their transaction history may come from a second CSV file with the columns:
+//   AccountNumber,Date,Time,Type,Amount
+// JSONL files hold one account object per line, with its UserName and its TransactionHistory.
+class AccountImporter
+{
+public:
+    // Constructor to set the data directory and the number of shards to write.
+    AccountImporter(const QString &dataDir, qint32 shardCount);
+
+    // Method to import an input file; historyFile is only used for CSV input.
+    // Returns false if the shard files could not be written.
+    bool import(const QString &inputFile, bool csv, const QString &historyFile);
+
+    // Method to get the number of accounts imported and the number of rows skipped.
+    qint64 imported() const;
+    qint64 skipped() const;
+
+private:
+    // The result of parsing one input line.
+    struct Row
+    {
+        qint64 lineNumber;
+        QString userName;
+        QString accountNumber;
+        QByteArray entry; // Serialized "<username>":{...} member of the shard file.
+        QString error; // Reason the row is skipped, empty if it is valid.
+    };
+
+    // Method to load the transaction histories of a CSV import, keyed by account number.
+    bool loadHistory(const QString &historyFile);
+
+    // Methods to parse one line of the input into a row.
+    Row parseCsv(qint64 lineNumber, const QByteArray &line) const;
+    Row parseJson(qint64 lineNumber, const QByteArray &line) const;
+
+    // Method to normalize an account, hash its password and serialize it.
+    Row makeRow(qint64 lineNumber, const QString &userName, QJsonObject account) const;
+
+    // Method to parse a block of lines in parallel and stream the valid rows into their shards.
+    bool flushBlock(const QList<QByteArray> &lines, qint64 firstLine, bool csv);
+
+    // Method to split a CSV line into its fields.
+    static QStringList splitCsv(const QByteArray &line);
+
+    QDir dir; // Directory holding the shard files.
+    qint32 shards; // Number of shards to write.
+    std::vector<std::unique_ptr<ShardWriter>> writers; // Writer of each shard file.
+    QHash<QString, qint32> columns; // Index of each CSV column.
+    QHash<QString, QJsonArray> histories; // Transaction histories of a CSV import.
+    QSet<QString> userNames; // Usernames imported so far.
+    QSet<QString> accountNumbers; // Account numbers imported so far.
+    qint64 importedRows; // Number of accounts imported.
+    qint64 skippedRows; // Number of rows skipped.
+    QTextStream err; // Standard error, for the skipped rows.
+};
+
+#endif // ACCOUNTIMPORTER_H
@@ -0,0 +1,38 @@
+QT = core
+QT += concurrent network
+
+CONFIG += c++17 cmdline
+
+# The tool writes and reads the server's shard files, so it shares the storage code of the server
+INCLUDEPATH += ../Server
+
+# You can make your code fail to compile if it uses deprecated APIs.
+# In order to do so, uncomment the following line.
+#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
+
+SOURCES += \
+        AccountExporter.cpp \
+        AccountImporter.cpp \
+        ShardWriter.cpp \
+        main.cpp \
+        ../Server/Checkpointer.cpp \
+        ../Server/DataBaseShard.cpp \
+        ../Server/JsonFileEngine.cpp \
+        ../Server/Logger.cpp \
+        ../Server/PasswordHasher.cpp
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
+
+HEADERS += \
+    AccountExporter.h \
+    AccountImporter.h \
+    ShardWriter.h \
+    ../Server/Checkpointer.h \
+    ../Server/DataBaseShard.h \
+    ../Server/JsonFileEngine.h \
+    ../Server/Logger.h \
+    ../Server/PasswordHasher.h \
+    ../Server/StorageEngine.h
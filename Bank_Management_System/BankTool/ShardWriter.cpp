@@ -0,0 +1,70 @@
+#include "ShardWriter.h"
+#include "JsonFileEngine.h"
+
+// Constructor: Sets the shard file to write
+ShardWriter::ShardWriter(const QString &fileName)
+    : saveFile{fileName}, checksum{QCryptographicHash::Sha256}, entries{0}
+{
+}
+
+// Opens the temporary file and starts the JSON object
+bool ShardWriter::open()
+{
+    if (!saveFile.open(QIODevice::WriteOnly))
+    {
+        return false;
+    }
+    return write("{\n");
+}
+
+// Adds one account member, separated from the previous one by a comma
+bool ShardWriter::append(const QByteArray &entry)
+{
+    if ((entries > 0) && !write(",\n"))
+    {
+        return false;
+    }
+
+    entries++;
+    return write(entry);
+}
+
+// Closes the JSON object and writes the same checksum trailer as JsonFileEngine::save()
+bool ShardWriter::commit()
+{
+    if (!write("\n}\n"))
+    {
+        saveFile.cancelWriting();
+        return false;
+    }
+
+    saveFile.write("#SHA256:" + checksum.result().toHex() + "\n");
+
+    // commit() flushes and syncs the temporary file before the atomic rename
+    if (!saveFile.commit())
+    {
+        return false;
+    }
+
+    JsonFileEngine::markChecksummed(saveFile.fileName()); // Files of this directory must carry the trailer from now on
+    return true;
+}
+
+// Returns the error of the last failed write
+QString ShardWriter::errorString() const
+{
+    return saveFile.errorString();
+}
+
+// Returns the number of accounts written
+qint64 ShardWriter::count() const
+{
+    return entries;
+}
+
+// Writes bytes to the file and adds them to the checksum
+bool ShardWriter::write(const QByteArray &data)
+{
+    checksum.addData(data);
+    return saveFile.write(data) == data.size();
+}
@@ -0,0 +1,43 @@
+#ifndef SHARDWRITER_H
+#define SHARDWRITER_H
+
+#include <QString>            // Includes the QString class for the file name
+#include <QByteArray>         // Includes the QByteArray class for the serialized accounts
+#include <QSaveFile>          // Includes the QSaveFile class for atomic file writes
+#include <QCryptographicHash> // Includes the QCryptographicHash class for the checksum trailer
+
+// The ShardWriter class writes a shard file one account at a time,
+// without building the whole account table in memory.
+// The result has the same layout JsonFileEngine::readDataBase() expects:
+// a JSON object keyed by username followed by a "#SHA256:<hex>" trailer line.
+class ShardWriter
+{
+public:
+    // Constructor to set the shard file to write.
+    explicit ShardWriter(const QString &fileName);
+
+    // Method to open the temporary file and start the JSON object.
+    bool open();
+
+    // Method to add one serialized "<username>":{...} member to the JSON object.
+    bool append(const QByteArray &entry);
+
+    // Method to close the JSON object, add the checksum trailer and rename the file into place.
+    bool commit();
+
+    // Method to get the error of the last failed write.
+    QString errorString() const;
+
+    // Method to get the number of accounts written.
+    qint64 count() const;
+
+private:
+    // Method to write bytes to the file and add them to the checksum.
+    bool write(const QByteArray &data);
+
+    QSaveFile saveFile; // Temporary file renamed over the shard file on commit.
+    QCryptographicHash checksum; // SHA-256 of everything written before the trailer.
+    qint64 entries; // Number of accounts written.
+};
+
+#endif // SHARDWRITER_H
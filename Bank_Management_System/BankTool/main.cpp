@@ -0,0 +1,95 @@
+#include <QCoreApplication> // Includes core application functionalities for non-GUI applications
+#include <QCommandLineParser> // Includes the parser for the command-line options
+#include <QElapsedTimer> // Includes the QElapsedTimer class for reporting the run time
+#include <QFileInfo> // Includes the QFileInfo class for detecting the file format
+#include <QTextStream> // Includes the QTextStream class for the console output
+#include "AccountImporter.h"
+#include "AccountExporter.h"
+#include "DataBaseShard.h"
+#include "PasswordHasher.h"
+
+int main(int argc, char *argv[])
+{
+    // Create the QCoreApplication object, which manages application-wide resources
+    QCoreApplication a(argc, argv);
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    // Define the command and its options
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Bulk import and export of the bank server's accounts.\n"
+                                     "  import <accounts.csv|accounts.jsonl>  Replace the shard files with the accounts of the file.\n"
+                                     "  export <accounts.csv|accounts.jsonl>  Write the accounts of the shard files to the file.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("command", "import or export.");
+    parser.addPositionalArgument("file", "CSV or JSONL file to read or write.");
+    QCommandLineOption dirOption("dir", "Directory holding the server's shard files (default: current directory).", "dir", ".");
+    QCommandLineOption shardsOption("shards", "Number of shards of the server (default: 4).", "count", "4");
+    QCommandLineOption formatOption("format", "csv or jsonl (default: from the file extension).", "format");
+    QCommandLineOption historyOption("history", "CSV file with the transaction history (AccountNumber,Date,Time,Type,Amount).", "file");
+    QCommandLineOption iterationsOption("iterations", "PBKDF2 iterations of the imported passwords (default: 10000).", "count");
+    QCommandLineOption forceOption("force", "Replace existing shard files on import.");
+    parser.addOption(dirOption);
+    parser.addOption(shardsOption);
+    parser.addOption(formatOption);
+    parser.addOption(historyOption);
+    parser.addOption(iterationsOption);
+    parser.addOption(forceOption);
+    parser.process(a);
+
+    QStringList args = parser.positionalArguments();
+    if ((args.size() != 2) || ((args[0] != "import") && (args[0] != "export")))
+    {
+        parser.showHelp(1);
+    }
+
+    QString format = parser.isSet(formatOption) ? parser.value(formatOption) : QFileInfo(args[1]).suffix().toLower();
+    if ((format != "csv") && (format != "jsonl"))
+    {
+        err << "Unknown format " << format << "; use --format csv or --format jsonl" << Qt::endl;
+        return 1;
+    }
+    bool csv = (format == "csv");
+    QString dataDir = parser.value(dirOption);
+    qint32 shardCount = parser.value(shardsOption).toInt();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    if (args[0] == "import")
+    {
+        // Refuse to overwrite a database unless asked to
+        for (qint32 i = 0; (i < shardCount) && !parser.isSet(forceOption); i++)
+        {
+            if (QFileInfo::exists(QDir(dataDir).filePath(DataBaseShard::shardFileName(i))))
+            {
+                err << "The shard files already exist in " << dataDir << "; use --force to replace them" << Qt::endl;
+                return 1;
+            }
+        }
+
+        if (parser.isSet(iterationsOption))
+        {
+            PasswordHasher::setIterations(parser.value(iterationsOption).toInt());
+        }
+
+        AccountImporter importer(dataDir, shardCount);
+        if (!importer.import(args[1], csv, parser.value(historyOption)))
+        {
+            return 1;
+        }
+
+        out << "Imported " << importer.imported() << " accounts, skipped " << importer.skipped()
+            << " rows in " << timer.elapsed() << " ms" << Qt::endl;
+        return (importer.skipped() == 0) ? 0 : 2;
+    }
+
+    AccountExporter exporter(dataDir, shardCount);
+    if (!exporter.exportTo(args[1], csv, parser.value(historyOption)))
+    {
+        return 1;
+    }
+
+    out << "Exported " << exporter.exported() << " accounts in " << timer.elapsed() << " ms" << Qt::endl;
+    return 0;
+}
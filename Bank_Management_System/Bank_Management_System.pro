@@ -0,0 +1,10 @@
+# Builds every project of the system; the GUI client links the static ClientLib, so it waits for it.
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    ClientLib \
+    Client \
+    Server \
+    BankTool
+
+Client.depends = ClientLib
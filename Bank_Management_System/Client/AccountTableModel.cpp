@@ -0,0 +1,149 @@
+#include "AccountTableModel.h"
+#include <QBrush>    // Includes the QBrush class for the colors of the authority column
+#include <algorithm> // Includes std::lower_bound for finding the row of a username
+
+// Constructor for AccountTableModel; the table starts empty
+AccountTableModel::AccountTableModel(QObject *parent)
+    : QAbstractTableModel{parent}
+{
+}
+
+// Replaces all rows with the accounts of a database response
+void AccountTableModel::setDataBase(const QJsonObject &dataBase)
+{
+    // The keys of a JSON object are already sorted
+    beginResetModel();
+    userNames = dataBase.keys();
+    accounts.clear();
+    accounts.reserve(userNames.size());
+    for (auto it = dataBase.constBegin(); it != dataBase.constEnd(); ++it)
+    {
+        accounts.insert(it.key(), it.value().toObject());
+    }
+    endResetModel();
+}
+
+// Changes the row of an account, or inserts it at its sorted position
+void AccountTableModel::updateAccount(const QString &userName, const QJsonObject &account)
+{
+    qint32 row = static_cast<qint32>(std::lower_bound(userNames.begin(), userNames.end(), userName) - userNames.begin());
+
+    // A known account only repaints its row
+    if ((row < userNames.size()) && (userNames.at(row) == userName))
+    {
+        accounts[userName] = account;
+        emit dataChanged(index(row, 0), index(row, ColumnCount - 1));
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), row, row);
+    userNames.insert(row, userName);
+    accounts.insert(userName, account);
+    endInsertRows();
+}
+
+// Removes the row of an account
+void AccountTableModel::removeAccount(const QString &userName)
+{
+    qint32 row = static_cast<qint32>(std::lower_bound(userNames.begin(), userNames.end(), userName) - userNames.begin());
+    if ((row >= userNames.size()) || (userNames.at(row) != userName))
+    {
+        return;
+    }
+
+    beginRemoveRows(QModelIndex(), row, row);
+    userNames.removeAt(row);
+    accounts.remove(userName);
+    endRemoveRows();
+}
+
+// Removes all rows
+void AccountTableModel::clear()
+{
+    beginResetModel();
+    userNames.clear();
+    accounts.clear();
+    endResetModel();
+}
+
+// Returns one row per account; the table has no child rows
+int AccountTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(userNames.size());
+}
+
+// Returns the number of columns of the table
+int AccountTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+// Returns the text or the color of a cell
+QVariant AccountTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || (index.row() >= userNames.size()))
+    {
+        return QVariant();
+    }
+
+    // The cell is read from the account only when the view asks for it
+    const QString &userName = userNames.at(index.row());
+    const QJsonObject account = accounts.value(userName);
+    bool isAdmin = account["IsAdmin"].toBool();
+
+    if (role == Qt::DisplayRole)
+    {
+        switch (index.column())
+        {
+        case AccountNumberColumn:
+            return account["AccountNumber"].toString();
+        case AuthorityColumn:
+            return isAdmin ? "Admin" : "User";
+        case UserNameColumn:
+            return userName;
+        case FullNameColumn:
+            return account["FullName"].toString();
+        case AgeColumn:
+            return account["Age"].toString();
+        case BalanceColumn:
+            return account["AccountBalance"].toString();
+        default:
+            return QVariant();
+        }
+    }
+
+    // Admins are shown in red and users in blue
+    if ((role == Qt::ForegroundRole) && (index.column() == AuthorityColumn))
+    {
+        return QBrush(isAdmin ? Qt::red : Qt::blue);
+    }
+
+    return QVariant();
+}
+
+// Returns the titles of the columns
+QVariant AccountTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if ((role != Qt::DisplayRole) || (orientation != Qt::Horizontal))
+    {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+    switch (section)
+    {
+    case AccountNumberColumn:
+        return "Account Number";
+    case AuthorityColumn:
+        return "Authority";
+    case UserNameColumn:
+        return "User Name";
+    case FullNameColumn:
+        return "Full Name";
+    case AgeColumn:
+        return "Age";
+    case BalanceColumn:
+        return "Balance";
+    default:
+        return QVariant();
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef ACCOUNTTABLEMODEL_H
+#define ACCOUNTTABLEMODEL_H
+
+#include <QAbstractTableModel> // Includes the base class of table models
+#include <QJsonObject>         // Includes the QJsonObject class for the accounts
+#include <QStringList>         // Includes the QStringList class for the sorted usernames
+#include <QHash>               // Includes the QHash class for the accounts by username
+
+// AccountTableModel shows the bank database in a table view.
+// It keeps the decoded accounts and only reads a cell when the view paints it, so a table of
+// hundreds of thousands of accounts costs one row entry each instead of one item per cell.
+// Rows are sorted by username; delta updates insert, change or remove single rows.
+class AccountTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    // Columns of the table
+    enum Column
+    {
+        AccountNumberColumn,
+        AuthorityColumn,
+        UserNameColumn,
+        FullNameColumn,
+        AgeColumn,
+        BalanceColumn,
+        ColumnCount
+    };
+
+    explicit AccountTableModel(QObject *parent = nullptr);
+
+    // Replaces all accounts with the database of a response, keyed by username
+    void setDataBase(const QJsonObject &dataBase);
+
+    // Adds an account or replaces the one with the same username
+    void updateAccount(const QString &userName, const QJsonObject &account);
+
+    // Removes the account of a username, if it is shown
+    void removeAccount(const QString &userName);
+
+    // Removes all accounts
+    void clear();
+
+    // QAbstractTableModel interface
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    QStringList userNames;                // Usernames in row order
+    QHash<QString, QJsonObject> accounts; // Accounts by username
+};
+
+#endif // ACCOUNTTABLEMODEL_H
@@ -10,14 +10,32 @@ CONFIG += c++17
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
-    MyClient.cpp \
+    AccountTableModel.cpp \
+    TransactionTableModel.cpp \
     main.cpp \
     mainwindow.cpp
 
 HEADERS += \
-    MyClient.h \
+    AccountTableModel.h \
+    TransactionTableModel.h \
     mainwindow.h
 
+# The connections and the request API come from the headless client library,
+# built next to this project (see Bank_Management_System.pro) and linked statically
+INCLUDEPATH += $$PWD/../ClientLib
+DEPENDPATH += $$PWD/../ClientLib
+
+win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../ClientLib/release/ -lClientLib
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../ClientLib/debug/ -lClientLib
+else:unix: LIBS += -L$$OUT_PWD/../ClientLib/ -lClientLib
+
+# Relink the client whenever the library changes
+win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../ClientLib/release/libClientLib.a
+else:win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../ClientLib/debug/libClientLib.a
+else:win32:!win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../ClientLib/release/ClientLib.lib
+else:win32:!win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../ClientLib/debug/ClientLib.lib
+else:unix: PRE_TARGETDEPS += $$OUT_PWD/../ClientLib/libClientLib.a
+
 FORMS += \
     mainwindow.ui
 
@@ -0,0 +1,110 @@
+#include "TransactionTableModel.h"
+#include <QJsonObject> // Includes the QJsonObject class for reading a transaction
+
+// Constructor for TransactionTableModel; the table starts empty
+TransactionTableModel::TransactionTableModel(QObject *parent)
+    : QAbstractTableModel{parent}
+{
+}
+
+// Adds a page of older transactions below the rows already shown
+void TransactionTableModel::appendTransactions(const QJsonArray &page)
+{
+    if (page.isEmpty())
+    {
+        return;
+    }
+
+    qint32 first = static_cast<qint32>(transactions.size());
+    beginInsertRows(QModelIndex(), first, first + static_cast<qint32>(page.size()) - 1);
+    for (const auto &transaction : page)
+    {
+        transactions.append(transaction);
+    }
+    endInsertRows();
+}
+
+// Adds a page of new transactions above the rows already shown
+void TransactionTableModel::prependTransactions(const QJsonArray &page)
+{
+    if (page.isEmpty())
+    {
+        return;
+    }
+
+    // The last transaction of the page is the newest one and goes on top
+    beginInsertRows(QModelIndex(), 0, static_cast<qint32>(page.size()) - 1);
+    for (const auto &transaction : page)
+    {
+        transactions.prepend(transaction);
+    }
+    endInsertRows();
+}
+
+// Removes all rows
+void TransactionTableModel::clear()
+{
+    beginResetModel();
+    transactions = QJsonArray();
+    endResetModel();
+}
+
+// Returns one row per transaction; the table has no child rows
+int TransactionTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(transactions.size());
+}
+
+// Returns the number of columns of the table
+int TransactionTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+// Returns the text of a cell
+QVariant TransactionTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || (role != Qt::DisplayRole) || (index.row() >= transactions.size()))
+    {
+        return QVariant();
+    }
+
+    // The cell is read from the transaction only when the view asks for it
+    QJsonObject transaction = transactions.at(index.row()).toObject();
+    switch (index.column())
+    {
+    case TypeColumn:
+        return transaction["Type"].toString();
+    case AmountColumn:
+        return transaction["Amount"].toString();
+    case DateColumn:
+        return transaction["Date"].toString();
+    case TimeColumn:
+        return transaction["Time"].toString();
+    default:
+        return QVariant();
+    }
+}
+
+// Returns the titles of the columns
+QVariant TransactionTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if ((role != Qt::DisplayRole) || (orientation != Qt::Horizontal))
+    {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+    switch (section)
+    {
+    case TypeColumn:
+        return "Type";
+    case AmountColumn:
+        return "Amount";
+    case DateColumn:
+        return "Date";
+    case TimeColumn:
+        return "Time";
+    default:
+        return QVariant();
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef TRANSACTIONTABLEMODEL_H
+#define TRANSACTIONTABLEMODEL_H
+
+#include <QAbstractTableModel> // Includes the base class of table models
+#include <QJsonArray>          // Includes the QJsonArray class for the transactions
+
+// TransactionTableModel shows a transaction history in a table view.
+// The transactions stay in the decoded response arrays and a cell is only read when the view
+// paints it; the pages of a long history are appended as they arrive.
+class TransactionTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    // Columns of the table
+    enum Column
+    {
+        TypeColumn,
+        AmountColumn,
+        DateColumn,
+        TimeColumn,
+        ColumnCount
+    };
+
+    explicit TransactionTableModel(QObject *parent = nullptr);
+
+    // Adds the transactions of a page below the rows already shown
+    void appendTransactions(const QJsonArray &page);
+
+    // Adds new transactions, oldest first, on top of the rows already shown, so the newest is the first row
+    void prependTransactions(const QJsonArray &page);
+
+    // Removes all transactions
+    void clear();
+
+    // QAbstractTableModel interface
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    QJsonArray transactions; // Transactions in row order
+};
+
+#endif // TRANSACTIONTABLEMODEL_H
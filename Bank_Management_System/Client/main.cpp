@@ -1,10 +1,31 @@
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QMessageBox>
 #include "mainwindow.h"
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
+
+    // TLS is optional; a self-signed server certificate is trusted with --ca-cert
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Bank management client");
+    parser.addHelpOption();
+    QCommandLineOption tlsOption("tls", "Connect to the servers over TLS.");
+    QCommandLineOption caCertOption("ca-cert", "Trust the PEM certificate(s) in <file>, e.g. a self-signed server certificate. Implies --tls.", "file");
+    parser.addOption(tlsOption);
+    parser.addOption(caCertOption);
+    parser.process(a);
+
     MainWindow BankApp;
+    if (parser.isSet(tlsOption) || parser.isSet(caCertOption))
+    {
+        if (!BankApp.EnableTls(parser.value(caCertOption)))
+        {
+            QMessageBox::critical(nullptr, "Bank Client", "TLS is not available or the certificate cannot be read.");
+            return 1;
+        }
+    }
     BankApp.show();
     return a.exec();
 }
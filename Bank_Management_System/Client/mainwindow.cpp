@@ -8,18 +8,31 @@ MainWindow::MainWindow(QWidget *parent)
 {
     ui->setupUi(this); // Setup the user interface
 
+    // The tables read their cells from the models only for the rows in view
+    ui->Admin_tbView_DB->setModel(&accountModel);
+    ui->Admin_tbView_histroy->setModel(&adminHistoryModel);
+    ui->User_tbView_histroy->setModel(&userHistoryModel);
+    for (QTableView *view : {ui->Admin_tbView_DB, ui->Admin_tbView_histroy, ui->User_tbView_histroy})
+    {
+        view->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed); // Rows are not measured one by one
+    }
+
     // Initialize tab states
     ui->Tab->setTabEnabled(0, true);  // Enable the first tab (e.g., Login tab)
     ui->Tab->setTabEnabled(1, false); // Disable the second tab (e.g., Admin tab)
     ui->Tab->setTabEnabled(2, false); // Disable the third tab (e.g., User tab)
     ui->Tab->setTabEnabled(3, false); // Disable the fourth tab (e.g., Additional tab)
 
-    // Connect MyClient signals to MainWindow slots
-    connect(&client, &MyClient::Connection, this, &MainWindow::onConnectionDevice);
-    connect(&client, &MyClient::Disconnected, this, &MainWindow::onDisconnectedDevice);
-    connect(&client, &MyClient::ErrorOccurred, this, &MainWindow::onErrorOccurredDevice);
-    connect(&client, &MyClient::StateChanged, this, &MainWindow::onStateChangedDevice);
-    connect(&client, &MyClient::ReadyRead, this, &MainWindow::onReadyReadDevice);
+    // Connect BankClient signals to MainWindow slots; the client reads and decodes on its own thread
+    connect(&bank, &BankClient::connected, this, &MainWindow::onConnectionDevice);
+    connect(&bank, &BankClient::disconnected, this, &MainWindow::onDisconnectedDevice);
+    connect(&bank, &BankClient::errorOccurred, this, &MainWindow::onErrorOccurredDevice);
+    connect(&bank, &BankClient::stateChanged, this, &MainWindow::onStateChangedDevice);
+    connect(&bank, &BankClient::accountEvent, this, &MainWindow::handleAccountEvent);
+
+    // Ping the server every minute, well within its idle timeout
+    heartbeat.setInterval(60000);
+    connect(&heartbeat, &QTimer::timeout, this, &MainWindow::onHeartbeat);
 }
 
 // Destructor for MainWindow
@@ -39,6 +52,8 @@ void MainWindow::onConnectionDevice()
     ui->Tab->setTabEnabled(1, true); // Enable Login tab
     ui->Tab->setCurrentIndex(1);     // Switch to Login tab
     ui->lw_Login->clear();           // Clear the login log list widget
+
+    heartbeat.start(); // Keep the connection alive while the user is idle
 }
 
 // Slot called when the connection is lost
@@ -52,6 +67,20 @@ void MainWindow::onDisconnectedDevice()
     ui->Tab->setTabEnabled(1, false); // Disable Login tab
     ui->Tab->setTabEnabled(2, false); // Disable Admin tab
     ui->Tab->setTabEnabled(3, false); // Disable User tab
+
+    heartbeat.stop();
+}
+
+// Function to use TLS for the next connections
+bool MainWindow::EnableTls(const QString &caCertificateFile)
+{
+    return bank.enableTls(caCertificateFile);
+}
+
+// Slot called to send a heartbeat request
+void MainWindow::onHeartbeat()
+{
+    bank.ping(); // The response only keeps the connection alive; nothing to show
 }
 
 // Slot called when an error occurs
@@ -68,28 +97,9 @@ void MainWindow::onStateChangedDevice(QAbstractSocket::SocketState socketState)
     ui->lw_Connect->addItem(meta.valueToKey(socketState)); // Add the state description to the connection log list widget
 }
 
-// Slot called when data is ready to be read
-void MainWindow::onReadyReadDevice(QByteArray responseData)
+// Slot called with the response of a request, decoded and verified by the network thread
+void MainWindow::onResponseDevice(qint32 responseId, const QJsonObject &responseObject)
 {
-    QJsonDocument jsonResponse = QJsonDocument::fromJson(responseData); // Parse the JSON response
-
-    // Check if the response is a valid JSON object
-    if (!jsonResponse.isObject())
-    {
-        // Invalid JSON response; no further processing
-        return;
-    }
-
-    QJsonObject responseObject = jsonResponse.object(); // Extract JSON object from the response
-
-    // Validate the response hash
-    if (!(validateHashResponse(responseObject)))
-    {
-        return; // If hash validation fails, exit the function
-    }
-
-    qint32 responseId = responseObject["ResponseID"].toInt(); // Extract the response ID from the JSON object
-
     // Handle the response based on the response ID
     switch (responseId)
     {
@@ -123,6 +133,9 @@ void MainWindow::onReadyReadDevice(QByteArray responseData)
     case TransferAmount_ID:
         handleTransferAmountResponse(responseObject); // Handle transfer amount response
         break;
+    case Subscribe_ID:
+        handleSubscribeResponse(responseObject); // Handle subscribe response
+        break;
     default:
         // Handle unknown response IDs if necessary
         break;
@@ -165,6 +178,9 @@ void MainWindow::handleLoginResponse(const QJsonObject &responseObject)
             ui->Tab->setTabEnabled(1, false); // Disable Login tab
             ui->Tab->setTabEnabled(3, true); // Enable User tab
             ui->Tab->setCurrentIndex(3); // Switch to User tab
+
+            // Let the server push balance and history changes instead of polling for them
+            handleResponse(bank.subscribe({accountNumber}));
         }
     }
     else
@@ -215,6 +231,10 @@ void MainWindow::handleCreateUserResponse(const QJsonObject &responseObject)
             ui->Admin_leCreate_user_name->clear(); // Clear the username input field
             ui->Admin_lbCreate_user_error->setText("Username reserved"); // Show error message
         }
+        else if (reason == -2)
+        {
+            ui->Admin_lbCreate_user_error->setText("No free account number"); // Show error message
+        }
         else // Reason -6 (or other unspecified reasons)
         {
             ui->Admin_lbCreate_user_error->setText("Server failed to handle this request"); // Show generic error message
@@ -304,46 +324,32 @@ void MainWindow::handleViewDataBaseResponse(const QJsonObject &responseObject)
         ui->Admin_lbView_DB_error->setText("Database fetched successfully"); // Show success message
         ui->Admin_lbView_DB_error->setStyleSheet("QLabel { color : green; }"); // Set text color to green
 
-        QJsonObject DataBaseObj = responseObject.value("DataBase").toObject(); // Extract database object from response
-        QStringList usersList = DataBaseObj.keys(); // Get list of usernames
-
-        // Populate Admin_tbView_DB with user data
-        int row = 0;
-        for (const auto &user : usersList)
+        if (responseObject["Delta"].toBool())
         {
-            QJsonObject userObj = DataBaseObj.value(user).toObject(); // Get user object for each username
-            ui->Admin_tbView_DB->insertRow(row); // Insert a new row in the table
-
-            // Set account number
-            ui->Admin_tbView_DB->setItem(row, 0, new QTableWidgetItem(userObj["AccountNumber"].toString()));
-
-            QTableWidgetItem *item;
-            if (userObj["IsAdmin"].toBool())
+            // Only the accounts changed since the version of the local copy were sent, so only their rows change
+            QJsonObject updated = responseObject.value("Updated").toObject();
+            for (auto it = updated.constBegin(); it != updated.constEnd(); ++it)
             {
-                // If user is an admin
-                item = new QTableWidgetItem("Admin");
-                item->setForeground(QBrush(QColor(Qt::red)));   // Set text color to green for Admin
+                accountModel.updateAccount(it.key(), it.value().toObject());
             }
-            else
+            for (const auto &user : responseObject.value("Deleted").toArray())
             {
-                // If user is not an admin
-                item = new QTableWidgetItem("User");
-                item->setForeground(QBrush(QColor(Qt::blue)));    // Set text color to blue for User
+                accountModel.removeAccount(user.toString());
             }
-            // Set the item in the QTableWidget
-            ui->Admin_tbView_DB->setItem(row, 1, item);
-
-            // Set other user details
-            ui->Admin_tbView_DB->setItem(row, 2, new QTableWidgetItem(user)); // Username
-            ui->Admin_tbView_DB->setItem(row, 3, new QTableWidgetItem(userObj["FullName"].toString())); // Full Name
-            ui->Admin_tbView_DB->setItem(row, 4, new QTableWidgetItem(userObj["Age"].toString())); // Age
-            ui->Admin_tbView_DB->setItem(row, 5, new QTableWidgetItem(userObj["AccountBalance"].toString())); // Account Balance
-            row++;
         }
+        else
+        {
+            accountModel.setDataBase(responseObject.value("DataBase").toObject()); // Extract database object from response
+        }
+        dataBaseVersion = responseObject["Version"].toString(); // Version the local copy is at now
+        dataBaseEpoch = responseObject["Epoch"].toString();
     }
     else
     {
         // If database fetch failed
+        accountModel.clear(); // The next refresh fetches the whole database
+        dataBaseVersion.clear();
+
         qint8 reason = responseObject["Reason"].toInt(); // Extract the reason for failure
         if (reason == -1)
         {
@@ -478,41 +484,31 @@ void MainWindow::handleViewTransactionHistoryResponse(const QJsonObject &respons
         {
             ui->Admin_lbView_history_error->setText("History fetched successfully"); // Success message for Admin
             ui->Admin_lbView_history_error->setStyleSheet("QLabel { color : green; }");
-
-            // Populate Admin_tbView_histroy with transaction history data
-            int row = 0;
-            for (const auto &transactionDataValue : transactionHistoryArray)
-            {
-                QJsonObject transactionData = transactionDataValue.toObject();
-                ui->Admin_tbView_histroy->insertRow(row); // Insert a new row
-                ui->Admin_tbView_histroy->setItem(row, 0, new QTableWidgetItem(transactionData["Type"].toString())); // Transaction Type
-                ui->Admin_tbView_histroy->setItem(row, 1, new QTableWidgetItem(transactionData["Amount"].toString())); // Transaction Amount
-                ui->Admin_tbView_histroy->setItem(row, 2, new QTableWidgetItem(transactionData["Date"].toString())); // Transaction Date
-                ui->Admin_tbView_histroy->setItem(row, 3, new QTableWidgetItem(transactionData["Time"].toString())); // Transaction Time
-                row++;
-            }
+            adminHistoryModel.appendTransactions(transactionHistoryArray); // Add the page below the rows already shown
         }
         else if (ui->User->isEnabled())
         {
             ui->User_lbView_history_error->setText("History fetched successfully"); // Success message for User
             ui->User_lbView_history_error->setStyleSheet("QLabel { color : green; }");
+            userHistoryModel.appendTransactions(transactionHistoryArray); // Add the page below the rows already shown
+        }
 
-            // Populate User_tbView_histroy with transaction history data
-            int row = 0;
-            for (const auto &transactionDataValue : transactionHistoryArray)
-            {
-                QJsonObject transactionData = transactionDataValue.toObject();
-                ui->User_tbView_histroy->insertRow(row); // Insert a new row
-                ui->User_tbView_histroy->setItem(row, 0, new QTableWidgetItem(transactionData["Type"].toString())); // Transaction Type
-                ui->User_tbView_histroy->setItem(row, 1, new QTableWidgetItem(transactionData["Amount"].toString())); // Transaction Amount
-                ui->User_tbView_histroy->setItem(row, 2, new QTableWidgetItem(transactionData["Date"].toString())); // Transaction Date
-                ui->User_tbView_histroy->setItem(row, 3, new QTableWidgetItem(transactionData["Time"].toString())); // Transaction Time
-                row++;
-            }
+        // Fetch the next page while the requested count is not reached
+        historyRemaining -= static_cast<qint32>(transactionHistoryArray.size());
+        if ((historyRemaining > 0) && responseObject.contains("NextCursor"))
+        {
+            historyRequest["Cursor"] = responseObject["NextCursor"];
+            requestHistoryPage();
+        }
+        else
+        {
+            historyRemaining = 0;
         }
     }
     else
     {
+        historyRemaining = 0; // No more pages of this history
+
         // If the request failed, handle errors based on the reason
         qint8 reason = responseObject["Reason"].toInt();
 
@@ -618,56 +614,73 @@ void MainWindow::handleTransferAmountResponse(const QJsonObject &responseObject)
     }
 }
 
-/************** Hashing APIs Interfaces ***************/
-// Function to send a JSON request to the server with an appended SHA-256 hash for data integrity
-void MainWindow::sendHashRequest(QJsonObject &requestObject)
+void MainWindow::handleSubscribeResponse(const QJsonObject &responseObject)
 {
-    // Convert the JSON object to a JSON document
-    QJsonDocument requestDoc(requestObject);
+    // The subscription starts with the current balance; later changes arrive as events
+    QJsonObject balances = responseObject["Balances"].toObject();
+    if (responseObject["State"].toBool() && balances.contains(accountNumber))
+    {
+        showUserBalance(balances[accountNumber].toString());
+    }
+}
 
-    // Create a cryptographic hash object with SHA-256 algorithm
-    QCryptographicHash hashedRequest(QCryptographicHash::Sha256);
+void MainWindow::handleAccountEvent(const QJsonObject &eventObject)
+{
+    // Only the account of the logged in user is subscribed to
+    if (!ui->User->isEnabled() || (eventObject["AccountNumber"].toString() != accountNumber))
+    {
+        return;
+    }
 
-    // Hash the JSON request
-    hashedRequest.addData(requestDoc.toJson());
+    showUserBalance(eventObject["AccountBalance"].toString());
 
-    // Include the hash in the JSON request before sending
-    requestObject["Hash"] = QString((hashedRequest.result()).toHex());
+    // Add the new transactions on top of a history that is already shown, newest first
+    if (userHistoryModel.rowCount() > 0)
+    {
+        userHistoryModel.prependTransactions(eventObject["Transactions"].toArray());
+    }
+}
 
-    // Update the JSON document with the hash
-    QJsonDocument updatedRequestDoc(requestObject);
+void MainWindow::showUserBalance(const QString &balance)
+{
+    ui->User_lbView_balance->setText("Balance: " + balance);
+    ui->User_lbView_balance->setStyleSheet("QLabel { color : green; }");
+}
 
-    // Send the request to the server
-    client.WriteData(updatedRequestDoc.toJson());
+void MainWindow::requestHistory(const QString &account, qint32 count)
+{
+    // Construct the request JSON object for viewing transaction history
+    historyRequest = QJsonObject();
+    historyRequest["RequestID"] = ViewTransactionHistory_ID;
+    historyRequest["AccountNumber"] = account;
+    historyRemaining = count;
+    requestHistoryPage();
 }
 
-// Function to validate the hash in the response to ensure data integrity
-bool MainWindow::validateHashResponse(QJsonObject &responseObject)
+void MainWindow::requestHistoryPage()
 {
-    // Extract the hash from the JSON response
-    QString receivedHashHex = responseObject.value("Hash").toString();
-    QByteArray receivedHash = QByteArray::fromHex(receivedHashHex.toUtf8());
+    // A page holds at most historyPageSize transactions, so each response is decoded and shown quickly
+    QJsonObject requestObject = historyRequest;
+    requestObject["Count"] = QString::number(qMin(historyRemaining, historyPageSize));
 
-    // Remove the hash field from the response for hashing the rest of the data
-    responseObject.remove("Hash");
-    QJsonDocument responseWithoutHash(responseObject);
+    // Send the request with hashed data
+    sendRequest(requestObject);
+}
 
-    // Compute the hash of the response without the hash field
-    QCryptographicHash hash(QCryptographicHash::Sha256);
-    hash.addData(responseWithoutHash.toJson());
-    QByteArray computedHash = hash.result();
+/************** Request APIs Interfaces ***************/
+// Function to send a request to the server; the client adds the session token and the hash
+void MainWindow::sendRequest(const QJsonObject &requestObject)
+{
+    handleResponse(bank.request(requestObject));
+}
 
-    // Compare the computed hash with the received hash to verify integrity
-    if (computedHash == receivedHash)
-    {
-        // The response is verified and integrity is intact
-        return true;
-    }
-    else
-    {
-        // The response verification failed; integrity is compromised
-        return false;
-    }
+// Function to dispatch the response of a request once the client completes it
+void MainWindow::handleResponse(QFuture<QJsonObject> response)
+{
+    // The continuation runs on the GUI thread; requests the client could not deliver complete with Reason -17
+    response.then(this, [this](const QJsonObject &responseObject) {
+        onResponseDevice(responseObject["ResponseID"].toInt(), responseObject);
+    });
 }
 
 /************** Connect APIs Interfaces ***************/
@@ -678,15 +691,24 @@ void MainWindow::on_pbConnect_clicked()
     QString ip = ui->Connect_IP->text();
     qint32 port = ui->Connect_Port->text().toInt();
 
-    // Connect to the device using the provided IP address and port
-    client.ConnectToDevice(ip, port);
+    // The IP field may list the primary followed by replicas as "ip[:port], ip[:port], ..."
+    // where a missing port defaults to the port field
+    QList<QPair<QString, qint32>> endpoints;
+    for (const QString &entry : ip.split(',', Qt::SkipEmptyParts))
+    {
+        QStringList parts = entry.trimmed().split(':');
+        endpoints.append(qMakePair(parts.value(0), (parts.size() > 1) ? parts.value(1).toInt() : port));
+    }
+
+    // Connect to the devices using the provided IP addresses and ports
+    bank.connectToServers(endpoints);
 }
 
 // Slot for handling the "Disconnect" button click
 void MainWindow::on_pbDisconnect_clicked()
 {
     // Disconnect from the device
-    client.Disconnect();
+    bank.disconnectFromServers();
 }
 
 /************** Login APIs Interfaces ***************/
@@ -713,14 +735,8 @@ void MainWindow::on_pb_login_clicked()
     item->setForeground(QBrush(QColor(Qt::blue)));
     ui->lw_Login->addItem(item); // Add status message to the list widget
 
-    // Construct the request JSON object for login
-    QJsonObject requestObject;
-    requestObject["RequestID"] = LogIn_ID;
-    requestObject["UserName"] = username;
-    requestObject["Password"] = password;
-
-    // Send the request with hashed data
-    sendHashRequest(requestObject);
+    // Send the login request
+    handleResponse(bank.logIn(username, password));
 }
 
 /************** Admin APIs Interfaces ***************/
@@ -765,7 +781,7 @@ void MainWindow::on_Admin_pbCreate_new_user_clicked()
     requestObject["AccountBalance"] = "0"; // Default balance
 
     // Send the request with hashed data
-    sendHashRequest(requestObject);
+    sendRequest(requestObject);
 }
 
 // Slot for handling the "Update User" button click
@@ -806,7 +822,7 @@ void MainWindow::on_Admin_pbUpdate_user_clicked()
     requestObject["IsAdmin"] = ui->Admin_chkbox_UpdateUser->isChecked();
 
     // Send the request with hashed data
-    sendHashRequest(requestObject);
+    sendRequest(requestObject);
 }
 
 // Slot for handling the "Delete User" button click
@@ -832,7 +848,7 @@ void MainWindow::on_Admin_pbDelete_user_clicked()
     requestObject["AccountNumber"] = AccountNumber;
 
     // Send the request with hashed data
-    sendHashRequest(requestObject);
+    sendRequest(requestObject);
 }
 
 // Slot for handling the "Get Account Number" button click
@@ -858,7 +874,7 @@ void MainWindow::on_Admin_pbGet_acc_number_clicked()
     requestObject["UserName"] = UserName;
 
     // Send the request with hashed data
-    sendHashRequest(requestObject);
+    sendRequest(requestObject);
 }
 
 /************** Admin APIs Interfaces ***************/
@@ -885,7 +901,7 @@ void MainWindow::on_Admin_pbView_balance_clicked()
     requestObject["AccountNumber"] = AccountNumber;
 
     // Send the request with hashed data
-    sendHashRequest(requestObject);
+    sendRequest(requestObject);
 }
 
 // Slot for handling the "View Transaction History" button click
@@ -893,8 +909,7 @@ void MainWindow::on_Admin_pbView_trans_hist_clicked()
 {
     // Clear any previous error messages and table contents
     ui->Admin_lbView_history_error->clear();
-    ui->Admin_tbView_histroy->clearContents();
-    ui->Admin_tbView_histroy->setRowCount(0);
+    adminHistoryModel.clear();
 
     // Retrieve account number and count from the UI
     QString AccountNumber = ui->Admin_leHistory_acc->text();
@@ -915,30 +930,29 @@ void MainWindow::on_Admin_pbView_trans_hist_clicked()
         return;
     }
 
-    // Construct the request JSON object for viewing transaction history
-    QJsonObject requestObject;
-    requestObject["RequestID"] = ViewTransactionHistory_ID;
-    requestObject["AccountNumber"] = AccountNumber;
-    requestObject["Count"] = Count;
-
-    // Send the request with hashed data
-    sendHashRequest(requestObject);
+    // Fetch the transaction history page by page
+    requestHistory(AccountNumber, Count.toInt());
 }
 
 // Slot for handling the "View Database" button click
 void MainWindow::on_Admin_pbView_DB_clicked()
 {
-    // Clear any previous error messages and table contents
+    // Clear any previous error messages; the table keeps the local copy until the response arrives
     ui->Admin_lbView_DB_error->clear();
-    ui->Admin_tbView_DB->clearContents();
-    ui->Admin_tbView_DB->setRowCount(0);
 
     // Construct the request JSON object for viewing the database
     QJsonObject requestObject;
     requestObject["RequestID"] = ViewBankDB_ID;
 
+    // With a local copy, only the changes since its version are needed
+    if (!dataBaseVersion.isEmpty())
+    {
+        requestObject["SinceVersion"] = dataBaseVersion;
+        requestObject["Epoch"] = dataBaseEpoch;
+    }
+
     // Send the request with hashed data
-    sendHashRequest(requestObject);
+    sendRequest(requestObject);
 }
 
 // Slot for handling the "Logout" button click
@@ -948,6 +962,11 @@ void MainWindow::on_Admin_pbLogout_clicked()
     ui->Tab->setTabEnabled(1, true);
     ui->Tab->setTabEnabled(2, false);
     ui->Tab->setCurrentIndex(1);
+    bank.setSessionToken(QString()); // Forget the session of the logged out user
+
+    // Forget the copy of the database shown to the admin
+    accountModel.clear();
+    dataBaseVersion.clear();
 
     // Display a logout message
     QListWidgetItem *item = new QListWidgetItem("You have logged out");
@@ -959,7 +978,7 @@ void MainWindow::on_Admin_pbLogout_clicked()
 void MainWindow::on_Admin_pbExit_clicked()
 {
     // Disconnect from the device and quit the application
-    client.Disconnect();
+    bank.disconnectFromServers();
     QApplication::quit();
 }
 
@@ -976,7 +995,7 @@ void MainWindow::on_User_pbGet_acc_number_clicked()
     requestObject["UserName"] = userName; // Assuming `userName` is a member variable
 
     // Send the request with hashed data
-    sendHashRequest(requestObject);
+    sendRequest(requestObject);
 }
 
 // Slot for handling the "View Balance" button click
@@ -991,7 +1010,7 @@ void MainWindow::on_User_pbView_balance_clicked()
     requestObject["AccountNumber"] = accountNumber; // Assuming `accountNumber` is a member variable
 
     // Send the request with hashed data
-    sendHashRequest(requestObject);
+    sendRequest(requestObject);
 }
 
 // Slot for handling the "Make Transfer" button click
@@ -1019,15 +1038,8 @@ void MainWindow::on_User_pbMake_transfer_clicked()
         return;
     }
 
-    // Construct the request JSON object for making a transfer
-    QJsonObject requestObject;
-    requestObject["RequestID"] = TransferAmount_ID;
-    requestObject["SenderAccountNumber"] = accountNumber;
-    requestObject["ReceiverAccountNumber"] = ReceiverAccountNumber;
-    requestObject["Amount"] = Amount;
-
-    // Send the request with hashed data
-    sendHashRequest(requestObject);
+    // Send the transfer; the client adds an idempotency key so a resent request is applied only once
+    handleResponse(bank.transferAmount(accountNumber, ReceiverAccountNumber, Amount));
 }
 
 // Slot for handling the "Make Transaction" button click
@@ -1048,14 +1060,8 @@ void MainWindow::on_User_pbMake_transaction_clicked()
         return;
     }
 
-    // Construct the request JSON object for making a transaction
-    QJsonObject requestObject;
-    requestObject["RequestID"] = MakeTransaction_ID;
-    requestObject["AccountNumber"] = accountNumber;
-    requestObject["Amount"] = Amount;
-
-    // Send the request with hashed data
-    sendHashRequest(requestObject);
+    // Send the transaction; the client adds an idempotency key so a resent request is applied only once
+    handleResponse(bank.makeTransaction(accountNumber, Amount));
 }
 
 // Slot for handling the "View Transaction History" button click
@@ -1063,8 +1069,7 @@ void MainWindow::on_User_pbView_trans_histroy_clicked()
 {
     // Clear any previous error messages and table contents
     ui->User_lbView_history_error->clear();
-    ui->User_tbView_histroy->clearContents();
-    ui->User_tbView_histroy->setRowCount(0);
+    userHistoryModel.clear();
 
     // Retrieve count from the UI
     QString Count = ui->User_leHistory_count->text();
@@ -1078,23 +1083,21 @@ void MainWindow::on_User_pbView_trans_histroy_clicked()
         return;
     }
 
-    // Construct the request JSON object for viewing transaction history
-    QJsonObject requestObject;
-    requestObject["RequestID"] = ViewTransactionHistory_ID;
-    requestObject["AccountNumber"] = accountNumber;
-    requestObject["Count"] = Count;
-
-    // Send the request with hashed data
-    sendHashRequest(requestObject);
+    // Fetch the transaction history page by page
+    requestHistory(accountNumber, Count.toInt());
 }
 
 // Slot for handling the "Logout" button click
 void MainWindow::on_User_pbLogout_clicked()
 {
+    // Stop the pushed changes of the logged out user
+    bank.unsubscribe();
+
     // Switch back to the login tab and disable other tabs
     ui->Tab->setTabEnabled(1, true);
     ui->Tab->setTabEnabled(3, false);
     ui->Tab->setCurrentIndex(1);
+    bank.setSessionToken(QString()); // Forget the session of the logged out user
 
     // Display a logout message
     QListWidgetItem *item = new QListWidgetItem("You have logged out");
@@ -1106,6 +1109,6 @@ void MainWindow::on_User_pbLogout_clicked()
 void MainWindow::on_User_pbExit_clicked()
 {
     // Disconnect from the device and quit the application
-    client.Disconnect();
+    bank.disconnectFromServers();
     QApplication::quit();
 }
@@ -7,9 +7,11 @@
 #include <QJsonArray>
 #include <QJsonParseError>
 #include <QMetaEnum>
-#include <QCryptographicHash>
+#include <QTimer>
 #include <QDebug>
-#include "MyClient.h"
+#include "BankClient.h"
+#include "AccountTableModel.h"
+#include "TransactionTableModel.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -25,6 +27,9 @@ public:
     explicit MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+    // Connects to the servers over TLS, trusting the certificate in caCertificateFile in addition to the system ones
+    bool EnableTls(const QString &caCertificateFile);
+
 public slots:
     // Slot for handling successful connection to the device
     void onConnectionDevice();
@@ -34,8 +39,10 @@ public slots:
     void onErrorOccurredDevice(QAbstractSocket::SocketError socketError);
     // Slot for handling changes in the socket state
     void onStateChangedDevice(QAbstractSocket::SocketState socketState);
-    // Slot for handling data received from the device
-    void onReadyReadDevice(QByteArray responseData);
+    // Slot for handling a response decoded and verified by the network thread
+    void onResponseDevice(qint32 responseId, const QJsonObject &responseObject);
+    // Slot for sending a heartbeat to the server
+    void onHeartbeat();
 
 private slots:
     // Slot for handling the connect button click
@@ -68,9 +75,18 @@ private slots:
 
 private:
     Ui::MainWindow *ui;
-    MyClient client; // Client object for handling communication
+    BankClient bank; // Client sending the requests and decoding the responses on its network thread
     QString userName; // Store the username
     QString accountNumber; // Store the account number
+    QTimer heartbeat; // Timer sending a ping so the server does not close an idle connection
+    AccountTableModel accountModel; // Local copy of the database shown to the admin, keyed by username
+    QString dataBaseVersion; // Version of the local copy; empty when there is none
+    QString dataBaseEpoch; // Run of the server the version belongs to
+    TransactionTableModel adminHistoryModel; // Transaction history shown to the admin
+    TransactionTableModel userHistoryModel; // Transaction history shown to the user
+    QJsonObject historyRequest; // History request of the pages still to come, with the cursor of the next page
+    qint32 historyRemaining = 0; // Number of transactions still to fetch for the shown history
+    static constexpr qint32 historyPageSize = 500; // Number of transactions fetched per page
 
     // Enumeration of request IDs for identifying different types of requests.
     enum requestIDs {
@@ -83,13 +99,17 @@ private:
         GetBalance_ID = 6,
         ViewTransactionHistory_ID = 7,
         MakeTransaction_ID = 8,
-        TransferAmount_ID = 9
+        TransferAmount_ID = 9,
+        Ping_ID = 11,
+        Subscribe_ID = 16,
+        Unsubscribe_ID = 17,
+        Event_ID = 18 // Account change pushed by the server after a subscription
     };
 
-    // Method to send a hashed request to the server
-    void sendHashRequest(QJsonObject &requestObject);
-    // Method to validate the response hash
-    bool validateHashResponse(QJsonObject &responseObject);
+    // Method to send a request to the server; its response is handled by onResponseDevice
+    void sendRequest(const QJsonObject &requestObject);
+    // Method to handle the response of a request sent with the client once it arrives
+    void handleResponse(QFuture<QJsonObject> response);
 
     // Handlers for different response types
     void handleLoginResponse(const QJsonObject &responseObject);
@@ -102,6 +122,16 @@ private:
     void handleViewTransactionHistoryResponse(const QJsonObject &responseObject);
     void handleMakeTransactionResponse(const QJsonObject &responseObject);
     void handleTransferAmountResponse(const QJsonObject &responseObject);
+    void handleSubscribeResponse(const QJsonObject &responseObject);
+    void handleAccountEvent(const QJsonObject &eventObject);
+
+    // Method to start fetching count transactions of an account, one page at a time
+    void requestHistory(const QString &account, qint32 count);
+    // Method to request the next page of the history
+    void requestHistoryPage();
+
+    // Method to show the balance of the logged in user
+    void showUserBalance(const QString &balance);
 };
 
 #endif // MAINWINDOW_H
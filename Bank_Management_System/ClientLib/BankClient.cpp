@@ -0,0 +1,342 @@
+#include "BankClient.h"
+#include <QJsonDocument>
+#include <QCryptographicHash>
+#include <QTimer>
+#include <QUuid>
+
+BankClient::BankClient(QObject *parent)
+    : QObject{parent}
+    , client(new MyClient) // Created without a parent so it can move to the network thread
+{
+    // Run the client on its own thread, so decoding and verifying large responses does not block the caller
+    client->moveToThread(&networkThread);
+    connect(&networkThread, &QThread::finished, client, &QObject::deleteLater);
+    networkThread.start();
+
+    // The signals of the client are queued to the thread of this object
+    connect(client, &MyClient::Connection, this, &BankClient::connected);
+    connect(client, &MyClient::Disconnected, this, &BankClient::disconnected);
+    connect(client, &MyClient::ErrorOccurred, this, &BankClient::errorOccurred);
+    connect(client, &MyClient::StateChanged, this, &BankClient::stateChanged);
+    connect(client, &MyClient::ResponseReceived, this, &BankClient::onResponse);
+    connect(client, &MyClient::RequestFailed, this, &BankClient::onFailed);
+}
+
+BankClient::~BankClient()
+{
+    // Stop the network thread; the client is deleted on it once its event loop ends
+    networkThread.quit();
+    networkThread.wait();
+
+    // The promises of the requests still waiting are destroyed with the table, which cancels their futures
+}
+
+void BankClient::connectToServers(const QList<QPair<QString, qint32>> &endpoints)
+{
+    QMetaObject::invokeMethod(client, [this, endpoints]() { client->ConnectToDevices(endpoints); });
+}
+
+void BankClient::disconnectFromServers()
+{
+    QMetaObject::invokeMethod(client, &MyClient::Disconnect);
+
+    // Complete the waiting requests now instead of retrying them on a closed pool
+    QList<quint64> tags = pending.keys();
+    for (quint64 tag : tags)
+    {
+        QJsonObject response;
+        response["ResponseID"] = pending[tag].request["RequestID"].toInt();
+        response["State"] = false;
+        response["Reason"] = NotDelivered;
+        complete(tag, response);
+    }
+}
+
+bool BankClient::enableTls(const QString &caCertificateFile)
+{
+    QMetaObject::invokeMethod(client, [this, caCertificateFile]() { return client->EnableTls(caCertificateFile); },
+                              Qt::BlockingQueuedConnection, &encrypted);
+    return encrypted;
+}
+
+bool BankClient::isEncrypted() const
+{
+    return encrypted;
+}
+
+QString BankClient::sessionToken() const
+{
+    return token;
+}
+
+void BankClient::setSessionToken(const QString &newToken)
+{
+    token = newToken;
+}
+
+void BankClient::setMaxRetries(qint32 count)
+{
+    maxRetries = qMax(count, 0);
+}
+
+void BankClient::setRetryDelay(qint32 milliseconds)
+{
+    retryDelay = qMax(milliseconds, 0);
+}
+
+QFuture<QJsonObject> BankClient::request(const QJsonObject &requestObject)
+{
+    quint64 tag = nextTag++;
+    Pending &entry = pending[tag];
+    entry.request = requestObject;
+    entry.promise = std::make_shared<QPromise<QJsonObject>>();
+    entry.promise->start();
+    QFuture<QJsonObject> future = entry.promise->future();
+
+    // The response arrives through a queued signal, so the caller can attach to the future first
+    send(tag);
+    return future;
+}
+
+QFuture<QJsonObject> BankClient::logIn(const QString &userName, const QString &password)
+{
+    QJsonObject requestObject;
+    requestObject["RequestID"] = LogIn_ID;
+    requestObject["UserName"] = userName;
+    requestObject["Password"] = password;
+    return request(requestObject);
+}
+
+QFuture<QJsonObject> BankClient::createUser(const QJsonObject &user)
+{
+    QJsonObject requestObject = user;
+    requestObject["RequestID"] = CreateUser_ID;
+    return request(requestObject);
+}
+
+QFuture<QJsonObject> BankClient::updateUser(const QJsonObject &user)
+{
+    QJsonObject requestObject = user;
+    requestObject["RequestID"] = UpDateUser_ID;
+    return request(requestObject);
+}
+
+QFuture<QJsonObject> BankClient::deleteUser(const QString &accountNumber)
+{
+    QJsonObject requestObject;
+    requestObject["RequestID"] = DeleteUser_ID;
+    requestObject["AccountNumber"] = accountNumber;
+    return request(requestObject);
+}
+
+QFuture<QJsonObject> BankClient::viewBankDB(const QString &sinceVersion, const QString &epoch)
+{
+    QJsonObject requestObject;
+    requestObject["RequestID"] = ViewBankDB_ID;
+
+    // With the version of a local copy only the changes since then are sent
+    if (!sinceVersion.isEmpty())
+    {
+        requestObject["SinceVersion"] = sinceVersion;
+        requestObject["Epoch"] = epoch;
+    }
+    return request(requestObject);
+}
+
+QFuture<QJsonObject> BankClient::getAccountNumber(const QString &userName)
+{
+    QJsonObject requestObject;
+    requestObject["RequestID"] = GetAccount_ID;
+    requestObject["UserName"] = userName;
+    return request(requestObject);
+}
+
+QFuture<QJsonObject> BankClient::getBalance(const QString &accountNumber)
+{
+    QJsonObject requestObject;
+    requestObject["RequestID"] = GetBalance_ID;
+    requestObject["AccountNumber"] = accountNumber;
+    return request(requestObject);
+}
+
+QFuture<QJsonObject> BankClient::viewTransactionHistory(const QString &accountNumber, qint32 count, const QString &cursor)
+{
+    QJsonObject requestObject;
+    requestObject["RequestID"] = ViewTransactionHistory_ID;
+    requestObject["AccountNumber"] = accountNumber;
+    requestObject["Count"] = QString::number(count);
+
+    // The cursor is the "NextCursor" of the previous page
+    if (!cursor.isEmpty())
+    {
+        requestObject["Cursor"] = cursor;
+    }
+    return request(requestObject);
+}
+
+QFuture<QJsonObject> BankClient::makeTransaction(const QString &accountNumber, const QString &amount)
+{
+    QJsonObject requestObject;
+    requestObject["RequestID"] = MakeTransaction_ID;
+    requestObject["AccountNumber"] = accountNumber;
+    requestObject["Amount"] = amount;
+    requestObject["IdempotencyKey"] = QUuid::createUuid().toString(QUuid::WithoutBraces); // A resent request is applied only once
+    return request(requestObject);
+}
+
+QFuture<QJsonObject> BankClient::transferAmount(const QString &senderAccountNumber, const QString &receiverAccountNumber, const QString &amount)
+{
+    QJsonObject requestObject;
+    requestObject["RequestID"] = TransferAmount_ID;
+    requestObject["SenderAccountNumber"] = senderAccountNumber;
+    requestObject["ReceiverAccountNumber"] = receiverAccountNumber;
+    requestObject["Amount"] = amount;
+    requestObject["IdempotencyKey"] = QUuid::createUuid().toString(QUuid::WithoutBraces); // A resent request is applied only once
+    return request(requestObject);
+}
+
+QFuture<QJsonObject> BankClient::ping()
+{
+    QJsonObject requestObject;
+    requestObject["RequestID"] = Ping_ID;
+    return request(requestObject);
+}
+
+QFuture<QJsonObject> BankClient::subscribe(const QStringList &accountNumbers)
+{
+    QJsonObject requestObject;
+    requestObject["RequestID"] = Subscribe_ID;
+    requestObject["AccountNumbers"] = QJsonArray::fromStringList(accountNumbers);
+    return request(requestObject);
+}
+
+QFuture<QJsonObject> BankClient::unsubscribe(const QStringList &accountNumbers)
+{
+    QJsonObject requestObject;
+    requestObject["RequestID"] = Unsubscribe_ID;
+    requestObject["AccountNumbers"] = QJsonArray::fromStringList(accountNumbers);
+    return request(requestObject);
+}
+
+bool BankClient::isReadRequest(qint32 requestID)
+{
+    switch (requestID)
+    {
+    case ViewBankDB_ID:
+    case GetAccount_ID:
+    case GetBalance_ID:
+    case ViewTransactionHistory_ID:
+    case Summary_ID:
+    case TopAccounts_ID:
+    case BalanceRange_ID:
+    case Search_ID:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void BankClient::send(quint64 tag)
+{
+    auto it = pending.find(tag);
+    if (it == pending.end())
+    {
+        return; // Completed while the retry was waiting
+    }
+    it->attempts++;
+
+    // Identify the logged in user; the server rejects other requests without a session
+    QJsonObject requestObject = it->request;
+    if (!token.isEmpty() && !requestObject.contains("SessionToken"))
+    {
+        requestObject["SessionToken"] = token;
+    }
+
+    // TLS already protects the integrity of the request; otherwise the hash is taken like the server does
+    if (!encrypted)
+    {
+        QByteArray hash = QCryptographicHash::hash(QJsonDocument(requestObject).toJson(), QCryptographicHash::Sha256);
+        requestObject["Hash"] = QString(hash.toHex());
+    }
+
+    // Send the request on the network thread; reads may be served by a replica
+    QByteArray data = QJsonDocument(requestObject).toJson(QJsonDocument::Compact);
+    bool readOnly = isReadRequest(requestObject["RequestID"].toInt());
+    QMetaObject::invokeMethod(client, [this, data, readOnly, tag]() { client->WriteData(data, readOnly, tag); });
+}
+
+void BankClient::scheduleRetry(quint64 tag)
+{
+    qint32 attempts = pending.value(tag).attempts;
+    QTimer::singleShot(retryDelay * (1 << qMin(attempts - 1, 10)), this, [this, tag]() { send(tag); });
+}
+
+void BankClient::onResponse(qint32 responseID, const QJsonObject &response, quint64 tag)
+{
+    // Events answer no request
+    if (tag == 0)
+    {
+        if (responseID == Event_ID)
+        {
+            emit accountEvent(response);
+        }
+        return;
+    }
+
+    auto it = pending.find(tag);
+    if (it == pending.end())
+    {
+        return;
+    }
+
+    // Requests shed because the server is busy (-15) or over a rate limit (-16) were not run,
+    // so they can be sent again whatever they do
+    qint32 reason = response["Reason"].toInt();
+    if (!response["State"].toBool() && ((reason == -15) || (reason == -16)) && (it->attempts <= maxRetries))
+    {
+        scheduleRetry(tag);
+        return;
+    }
+
+    // Later requests run in the session of the login
+    if ((responseID == LogIn_ID) && response["State"].toBool())
+    {
+        token = response["SessionToken"].toString();
+    }
+
+    complete(tag, response);
+}
+
+void BankClient::onFailed(quint64 tag)
+{
+    auto it = pending.find(tag);
+    if (it == pending.end())
+    {
+        return;
+    }
+
+    // A write may have been applied before its connection failed; only an idempotency key makes resending it safe
+    qint32 requestID = it->request["RequestID"].toInt();
+    bool resendable = isReadRequest(requestID) || it->request.contains("IdempotencyKey");
+    if (resendable && (it->attempts <= maxRetries) && networkThread.isRunning())
+    {
+        scheduleRetry(tag);
+        return;
+    }
+
+    QJsonObject response;
+    response["ResponseID"] = requestID;
+    response["State"] = false;
+    response["Reason"] = NotDelivered;
+    complete(tag, response);
+}
+
+void BankClient::complete(quint64 tag, const QJsonObject &response)
+{
+    Pending entry = pending.take(tag);
+    if (entry.promise)
+    {
+        entry.promise->addResult(response);
+        entry.promise->finish();
+    }
+}
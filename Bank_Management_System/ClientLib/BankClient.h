@@ -0,0 +1,146 @@
+#ifndef BANKCLIENT_H
+#define BANKCLIENT_H
+
+#include <QObject>      // Includes the base class for all Qt objects, providing essential features such as signals and slots
+#include <QThread>      // Includes the QThread class for the network thread
+#include <QFuture>      // Includes the QFuture class for the results of the requests
+#include <QPromise>     // Includes the QPromise class for completing the results
+#include <QJsonObject>  // Includes the QJsonObject class for the requests and responses
+#include <QJsonArray>   // Includes the QJsonArray class for the account lists of the subscriptions
+#include <QHash>        // Includes the QHash class for the requests waiting for a response
+#include <QList>        // Includes the QList class for the server endpoints
+#include <QPair>        // Includes the QPair class for ip/port endpoints
+#include <QStringList>  // Includes the QStringList class for the subscribed accounts
+#include <memory>       // Includes smart pointers such as std::shared_ptr
+#include "MyClient.h"   // Includes the connection pool the requests are sent on
+
+// BankClient is the asynchronous API of the bank server, usable without a GUI, e.g. by scripts and
+// load tools. Every call sends its request right away and returns a QFuture with the response, so
+// many requests can be pipelined on the pooled connections of a MyClient running on its own thread.
+// Requests are signed and carry the session token of the last login. Requests that get no response,
+// or that the server sheds because it is busy or over a rate limit, are sent again after a growing
+// delay, as long as sending them twice is safe: reads, and writes with an IdempotencyKey.
+// A BankClient must be used from the thread it was created on; the futures complete on that thread.
+class BankClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Reason of the responses made up by the client for requests that got no response from any server
+    static constexpr qint32 NotDelivered = -17;
+
+    // Constructor: Starts the network thread
+    explicit BankClient(QObject *parent = nullptr);
+    ~BankClient();
+
+    // Connects to a primary server (the first endpoint) and its read-only replicas (the others)
+    void connectToServers(const QList<QPair<QString, qint32>> &endpoints);
+
+    // Disconnects from all servers; requests waiting for a response complete with NotDelivered.
+    // Requests still waiting when the BankClient is destroyed have their futures canceled.
+    void disconnectFromServers();
+
+    // Uses TLS for the connections made from now on, see MyClient::EnableTls
+    bool enableTls(const QString &caCertificateFile = QString());
+
+    // Returns true if the connections use TLS, so requests are sent without a hash
+    bool isEncrypted() const;
+
+    // Methods to get and set the session token sent with every request; a successful LogIn sets it
+    QString sessionToken() const;
+    void setSessionToken(const QString &newToken);
+
+    // Methods to set how often and how soon a request is sent again; the delay doubles with every attempt
+    void setMaxRetries(qint32 count);
+    void setRetryDelay(qint32 milliseconds);
+
+    // Sends any request and returns its response. The request needs its "RequestID"; the session token
+    // and the hash are added here.
+    QFuture<QJsonObject> request(const QJsonObject &requestObject);
+
+    // Typed requests; each returns the response of the server
+    QFuture<QJsonObject> logIn(const QString &userName, const QString &password);
+    QFuture<QJsonObject> createUser(const QJsonObject &user);
+    QFuture<QJsonObject> updateUser(const QJsonObject &user);
+    QFuture<QJsonObject> deleteUser(const QString &accountNumber);
+    QFuture<QJsonObject> viewBankDB(const QString &sinceVersion = QString(), const QString &epoch = QString());
+    QFuture<QJsonObject> getAccountNumber(const QString &userName);
+    QFuture<QJsonObject> getBalance(const QString &accountNumber);
+    QFuture<QJsonObject> viewTransactionHistory(const QString &accountNumber, qint32 count, const QString &cursor = QString());
+    QFuture<QJsonObject> makeTransaction(const QString &accountNumber, const QString &amount);
+    QFuture<QJsonObject> transferAmount(const QString &senderAccountNumber, const QString &receiverAccountNumber, const QString &amount);
+    QFuture<QJsonObject> ping();
+    QFuture<QJsonObject> subscribe(const QStringList &accountNumbers);
+    QFuture<QJsonObject> unsubscribe(const QStringList &accountNumbers = QStringList());
+
+    // Enumeration of the request IDs of the server
+    enum RequestID {
+        LogIn_ID = 0,
+        CreateUser_ID = 1,
+        UpDateUser_ID = 2,
+        DeleteUser_ID = 3,
+        ViewBankDB_ID = 4,
+        GetAccount_ID = 5,
+        GetBalance_ID = 6,
+        ViewTransactionHistory_ID = 7,
+        MakeTransaction_ID = 8,
+        TransferAmount_ID = 9,
+        Batch_ID = 10,
+        Ping_ID = 11,
+        Summary_ID = 12,
+        TopAccounts_ID = 13,
+        BalanceRange_ID = 14,
+        Search_ID = 15,
+        Subscribe_ID = 16,
+        Unsubscribe_ID = 17,
+        Event_ID = 18 // Response ID of the account changes pushed after a subscription
+    };
+
+    // Method to check if a request only reads data, so any replica can serve it and it can be sent again
+    static bool isReadRequest(qint32 requestID);
+
+signals:
+    // Emitted when the client connects to or disconnects from the primary server
+    void connected();
+    void disconnected();
+
+    // Emitted when an error occurs with any socket of the pool, or the primary socket's state changes
+    void errorOccurred(QAbstractSocket::SocketError socketError);
+    void stateChanged(QAbstractSocket::SocketState socketState);
+
+    // Emitted with every account change pushed by the server after a subscription
+    void accountEvent(const QJsonObject &eventObject);
+
+private:
+    // A request waiting for its response
+    struct Pending
+    {
+        QJsonObject request; // Request as given, without session token and hash
+        qint32 attempts = 0; // Number of times it was sent
+        std::shared_ptr<QPromise<QJsonObject>> promise; // Result handed out to the caller
+    };
+
+    // Method to sign a request and send it on the network thread
+    void send(quint64 tag);
+
+    // Method to send a request again after a delay that doubles with every attempt
+    void scheduleRetry(quint64 tag);
+
+    // Handlers for the signals of the client
+    void onResponse(qint32 responseID, const QJsonObject &response, quint64 tag);
+    void onFailed(quint64 tag);
+
+    // Method to complete a request with its response
+    void complete(quint64 tag, const QJsonObject &response);
+
+    QThread networkThread; // Thread the client reads, decodes and verifies the responses on
+    MyClient *client; // Connection pool, living on networkThread
+    bool encrypted = false; // Set when the client uses TLS
+    QString token; // Session token of the last login
+    QHash<quint64, Pending> pending; // Requests waiting for a response, by tag
+    quint64 nextTag = 1; // Tag of the next request; 0 stands for no request
+    qint32 maxRetries = 3; // Number of times a request is sent again
+    qint32 retryDelay = 200; // Delay before the first retry, in milliseconds
+};
+
+#endif // BANKCLIENT_H
@@ -0,0 +1,26 @@
+# Headless client library: the connection pool (MyClient) and the asynchronous request API (BankClient).
+# Built once as a static library and linked by the applications using it, such as the GUI client.
+TEMPLATE = lib
+CONFIG += staticlib
+
+QT = core network
+
+CONFIG += c++17
+
+SOURCES += \
+    BankClient.cpp \
+    MyClient.cpp
+
+HEADERS += \
+    BankClient.h \
+    MyClient.h
+
+# You can make your code fail to compile if it uses deprecated APIs.
+# In order to do so, uncomment the following line.
+#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
+
+# Default rules for deployment.
+unix {
+    target.path = /usr/lib
+}
+!isEmpty(target.path): INSTALLS += target
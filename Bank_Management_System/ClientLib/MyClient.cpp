@@ -0,0 +1,393 @@
+#include "MyClient.h"
+
+MyClient::MyClient(QObject *parent)
+    : QObject{parent}
+{
+}
+
+MyClient::~MyClient()
+{
+    closePool();
+}
+
+void MyClient::ConnectToDevice(QString ip, qint32 port)
+{
+    ConnectToDevices({qMakePair(ip, port)});
+}
+
+void MyClient::ConnectToDevices(const QList<QPair<QString, qint32>> &endpoints)
+{
+    // If the pool is already open, check if the connection parameters match
+    if (!pool.isEmpty() && pool.first().socket->isOpen() && (pool.size() == endpoints.size()))
+    {
+        bool same = true;
+        for (qint32 i = 0; i < pool.size(); i++)
+        {
+            same = same && (pool[i].ip == endpoints[i].first) && (pool[i].port == endpoints[i].second);
+        }
+        if (same)
+        {
+            return; // Already connected to the correct devices
+        }
+    }
+
+    // Close the existing connections and connect to the new endpoints
+    closePool();
+    openPool(endpoints);
+}
+
+void MyClient::Disconnect()
+{
+    // Close the sockets if they're open, then drop the pool so replicas stop reconnecting
+    for (Endpoint &endpoint : pool)
+    {
+        if (endpoint.socket->isOpen())
+        {
+            endpoint.socket->close();
+        }
+    }
+    closePool();
+}
+
+bool MyClient::EnableTls(const QString &caCertificateFile)
+{
+    if (!QSslSocket::supportsSsl())
+    {
+        return false;
+    }
+
+    QSslConfiguration config = QSslConfiguration::defaultConfiguration();
+    config.setProtocol(QSsl::TlsV1_2OrLater);
+
+    // Trust a self-signed server certificate, e.g. for testing on localhost
+    if (!caCertificateFile.isEmpty())
+    {
+        QList<QSslCertificate> certificates = QSslCertificate::fromPath(caCertificateFile, QSsl::Pem);
+        if (certificates.isEmpty())
+        {
+            return false;
+        }
+        config.addCaCertificates(certificates);
+    }
+
+    // Keep the session so a reconnect resumes it with an abbreviated handshake
+    config.setSslOption(QSsl::SslOptionDisableSessionPersistence, false);
+    config.setSslOption(QSsl::SslOptionDisableSessionTickets, false);
+
+    tlsConfiguration = config;
+    tls = true;
+    return true;
+}
+
+bool MyClient::IsEncrypted() const
+{
+    return tls;
+}
+
+void MyClient::WriteData(QByteArray data, bool readOnly, quint64 tag)
+{
+    qint32 index = route(readOnly);
+
+    // Write data to the socket if it's open; requests are pipelined without waiting for the previous response
+    if ((index >= 0) && pool[index].socket->isOpen())
+    {
+        pool[index].socket->write(data);
+        pool[index].inFlight.append(data);
+        pool[index].inFlightReads.append(readOnly);
+        pool[index].inFlightTags.append(tag);
+    }
+    else if (tag != 0)
+    {
+        emit RequestFailed(tag);
+    }
+}
+
+void MyClient::openPool(const QList<QPair<QString, qint32>> &endpoints)
+{
+    for (qint32 i = 0; i < endpoints.size(); i++)
+    {
+        Endpoint endpoint;
+        endpoint.ip = endpoints[i].first;
+        endpoint.port = endpoints[i].second;
+        endpoint.socket = tls ? new QSslSocket(this) : new QTcpSocket(this);
+        pool.append(endpoint);
+
+        // Connect signals from QTcpSocket to the handlers of this pool entry
+        QTcpSocket *socket = endpoint.socket;
+        if (tls)
+        {
+            // Requests may only be sent once the handshake completed
+            QSslSocket *sslSocket = static_cast<QSslSocket*>(socket);
+            QString server = endpoint.ip + ":" + QString::number(endpoint.port);
+            connect(sslSocket, &QSslSocket::encrypted, this, [this, i, sslSocket, server]() {
+                // TLS 1.2 hands out its ticket during the handshake
+                QByteArray ticket = sslSocket->sslConfiguration().sessionTicket();
+                if (!ticket.isEmpty())
+                {
+                    sessionTickets[server] = ticket;
+                }
+                onConnection(i);
+            });
+
+            // TLS 1.3 sends the tickets after the handshake; the latest one is kept for the next connection
+            connect(sslSocket, &QSslSocket::newSessionTicketReceived, this, [this, sslSocket, server]() {
+                sessionTickets[server] = sslSocket->sslConfiguration().sessionTicket();
+            });
+        }
+        else
+        {
+            connect(socket, &QTcpSocket::connected, this, [this, i]() { onConnection(i); });
+        }
+        connect(socket, &QTcpSocket::disconnected, this, [this, i]() { onDisconnected(i); });
+        connect(socket, &QTcpSocket::errorOccurred, this, [this, i](QAbstractSocket::SocketError socketError) { onErrorOccurred(i, socketError); });
+        connect(socket, &QTcpSocket::stateChanged, this, [this, i](QAbstractSocket::SocketState socketState) { onStateChanged(i, socketState); });
+        connect(socket, &QTcpSocket::readyRead, this, [this, i]() { onReadyRead(i); });
+
+        connectSocket(socket, endpoint.ip, endpoint.port);
+    }
+}
+
+void MyClient::connectSocket(QTcpSocket *socket, const QString &ip, qint32 port)
+{
+    if (!tls)
+    {
+        socket->connectToHost(ip, port);
+        return;
+    }
+
+    // Offer the ticket of the previous connection to this server to skip the full handshake
+    QSslConfiguration config = tlsConfiguration;
+    config.setSessionTicket(sessionTickets.value(ip + ":" + QString::number(port)));
+
+    QSslSocket *sslSocket = static_cast<QSslSocket*>(socket);
+    sslSocket->setSslConfiguration(config);
+    sslSocket->connectToHostEncrypted(ip, port);
+}
+
+void MyClient::closePool()
+{
+    for (Endpoint &endpoint : pool)
+    {
+        // The requests in flight will not be answered any more
+        for (quint64 tag : std::as_const(endpoint.inFlightTags))
+        {
+            if (tag != 0)
+            {
+                emit RequestFailed(tag);
+            }
+        }
+
+        endpoint.socket->disconnect(this); // Stop the handlers before closing
+        endpoint.socket->abort();
+        endpoint.socket->deleteLater();
+    }
+    pool.clear();
+}
+
+qint32 MyClient::route(bool readOnly, qint32 exclude) const
+{
+    // Reads go to the connected replica with the fewest requests in flight
+    if (readOnly)
+    {
+        qint32 best = -1;
+        for (qint32 i = 1; i < pool.size(); i++)
+        {
+            if ((i == exclude) || (pool[i].socket->state() != QAbstractSocket::ConnectedState))
+            {
+                continue;
+            }
+            if ((best < 0) || (pool[i].inFlight.size() < pool[best].inFlight.size()))
+            {
+                best = i;
+            }
+        }
+        if (best >= 0)
+        {
+            return best;
+        }
+    }
+
+    // Writes, and reads without an available replica, go to the primary
+    if (pool.isEmpty() || (exclude == 0))
+    {
+        return -1;
+    }
+    return 0;
+}
+
+void MyClient::onConnection(qint32 index)
+{
+    // Emit the Connection signal when the primary socket is connected
+    if (index == 0)
+    {
+        emit Connection();
+    }
+}
+
+void MyClient::onDisconnected(qint32 index)
+{
+    // Emit the Disconnected signal when the primary socket is disconnected
+    if (index == 0)
+    {
+        emit Disconnected();
+    }
+}
+
+void MyClient::onErrorOccurred(qint32 index, QAbstractSocket::SocketError socketError)
+{
+    Endpoint &endpoint = pool[index];
+
+    // Fail over the reads in flight on this connection; writes are not repeated
+    // because the server may already have applied them
+    QList<QByteArray> requests = endpoint.inFlight;
+    QList<bool> reads = endpoint.inFlightReads;
+    QList<quint64> tags = endpoint.inFlightTags;
+    endpoint.inFlight.clear();
+    endpoint.inFlightReads.clear();
+    endpoint.inFlightTags.clear();
+    endpoint.buffer.clear(); // A partial message will never be completed
+    endpoint.scan = ScanState();
+
+    for (qint32 i = 0; i < requests.size(); i++)
+    {
+        qint32 target = reads[i] ? route(true, index) : -1;
+        if (target >= 0)
+        {
+            pool[target].socket->write(requests[i]);
+            pool[target].inFlight.append(requests[i]);
+            pool[target].inFlightReads.append(true);
+            pool[target].inFlightTags.append(tags[i]);
+        }
+        else if (tags[i] != 0)
+        {
+            emit RequestFailed(tags[i]);
+        }
+    }
+
+    // Replicas reconnect on their own; the primary is reconnected by the user
+    if (index > 0)
+    {
+        QTcpSocket *socket = endpoint.socket;
+        QString ip = endpoint.ip;
+        qint32 port = endpoint.port;
+        QTimer::singleShot(2000, socket, [this, socket, ip, port]() {
+            if (socket->state() == QAbstractSocket::UnconnectedState)
+            {
+                connectSocket(socket, ip, port);
+            }
+        });
+    }
+
+    // Emit the ErrorOccurred signal with the socket error code
+    emit ErrorOccurred(socketError);
+}
+
+void MyClient::onStateChanged(qint32 index, QAbstractSocket::SocketState socketState)
+{
+    // Close the socket if it transitions to UnconnectedState
+    if (socketState == QAbstractSocket::UnconnectedState)
+    {
+        pool[index].socket->close();
+    }
+    // Emit the StateChanged signal with the new state of the primary socket
+    if (index == 0)
+    {
+        emit StateChanged(socketState);
+    }
+}
+
+void MyClient::onReadyRead(qint32 index)
+{
+    Endpoint &endpoint = pool[index];
+    endpoint.buffer.append(endpoint.socket->readAll());
+
+    // Decode every whole message; the rest waits for more data
+    qint32 start = 0;
+    qint32 length;
+    while ((length = messageLength(endpoint.buffer, start, endpoint.scan)) > 0)
+    {
+        QJsonObject message = QJsonDocument::fromJson(endpoint.buffer.mid(start, length)).object();
+        start += length;
+
+        // A response answers the oldest request in flight on this connection; a pushed event answers none
+        quint64 tag = 0;
+        if (!message.contains("Event") && !endpoint.inFlight.isEmpty())
+        {
+            endpoint.inFlight.removeFirst();
+            endpoint.inFlightReads.removeFirst();
+            tag = endpoint.inFlightTags.takeFirst();
+        }
+
+        // Only whole objects with a valid hash are handed on
+        if (!message.isEmpty() && verifyHash(message))
+        {
+            emit ResponseReceived(message["ResponseID"].toInt(), message, tag);
+        }
+        else if (tag != 0)
+        {
+            emit RequestFailed(tag);
+        }
+    }
+
+    // Drop the decoded messages at once instead of moving the rest after each of them
+    endpoint.buffer.remove(0, start);
+    endpoint.scan.offset -= start;
+}
+
+bool MyClient::verifyHash(QJsonObject &message) const
+{
+    // Extract the hash and remove it for hashing the rest of the message
+    QByteArray receivedHash = QByteArray::fromHex(message.value("Hash").toString().toUtf8());
+    message.remove("Hash");
+
+    // Over TLS the server sends no hash; the TLS layer has verified the message
+    if (tls)
+    {
+        return true;
+    }
+
+    // Compare the hash of the message without the hash field with the received one
+    return QCryptographicHash::hash(QJsonDocument(message).toJson(), QCryptographicHash::Sha256) == receivedHash;
+}
+
+qint32 MyClient::messageLength(const QByteArray &buffer, qint32 start, ScanState &scan)
+{
+    // Count the braces outside of strings until the object is closed, starting after the bytes already looked at
+    for (qint32 i = qMax(scan.offset, start); i < buffer.size(); i++)
+    {
+        char c = buffer.at(i);
+        if (scan.inString)
+        {
+            if (scan.escaped)
+            {
+                scan.escaped = false;
+            }
+            else if (c == '\\')
+            {
+                scan.escaped = true;
+            }
+            else if (c == '"')
+            {
+                scan.inString = false;
+            }
+        }
+        else if (c == '"')
+        {
+            scan.inString = true;
+        }
+        else if (c == '{')
+        {
+            scan.depth++;
+        }
+        else if ((c == '}') && (scan.depth > 0) && (--scan.depth == 0))
+        {
+            // The next message starts right after this one
+            scan = ScanState();
+            scan.offset = i + 1;
+            return i + 1 - start;
+        }
+    }
+
+    scan.offset = static_cast<qint32>(buffer.size());
+    return 0;
+}
@@ -0,0 +1,133 @@
+#ifndef MYCLIENT_H
+#define MYCLIENT_H
+
+#include <QObject>    // Includes the base class for all Qt objects, providing essential features such as signals and slots
+#include <QTcpSocket> // Includes the QTcpSocket class, which provides a TCP socket for network communication
+#include <QSslSocket> // Includes the QSslSocket class for TLS connections
+#include <QSslConfiguration> // Includes the QSslConfiguration class for the TLS settings and session tickets
+#include <QHash>      // Includes the QHash class for the session tickets of the servers
+#include <QTimer>     // Includes the QTimer class, used to reconnect to replicas after an error
+#include <QList>      // Includes the QList class for the connection pool
+#include <QPair>      // Includes the QPair class for ip/port endpoints
+#include <QJsonDocument> // Includes the QJsonDocument class for decoding the received messages
+#include <QJsonObject>   // Includes the QJsonObject class for the decoded messages
+#include <QCryptographicHash> // Includes the QCryptographicHash class for verifying the message hashes
+
+// MyClient is a class that provides an interface for a TCP client.
+// It keeps a pool of connections to a primary server and its read-only replicas:
+// writes go to the primary, reads go to the least-loaded replica, and reads in flight
+// on a connection that fails are sent again on another one.
+// The received bytes are split into whole JSON messages, since a response may arrive in several
+// pieces or together with an account change event pushed by the server.
+// A MyClient is meant to live on its own thread: messages are decoded and their hash verified
+// there, and only the decoded objects are handed to its owner (see BankClient) through queued signals.
+// Its methods must be called on that thread, e.g. with QMetaObject::invokeMethod.
+class MyClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Constructor: Initializes the client with an optional parent object
+    explicit MyClient(QObject *parent = nullptr);
+    ~MyClient();
+
+    // Connects to a single TCP server at the specified IP address and port
+    void ConnectToDevice(QString ip, qint32 port);
+
+    // Connects to a primary server (the first endpoint) and its read-only replicas (the others)
+    void ConnectToDevices(const QList<QPair<QString, qint32>> &endpoints);
+
+    // Disconnects from all servers
+    void Disconnect();
+
+    // Uses TLS for the connections made from now on. caCertificateFile may hold the certificate of a
+    // server with a self-signed certificate; it is trusted in addition to the system certificates.
+    // Returns false if TLS is not available or the file cannot be read.
+    bool EnableTls(const QString &caCertificateFile = QString());
+
+    // Returns true if the connections use TLS, which makes the payload hash unnecessary
+    bool IsEncrypted() const;
+
+    // Sends data to the primary server, or to the least-loaded replica if the request only reads.
+    // A non-zero tag is handed back with the response, or with RequestFailed if none will come.
+    void WriteData(QByteArray data, bool readOnly = false, quint64 tag = 0);
+
+signals:
+    // Emitted when the client successfully connects to the primary server
+    void Connection();
+
+    // Emitted when the client disconnects from the primary server
+    void Disconnected();
+
+    // Emitted when an error occurs with any socket of the pool
+    void ErrorOccurred(QAbstractSocket::SocketError socketError);
+
+    // Emitted when the primary socket's state changes
+    void StateChanged(QAbstractSocket::SocketState socketState);
+
+    // Emitted with every decoded and verified message received from any server, i.e. a response or a
+    // pushed event, and the tag of the request it answers (0 for events); messages that are not JSON
+    // objects or fail the hash check are dropped
+    void ResponseReceived(qint32 responseID, QJsonObject response, quint64 tag);
+
+    // Emitted with the tag of a request that will not be answered: there was no connection to send it
+    // on, its connection failed and it could not be sent again, or its response failed the hash check
+    void RequestFailed(quint64 tag);
+
+private:
+    // Progress of the search for the end of the next message in a buffer, kept between reads so
+    // every received byte is looked at once, however many pieces a large message arrives in
+    struct ScanState
+    {
+        qint32 offset = 0;     // Bytes of the buffer already looked at
+        qint32 depth = 0;      // Braces opened and not closed yet
+        bool inString = false; // Whether the offset is inside a string
+        bool escaped = false;  // Whether the last character looked at escapes the next one
+    };
+
+    // A pooled connection to one server
+    struct Endpoint
+    {
+        QString ip;                 // IP address of the server
+        qint32 port;                // Port number of the server
+        QTcpSocket *socket;         // Socket connected to the server, owned by MyClient
+        QList<QByteArray> inFlight; // Requests sent and not answered yet
+        QList<bool> inFlightReads;  // Whether each request in flight only reads
+        QList<quint64> inFlightTags; // Tag of each request in flight
+        QByteArray buffer;          // Received bytes not forming a whole message yet
+        ScanState scan;             // Progress of the search for the end of the next message in buffer
+    };
+
+    // Returns the length of the whole JSON object starting at start in the buffer, or 0 if it is
+    // incomplete. The scan continues where the last call stopped and is reset for the next message.
+    static qint32 messageLength(const QByteArray &buffer, qint32 start, ScanState &scan);
+
+    // Verifies the hash of a received message and removes it; over TLS there is no hash to check
+    bool verifyHash(QJsonObject &message) const;
+
+    // Starts connecting a socket of the pool, over TLS if enabled
+    void connectSocket(QTcpSocket *socket, const QString &ip, qint32 port);
+
+    // Creates the sockets of the pool and connects them
+    void openPool(const QList<QPair<QString, qint32>> &endpoints);
+
+    // Closes and deletes all sockets of the pool
+    void closePool();
+
+    // Returns the index of the connection a request should go to, skipping the excluded one
+    qint32 route(bool readOnly, qint32 exclude = -1) const;
+
+    // Handlers for the signals of the socket at the given index
+    void onConnection(qint32 index);
+    void onDisconnected(qint32 index);
+    void onErrorOccurred(qint32 index, QAbstractSocket::SocketError socketError);
+    void onStateChanged(qint32 index, QAbstractSocket::SocketState socketState);
+    void onReadyRead(qint32 index);
+
+    QList<Endpoint> pool; // Connection pool; index 0 is the primary server
+    bool tls = false; // Set when the connections use TLS
+    QSslConfiguration tlsConfiguration; // TLS settings of new connections
+    QHash<QString, QByteArray> sessionTickets; // Last session ticket of each "ip:port", used to resume TLS sessions
+};
+
+#endif // MYCLIENT_H
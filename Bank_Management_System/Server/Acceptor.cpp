@@ -0,0 +1,119 @@
+#include "Acceptor.h"
+#include <QDebug>
+#include <cstring> // Includes std::memcpy for filling the socket address
+
+#ifdef Q_OS_UNIX
+#include <sys/socket.h> // Includes socket, setsockopt, bind and listen
+#include <netinet/in.h> // Includes the IPv4 and IPv6 socket addresses
+#include <arpa/inet.h>  // Includes htons and htonl
+#include <fcntl.h>      // Includes fcntl for closing the socket in child processes
+#include <unistd.h>     // Includes close
+#endif
+
+// Number of connections refused since the server started
+std::atomic<quint64> Acceptor::refusedCount{0};
+
+// Constructor for Acceptor
+Acceptor::Acceptor(Logger *logs, QObject *parent)
+    : QTcpServer{parent}, ServerLogs{logs}
+{
+}
+
+// Opens a listening socket with SO_REUSEPORT and hands it to the server
+bool Acceptor::listenShared(QTcpServer *server, const QHostAddress &address, quint16 port)
+{
+#if defined(Q_OS_UNIX) && defined(SO_REUSEPORT)
+    // QHostAddress::Any listens on IPv6 and IPv4 like QTcpServer::listen() does
+    bool any = (address == QHostAddress::Any);
+    bool ipv6 = any || (address.protocol() == QAbstractSocket::IPv6Protocol);
+
+    int fd = ::socket(ipv6 ? AF_INET6 : AF_INET, SOCK_STREAM, 0);
+    if ((fd < 0) && any)
+    {
+        // Hosts without IPv6 still get an IPv4 socket
+        ipv6 = false;
+        fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    }
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    int on = 1;
+    int off = 0;
+    ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on));
+
+    sockaddr_storage storage;
+    std::memset(&storage, 0, sizeof(storage));
+    socklen_t length;
+
+    if (ipv6)
+    {
+        if (any)
+        {
+            ::setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+        }
+
+        sockaddr_in6 *address6 = reinterpret_cast<sockaddr_in6*>(&storage);
+        Q_IPV6ADDR ip = any ? QHostAddress(QHostAddress::AnyIPv6).toIPv6Address() : address.toIPv6Address();
+        address6->sin6_family = AF_INET6;
+        address6->sin6_port = htons(port);
+        std::memcpy(&address6->sin6_addr, &ip, sizeof(ip));
+        length = sizeof(sockaddr_in6);
+    }
+    else
+    {
+        sockaddr_in *address4 = reinterpret_cast<sockaddr_in*>(&storage);
+        address4->sin_family = AF_INET;
+        address4->sin_port = htons(port);
+        address4->sin_addr.s_addr = any ? htonl(INADDR_ANY) : htonl(address.toIPv4Address());
+        length = sizeof(sockaddr_in);
+    }
+
+    if ((::bind(fd, reinterpret_cast<sockaddr*>(&storage), length) != 0)
+        || (::listen(fd, SOMAXCONN) != 0)
+        || !server->setSocketDescriptor(fd))
+    {
+        ::close(fd);
+        return false;
+    }
+    return true;
+#else
+    // Windows has no SO_REUSEPORT; the caller falls back to a single acceptor
+    Q_UNUSED(server);
+    Q_UNUSED(address);
+    Q_UNUSED(port);
+    return false;
+#endif
+}
+
+// Applies the connection limit to a new connection
+bool Acceptor::admit(qintptr handle, Logger *logs)
+{
+    // Refuse the connection instead of starting yet another thread once the limit is reached
+    if (!AdmissionControl::getInstance()->admitConnection())
+    {
+        // Only the first refusal of every batch is logged, with the total so far
+        quint64 refused = ++refusedCount;
+        if ((refused % refusedLogInterval) == 1)
+        {
+            logs->log("Refused " + QString::number(refused) + " connections so far: too many connections", Logger::Warning);
+        }
+        QTcpSocket refusedSocket;
+        refusedSocket.setSocketDescriptor(handle);
+        refusedSocket.abort();
+        return false;
+    }
+    return true;
+}
+
+// Admits the connection on this thread and hands it to the BankServer
+void Acceptor::incomingConnection(qintptr handle)
+{
+    if (admit(handle, ServerLogs))
+    {
+        emit clientAccepted(handle);
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef ACCEPTOR_H
+#define ACCEPTOR_H
+
+#include <QObject>      // Includes the base class for all Qt objects
+#include <QTcpServer>   // Includes the class for TCP server functionalities
+#include <QTcpSocket>   // Includes the QTcpSocket class for closing refused connections
+#include <QHostAddress> // Includes the QHostAddress class for the bind address
+#include <atomic>       // Includes std::atomic for the count of refused connections
+#include "AdmissionControl.h"
+#include "Logger.h"
+
+// The Acceptor class accepts client connections on a thread of its own.
+// Every acceptor listens on its own socket bound to the same port with SO_REUSEPORT, so the
+// kernel spreads the incoming connections over the acceptors and accepting scales with the
+// cores. An acceptor only admits the connection; the BankServer starts its ClientHandler.
+class Acceptor : public QTcpServer
+{
+    Q_OBJECT // Macro to enable Qt's meta-object system, including signals and slots
+
+public:
+    // Constructor to create an acceptor logging to the server logger.
+    explicit Acceptor(Logger *logs, QObject *parent = nullptr);
+
+    // Method to make a server listen on a socket that shares its port with other sockets.
+    // Must run on the server's thread. Returns false where SO_REUSEPORT is not supported.
+    static bool listenShared(QTcpServer *server, const QHostAddress &address, quint16 port);
+
+    // Method to apply the connection limit; refused connections are closed right away.
+    // Nothing is logged for admitted connections, and refusals are logged in batches, so a
+    // connection storm does not wait on the log file.
+    static bool admit(qintptr handle, Logger *logs);
+
+signals:
+    // Signal emitted with the socket descriptor of every admitted connection.
+    void clientAccepted(qintptr handle);
+
+protected:
+    // Override the QTcpServer::incomingConnection() method to hand the connection on.
+    void incomingConnection(qintptr handle) override;
+
+private:
+    Logger *ServerLogs; // Server logger shared with the BankServer.
+    static std::atomic<quint64> refusedCount; // Connections refused by all acceptors.
+    static constexpr quint64 refusedLogInterval = 1000; // Refusals between two log messages.
+};
+
+#endif // ACCEPTOR_H
@@ -0,0 +1,122 @@
+#include "AdmissionControl.h"
+
+// Number of per-account buckets kept before the idle ones are dropped
+static const qint32 MaxIdleBuckets = 10000;
+
+// Constructor: Uses the default limits
+AdmissionControl::AdmissionControl()
+    : connections{0}, queued{0}
+{
+    slots.release(current.maxActiveRequests);
+}
+
+// Static method to get the singleton instance of AdmissionControl
+std::shared_ptr<AdmissionControl> AdmissionControl::getInstance()
+{
+    static std::shared_ptr<AdmissionControl> instance(new AdmissionControl());
+    return instance;
+}
+
+// Sets the limits and resizes the running slots
+void AdmissionControl::configure(const Limits &newLimits)
+{
+    Limits limits = newLimits;
+    limits.maxActiveRequests = qMax(limits.maxActiveRequests, 1);
+
+    if (limits.maxActiveRequests > current.maxActiveRequests)
+    {
+        slots.release(limits.maxActiveRequests - current.maxActiveRequests);
+    }
+    else if (limits.maxActiveRequests < current.maxActiveRequests)
+    {
+        slots.acquire(current.maxActiveRequests - limits.maxActiveRequests);
+    }
+
+    QMutexLocker locker(&accountMutex);
+    current = limits;
+    accountBuckets.clear(); // New buckets get the new rates
+}
+
+// Returns the current limits
+AdmissionControl::Limits AdmissionControl::limits() const
+{
+    return current;
+}
+
+// Counts a new connection unless the limit is reached
+bool AdmissionControl::admitConnection()
+{
+    if (++connections > current.maxConnections)
+    {
+        --connections;
+        return false;
+    }
+    return true;
+}
+
+// Counts a closed connection
+void AdmissionControl::releaseConnection()
+{
+    --connections;
+}
+
+// Takes a token from the bucket of an account
+bool AdmissionControl::allowAccount(const QString &accountNumber)
+{
+    if (current.accountRate <= 0)
+    {
+        return true; // No per-account limit configured
+    }
+
+    QMutexLocker locker(&accountMutex);
+
+    // Buckets that refilled completely behave like new ones, so they can be dropped
+    if (accountBuckets.size() > MaxIdleBuckets)
+    {
+        for (auto it = accountBuckets.begin(); it != accountBuckets.end();)
+        {
+            if (it->isFull())
+            {
+                it = accountBuckets.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    auto it = accountBuckets.find(accountNumber);
+    if (it == accountBuckets.end())
+    {
+        it = accountBuckets.insert(accountNumber, TokenBucket(current.accountRate, current.accountBurst));
+    }
+    return it->tryTake();
+}
+
+// Waits for a running slot unless too many requests are already waiting
+bool AdmissionControl::acquireSlot()
+{
+    // Fast path: a free slot needs no queueing
+    if (slots.tryAcquire())
+    {
+        return true;
+    }
+
+    // Shed the request at once if the queue is full, so the queue never grows without bound
+    if (++queued > current.maxQueuedRequests)
+    {
+        --queued;
+        return false;
+    }
+
+    bool acquired = slots.tryAcquire(1, current.queueTimeoutMs);
+    --queued;
+    return acquired;
+}
+
+// Gives a running slot back
+void AdmissionControl::releaseSlot()
+{
+    slots.release();
+}
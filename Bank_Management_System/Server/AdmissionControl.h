@@ -0,0 +1,72 @@
+#ifndef ADMISSIONCONTROL_H
+#define ADMISSIONCONTROL_H
+
+#include <QString>        // Includes the QString class for the account numbers
+#include <QHash>          // Includes the QHash class for the per-account buckets
+#include <QMutex>         // Includes the QMutex class for protecting the per-account buckets
+#include <QSemaphore>     // Includes the QSemaphore class for the slots of running requests
+#include <QThread>        // Includes the QThread class for the default number of running requests
+#include <memory>         // Includes smart pointers such as std::shared_ptr
+#include <atomic>         // Includes std::atomic for the connection and queue counters
+#include "TokenBucket.h"
+
+// The AdmissionControl class protects the server against overload.
+// It limits the number of open connections, the request rate of every connection and of every
+// account, and the number of requests running at once. Requests beyond that wait in a bounded
+// queue for a limited time; once the queue is full or the wait times out they are refused with
+// a "busy" reason instead of piling up, which keeps the latency of the admitted requests bounded.
+class AdmissionControl
+{
+public:
+    // The configurable limits; a rate of 0 disables that rate limit. The rate limits are off by
+    // default, since clients sharing an address (e.g. behind a NAT) would otherwise be refused.
+    struct Limits
+    {
+        qint32 maxConnections = 1000; // Open client connections.
+        double connectionRate = 0; // Requests per second of one connection.
+        double connectionBurst = 0; // Requests one connection may send at once.
+        double accountRate = 0; // Requests per second of one account.
+        double accountBurst = 0; // Requests one account may send at once.
+        qint32 maxActiveRequests = QThread::idealThreadCount() * 2; // Requests running at once.
+        qint32 maxQueuedRequests = 256; // Requests waiting for a running slot.
+        qint32 queueTimeoutMs = 1000; // Time a request may wait for a running slot.
+    };
+
+    // Method to get the singleton instance of AdmissionControl.
+    static std::shared_ptr<AdmissionControl> getInstance();
+
+    // Delete the copy constructor and the assignment operator to prevent copying.
+    AdmissionControl(const AdmissionControl&) = delete;
+    AdmissionControl& operator=(const AdmissionControl&) = delete;
+
+    // Method to set the limits; must be called before the server accepts connections.
+    void configure(const Limits &newLimits);
+
+    // Method to get the current limits.
+    Limits limits() const;
+
+    // Methods to count a new connection, refused if the limit is reached, and a closed one.
+    bool admitConnection();
+    void releaseConnection();
+
+    // Method to take a token from the bucket of an account. Returns false if the account is over its rate.
+    bool allowAccount(const QString &accountNumber);
+
+    // Methods to wait for a running slot in the bounded queue and to give it back.
+    // acquireSlot() returns false if the queue is full or the wait timed out.
+    bool acquireSlot();
+    void releaseSlot();
+
+private:
+    // Constructor to initialize the AdmissionControl object with the default limits.
+    AdmissionControl();
+
+    Limits current; // The limits in use.
+    std::atomic<qint32> connections; // Number of open connections.
+    std::atomic<qint32> queued; // Number of requests waiting for a slot.
+    QSemaphore slots; // Free slots for running requests.
+    QHash<QString, TokenBucket> accountBuckets; // Rate limit of every active account.
+    QMutex accountMutex; // Mutex protecting the per-account buckets.
+};
+
+#endif // ADMISSIONCONTROL_H
@@ -1,17 +1,26 @@
 #include <QDir>
 #include <memory>          // Includes smart pointers such as std::unique_ptr
+#include <csignal>         // Includes std::signal for the stop signals
 #include "BankServer.h"
 #include "ClientHandler.h" // Includes the custom header for handling client connections
 
+// Set by the signal handler; a signal handler may do nothing else safely, so a timer checks it
+static volatile std::sig_atomic_t stopRequested = 0;
+
+static void onStopSignal(int)
+{
+    stopRequested = 1;
+}
+
 // Constructor for BankServer
 BankServer::BankServer(QObject *parent)
-    : QTcpServer{parent}, qin{stdin}, qout{stdout}, port{0}
+    : QTcpServer{parent}, qin{stdin}, qout{stdout}, port{0}, drainTimeout{10000}, acceptorCount{1}
 {
     // Initializes the QTcpServer base class with the given parent
     // Initializes QTextStream objects qin and qout to read from stdin and write to stdout
      // Initialize port to 0
     QDir dir;
-    QString folderPath = "Logs";
+    QString folderPath = Logger::directory();
 
     // Check if the directory exists
     if (!dir.exists(folderPath))
@@ -21,25 +30,57 @@ BankServer::BankServer(QObject *parent)
     }
 
     ServerLogs = new Logger("Logs/ServerLogs.txt");
+
+    // One-second ticks over a one-minute wheel; longer timeouts go around the wheel several times
+    idleWheel = std::make_unique<TimerWheel>(1000, 60, ServerLogs);
 }
 
 BankServer::~BankServer()
 {
+    stopAcceptors();
+    idleWheel.reset();
     ServerLogs->log("Destroying the BankServer object along with its resources");
     delete ServerLogs;
 }
 
-// Starts the server and begins listening on the specified port
-void BankServer::StartServer()
+// Asks for the port on the standard input, then starts the server on it
+bool BankServer::StartServer()
 {
     qout << "Enter port number to listen on: ";
     qout.flush();  // Ensures the prompt is immediately visible to the user
 
     // Read the port number from the standard input and convert it to an integer
-    port = qin.readLine().toInt();
+    quint16 listenPort = qin.readLine().toUShort();
 
-    // Start listening on the specified port, accepting connections from any IP address
-    this->listen(QHostAddress::Any, port);
+    // Accept connections from any IP address
+    return StartServer(QHostAddress::Any, listenPort);
+}
+
+// Starts the server and begins listening on the specified address and port
+bool BankServer::StartServer(const QHostAddress &address, quint16 listenPort)
+{
+    port = listenPort;
+
+    // Several acceptors share the port; without SO_REUSEPORT the main thread accepts alone
+    bool shared = false;
+    if ((acceptorCount > 1) && (port != 0))
+    {
+        shared = Acceptor::listenShared(this, address, port);
+        if (!shared)
+        {
+            ServerLogs->log("SO_REUSEPORT is not available; accepting connections on one thread", Logger::Warning);
+        }
+    }
+
+    // Start listening on the specified port
+    if (shared)
+    {
+        startAcceptors(address);
+    }
+    else
+    {
+        this->listen(address, port);
+    }
 
     // Check if the server successfully started listening
     if (this->isListening())
@@ -49,9 +90,11 @@ void BankServer::StartServer()
     }
     else
     {
-        ServerLogs->log("Server cannot listen on port " + QString::number(port));
+        ServerLogs->log("Server cannot listen on port " + QString::number(port), Logger::Error);
         qDebug() << "Server cannot listen on port " << port << Qt::endl;
     }
+
+    return this->isListening();
 }
 
 // Stops the server and closes the listening socket
@@ -59,18 +102,201 @@ void BankServer::QuitServer()
 {
     ServerLogs->log("Closing server...");
     qDebug() << "Closing server...";
+    stopAcceptors();
     this->close();  // Closes the server, stopping it from accepting new connections
 }
 
-// Handles incoming client connections
+// Streams the database changes to followers connecting on the given address and port
+void BankServer::StartReplication(const QHostAddress &address, quint16 replicationPort, const QByteArray &secret)
+{
+    leader = std::make_unique<ReplicationLeader>(secret);
+
+    if (leader->StartReplication(address, replicationPort))
+    {
+        ServerLogs->log("Replication leader is listening on " + address.toString() + ":" + QString::number(replicationPort));
+        qDebug() << "Replication leader is listening on " << address.toString() << ":" << replicationPort << Qt::endl;
+    }
+    else
+    {
+        ServerLogs->log("Replication cannot listen on port " + QString::number(replicationPort), Logger::Error);
+        qDebug() << "Replication cannot listen on port " << replicationPort << Qt::endl;
+    }
+}
+
+// Runs as a read-only follower that serves the read requests from a copy of the leader's database
+void BankServer::FollowLeader(const QString &host, quint16 replicationPort, const QByteArray &secret)
+{
+    ServerLogs->log("Following the leader at " + host + ":" + QString::number(replicationPort));
+    qDebug() << "Following the leader at " << host << ":" << replicationPort << Qt::endl;
+
+    follower = std::make_unique<ReplicationFollower>(host, replicationPort, secret);
+    follower->StartFollowing();
+}
+
+// Sets the number of threads accepting connections
+void BankServer::SetAcceptorCount(qint32 count)
+{
+    acceptorCount = qMax(count, 1);
+}
+
+// Starts acceptorCount - 1 acceptor threads next to the main thread, each with its own socket on the port
+void BankServer::startAcceptors(const QHostAddress &address)
+{
+    for (qint32 i = 1; i < acceptorCount; i++)
+    {
+        QThread *thread = new QThread();
+        Acceptor *acceptor = new Acceptor(ServerLogs);
+        acceptor->moveToThread(thread);
+
+        // Queued to this thread, which owns the client handlers, the idle wheel and the client list
+        connect(acceptor, &Acceptor::clientAccepted, this, &BankServer::startClient);
+        thread->start();
+
+        // The socket notifiers of the acceptor must be created on its own thread
+        bool listening = false;
+        quint16 listenPort = port;
+        QMetaObject::invokeMethod(acceptor, [acceptor, address, listenPort]() {
+            return Acceptor::listenShared(acceptor, address, listenPort);
+        }, Qt::BlockingQueuedConnection, &listening);
+
+        acceptors.append(acceptor);
+        acceptorThreads.append(thread);
+
+        if (!listening)
+        {
+            ServerLogs->log("Acceptor " + QString::number(i) + " cannot listen on port " + QString::number(port), Logger::Error);
+            break;
+        }
+    }
+
+    ServerLogs->log("Accepting connections on " + QString::number(acceptors.size() + 1) + " threads");
+}
+
+// Closes the sockets of the acceptor threads and ends the threads
+void BankServer::stopAcceptors()
+{
+    for (qsizetype i = 0; i < acceptors.size(); i++)
+    {
+        // The acceptor is deleted on its own thread, where its socket notifiers live
+        Acceptor *acceptor = acceptors[i];
+        QMetaObject::invokeMethod(acceptor, [acceptor]() {
+            acceptor->close();
+            delete acceptor;
+        }, Qt::BlockingQueuedConnection);
+
+        acceptorThreads[i]->quit();
+        acceptorThreads[i]->wait();
+        delete acceptorThreads[i];
+    }
+
+    acceptors.clear();
+    acceptorThreads.clear();
+}
+
+// Sets the idle time after which a client connection is closed
+void BankServer::SetIdleTimeout(qint32 seconds)
+{
+    idleWheel->setIdleTimeout(seconds * 1000);
+    ServerLogs->log("Idle connections are closed after " + QString::number(seconds) + " seconds");
+}
+
+// Installs the stop signal handlers and checks for a stop signal five times per second
+void BankServer::EnableGracefulShutdown(qint32 drainSeconds)
+{
+    drainTimeout = drainSeconds * 1000;
+
+    std::signal(SIGTERM, onStopSignal);
+    std::signal(SIGINT, onStopSignal);
+
+    connect(&signalPoll, &QTimer::timeout, this, [this]() {
+        if (stopRequested)
+        {
+            signalPoll.stop();
+            Drain();
+        }
+    });
+    signalPoll.start(200);
+}
+
+// Stops accepting clients, waits for the running requests, writes the database and leaves the event loop
+void BankServer::Drain()
+{
+    ServerLogs->log("Draining " + QString::number(clients.size()) + " clients");
+    qDebug() << "Draining " << clients.size() << " clients..." << Qt::endl;
+
+    // No new clients; the load balancer or the clients move on to another server
+    QuitServer();
+
+    // Each handler ends its event loop once the request it is running, if any, is answered
+    for (ClientHandler *client : std::as_const(clients))
+    {
+        client->quit();
+    }
+
+    QDeadlineTimer deadline(drainTimeout);
+    QList<ClientHandler*> stragglers;
+    for (ClientHandler *client : std::as_const(clients))
+    {
+        if (!client->wait(deadline))
+        {
+            stragglers.append(client);
+        }
+    }
+
+    // Force the stragglers off: each thread aborts its socket as soon as its request returns.
+    // They get a short grace period together; a handler still stuck after it is left behind,
+    // so the drain stays bounded.
+    for (ClientHandler *client : std::as_const(stragglers))
+    {
+        ServerLogs->log("Client " + QString::number(client->clientID()) + " did not finish before the drain deadline, aborting it", Logger::Warning);
+        client->abortConnection();
+    }
+    QDeadlineTimer abortDeadline(abortGrace);
+    for (ClientHandler *client : std::as_const(stragglers))
+    {
+        if (!client->wait(abortDeadline))
+        {
+            ServerLogs->log("Client " + QString::number(client->clientID()) + " is still running after it was aborted", Logger::Error);
+            client->setParent(nullptr); // Destroying a running thread with the server would crash the exit
+        }
+    }
+
+    // Stop streaming changes before the final checkpoint
+    leader.reset();
+    follower.reset();
+
+    // Persist everything and leave snapshots that make the next start fast
+    DataBaseHandler::getInstance()->prepareRestart();
+
+    ServerLogs->log("Drain complete, exiting");
+    QCoreApplication::quit();
+}
+
+// Handles the client connections accepted on the main thread
 void BankServer::incomingConnection(qintptr handle)
 {
-    ServerLogs->log("Client " + QString::number(handle) + " connecting....");
-    qDebug() << "Client " << handle << " connecting....";
+    if (Acceptor::admit(handle, ServerLogs))
+    {
+        startClient(handle);
+    }
+}
 
+// Starts the handler thread of a connection admitted on any acceptor
+void BankServer::startClient(qintptr handle)
+{
     // Create a unique_ptr for the ClientHandler to manage its lifecycle
     auto clientHandler = std::make_unique<ClientHandler>(handle, this);
 
+    // Watch the connection for idleness until its thread finishes.
+    // This connection is made first so the handler leaves the wheel before it is deleted.
+    ClientHandler *client = clientHandler.get();
+    idleWheel->add(client);
+    clients.insert(client);
+    connect(client, &QThread::finished, this, [this, client]() {
+        idleWheel->remove(client);
+        clients.remove(client);
+    });
+
     // Connect the finished signal from ClientHandler to its own deleteLater slot
     // This ensures the ClientHandler object is properly deleted when its work is done
     connect(clientHandler.get(), &QThread::finished, clientHandler.get(), &QThread::deleteLater);
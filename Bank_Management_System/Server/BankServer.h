@@ -3,9 +3,21 @@
 
 #include <QObject>      // Includes the base class for all Qt objects
 #include <QTcpServer>   // Includes the class for TCP server functionalities
+#include <QHostAddress> // Includes the QHostAddress class for the bind address
 #include <QTextStream>  // Includes the class for text stream handling
 #include <QDebug>       // Includes the class for debugging and logging
+#include <QTimer>       // Includes the QTimer class for checking the stop signals
+#include <QSet>         // Includes the QSet class for the list of client handlers
+#include <QDeadlineTimer> // Includes the QDeadlineTimer class for the drain deadline
+#include <QCoreApplication> // Includes the QCoreApplication class for leaving the event loop
+#include <QThread>      // Includes the QThread class for the acceptor threads
+#include <QList>        // Includes the QList class for the list of acceptors
+#include <memory>       // Includes smart pointers such as std::unique_ptr
 #include "Logger.h"
+#include "ReplicationLeader.h"
+#include "ReplicationFollower.h"
+#include "TimerWheel.h"
+#include "Acceptor.h"
 
 // The BankServer class is responsible for managing incoming client connections.
 // It inherits from QTcpServer to handle TCP connections and provide server functionality.
@@ -19,11 +31,35 @@ public:
     ~BankServer();
 
     // Method to start the server and begin listening for incoming connections.
-    void StartServer();
+    // Asks for the port on the standard input.
+    bool StartServer();
+
+    // Method to start the server on the given address and port without asking for anything.
+    bool StartServer(const QHostAddress &address, quint16 listenPort);
 
     // Method to stop the server and close the listening socket.
     void QuitServer();
 
+    // Method to stream the database changes to followers that connect on the given address and port
+    // and prove to know the shared secret.
+    void StartReplication(const QHostAddress &address, quint16 replicationPort, const QByteArray &secret);
+
+    // Method to run as a read-only follower of the leader at the given address, authenticating with the shared secret.
+    void FollowLeader(const QString &host, quint16 replicationPort, const QByteArray &secret);
+
+    // Method to set the number of threads accepting connections; must be called before StartServer().
+    // With more than one, every acceptor listens on the port with SO_REUSEPORT.
+    void SetAcceptorCount(qint32 count);
+
+    // Method to set the idle time in seconds after which a client connection is closed; 0 disables it.
+    void SetIdleTimeout(qint32 seconds);
+
+    // Method to drain the server on SIGTERM or SIGINT, waiting at most drainSeconds for the clients.
+    void EnableGracefulShutdown(qint32 drainSeconds);
+
+    // Method to stop accepting clients, let the running requests finish, persist the database and exit.
+    void Drain();
+
 signals:
          // Define signals here if needed for communication with other objects.
          // Signals are emitted to indicate events or data changes.
@@ -33,11 +69,29 @@ protected:
     // This method is called when a new client connects to the server.
     void incomingConnection(qintptr handle) override;
 
+private slots:
+    // Slot to start the handler thread of an admitted connection.
+    void startClient(qintptr handle);
+
 private:
+    // Methods to start the extra acceptor threads and to stop them again.
+    void startAcceptors(const QHostAddress &address);
+    void stopAcceptors();
+
     QTextStream qin; // QTextStream for reading input from the standard input (stdin)
     QTextStream qout; // QTextStream for writing output to the standard output (stdout)
     qint32 port; // Port number on which the server listens for incoming connections
     Logger *ServerLogs;
+    std::unique_ptr<ReplicationLeader> leader; // Streams changes to followers when this server is a leader
+    std::unique_ptr<ReplicationFollower> follower; // Applies the leader's changes when this server is a follower
+    std::unique_ptr<TimerWheel> idleWheel; // Closes the client connections that stay idle for too long
+    QSet<ClientHandler*> clients; // Client handlers whose thread is still running
+    QTimer signalPoll; // Timer checking if a stop signal arrived
+    qint32 drainTimeout; // Time in milliseconds the drain waits for the clients
+    static constexpr qint32 abortGrace = 1000; // Time in milliseconds the drain waits for the clients it aborted
+    qint32 acceptorCount; // Number of threads accepting connections, the main thread included
+    QList<Acceptor*> acceptors; // Acceptors running on their own threads
+    QList<QThread*> acceptorThreads; // Threads of the acceptors
 };
 
 
@@ -0,0 +1,69 @@
+#include "ChangeLog.h"
+
+// Constructor: Version 0 stands for the store as loaded, before any change
+ChangeLog::ChangeLog(qint32 capacity)
+    : current{0}, capacity{qMax(capacity, 1)}, epochID{QUuid::createUuid().toString(QUuid::WithoutBraces)}
+{
+}
+
+// Records a change and drops the oldest entry once the log is full
+quint64 ChangeLog::record(const QString &userName)
+{
+    QMutexLocker locker(&mutex);
+    entries.emplace_back(++current, userName);
+    while (entries.size() > static_cast<size_t>(capacity))
+    {
+        entries.pop_front();
+    }
+    return current;
+}
+
+// Returns the version of the latest change
+quint64 ChangeLog::version()
+{
+    QMutexLocker locker(&mutex);
+    return current;
+}
+
+// Returns the identifier of this run of the server
+QString ChangeLog::epoch() const
+{
+    return epochID;
+}
+
+// Collects the usernames changed after a version
+bool ChangeLog::changesSince(quint64 since, QSet<QString> &userNames, quint64 &latest)
+{
+    QMutexLocker locker(&mutex);
+    latest = current;
+    if (since > current)
+    {
+        return false; // Not a version of this epoch
+    }
+
+    // The change right after since must still be in the log
+    if ((since < current) && (entries.empty() || (entries.front().first > since + 1)))
+    {
+        return false;
+    }
+
+    // Versions ascend, so the first newer change is found with a binary search
+    auto it = std::upper_bound(entries.begin(), entries.end(), since,
+                               [](quint64 version, const std::pair<quint64, QString> &entry) { return version < entry.first; });
+    for (; it != entries.end(); ++it)
+    {
+        userNames.insert(it->second);
+    }
+    return true;
+}
+
+// Sets the number of changes remembered; a smaller log forgets its oldest changes right away
+void ChangeLog::setCapacity(qint32 count)
+{
+    QMutexLocker locker(&mutex);
+    capacity = qMax(count, 1);
+    while (entries.size() > static_cast<size_t>(capacity))
+    {
+        entries.pop_front();
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef CHANGELOG_H
+#define CHANGELOG_H
+
+#include <QString>     // Includes the QString class for the usernames
+#include <QSet>        // Includes the QSet class for the usernames changed since a version
+#include <QMutex>      // Includes the QMutex class for protecting the log
+#include <QUuid>       // Includes the QUuid class for the epoch of the versions
+#include <deque>       // Includes std::deque for the log entries
+#include <utility>     // Includes std::pair for the log entries
+#include <algorithm>   // Includes std::upper_bound for finding a version in the log
+
+// The ChangeLog class numbers the changes of the account store and remembers the latest ones.
+// Every stored or erased account gets the next version; a client that presents the version of its
+// copy gets the usernames changed since then, as long as the log still reaches back that far.
+// Versions restart with the server, so they come with an epoch that changes on every start.
+class ChangeLog
+{
+public:
+    // Constructor to create an empty log remembering at most capacity changes.
+    explicit ChangeLog(qint32 capacity = 10000);
+
+    // Delete the copy constructor and the assignment operator to prevent copying.
+    ChangeLog(const ChangeLog&) = delete;
+    ChangeLog& operator=(const ChangeLog&) = delete;
+
+    // Method to record a change of the account stored under userName and return its version.
+    quint64 record(const QString &userName);
+
+    // Method to get the version of the latest change.
+    quint64 version();
+
+    // Method to get the identifier of this run of the server, which the versions belong to.
+    QString epoch() const;
+
+    // Method to get the usernames changed after version since, and the version they bring the copy to.
+    // Returns false if the log no longer holds all of these changes, or since is not a version of
+    // this epoch; the client then needs a full copy.
+    bool changesSince(quint64 since, QSet<QString> &userNames, quint64 &latest);
+
+    // Method to set the number of changes remembered.
+    void setCapacity(qint32 count);
+
+private:
+    std::deque<std::pair<quint64, QString>> entries; // Latest changes as (version, username), oldest first.
+    quint64 current; // Version of the latest change.
+    qint32 capacity; // Maximum number of entries.
+    const QString epochID; // Identifier of this run of the server.
+    QMutex mutex; // Mutex protecting the log, which all shards write to.
+};
+
+#endif // CHANGELOG_H
@@ -0,0 +1,74 @@
+#include "Checkpointer.h"
+#include "DataBaseShard.h"
+
+// Constructor for Checkpointer
+Checkpointer::Checkpointer(DataBaseShard *db, QObject *parent)
+    : QThread{parent}, db{db}, interval{5000}, maxPending{100}, requested{false}, stopping{false}
+{
+    // Checkpoints run every 5 seconds, or earlier once 100 changes are pending.
+}
+
+Checkpointer::~Checkpointer()
+{
+    stop();
+}
+
+// Sets the checkpoint interval and the change count that triggers an early checkpoint
+void Checkpointer::configure(qint32 intervalMs, qint32 maxPendingChanges)
+{
+    interval = qMax(intervalMs, 1);
+    maxPending = qMax(maxPendingChanges, 1);
+
+    // Wake the thread so the new interval applies immediately
+    QMutexLocker locker(&mutex);
+    wakeUp.wakeOne();
+}
+
+// Returns the change count that triggers an early checkpoint
+qint32 Checkpointer::maxPendingChanges() const
+{
+    return maxPending;
+}
+
+// Wakes the thread to run a checkpoint without waiting for the interval
+void Checkpointer::requestCheckpoint()
+{
+    QMutexLocker locker(&mutex);
+    requested = true;
+    wakeUp.wakeOne();
+}
+
+// Stops the checkpoint loop and waits for the thread to finish
+void Checkpointer::stop()
+{
+    {
+        QMutexLocker locker(&mutex);
+        stopping = true;
+        wakeUp.wakeOne();
+    }
+    wait();
+}
+
+// Thread execution function
+void Checkpointer::run()
+{
+    while (true)
+    {
+        {
+            QMutexLocker locker(&mutex);
+
+            // Sleep until the interval elapses or a checkpoint is requested
+            if (!requested && !stopping)
+            {
+                wakeUp.wait(&mutex, static_cast<unsigned long>(interval.load()));
+            }
+            if (stopping)
+            {
+                return; // The owner writes the final checkpoint itself
+            }
+            requested = false;
+        }
+
+        db->checkpoint();
+    }
+}
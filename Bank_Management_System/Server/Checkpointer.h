@@ -0,0 +1,49 @@
+#ifndef CHECKPOINTER_H
+#define CHECKPOINTER_H
+
+#include <QThread>        // Includes the QThread class for running the checkpoints in a separate thread
+#include <QMutex>         // Includes the QMutex class for thread synchronization
+#include <QWaitCondition> // Includes the QWaitCondition class for sleeping until the next checkpoint
+#include <atomic>         // Includes std::atomic for settings shared with the request threads
+
+class DataBaseShard;
+
+// The Checkpointer class writes the in-memory account table of a shard to disk in a background thread.
+// A checkpoint runs every interval, or earlier when enough changes are pending,
+// so the database file is never written inside a client request.
+class Checkpointer : public QThread
+{
+    Q_OBJECT // Macro to enable the Qt meta-object system for signals and slots
+
+public:
+    // Constructor to initialize the Checkpointer with the shard it persists.
+    explicit Checkpointer(DataBaseShard *db, QObject *parent = nullptr);
+    ~Checkpointer();
+
+    // Method to set the checkpoint interval in milliseconds and the change count that triggers an early checkpoint.
+    void configure(qint32 intervalMs, qint32 maxPendingChanges);
+
+    // Method to get the change count that triggers an early checkpoint.
+    qint32 maxPendingChanges() const;
+
+    // Method to wake the thread and run a checkpoint now.
+    void requestCheckpoint();
+
+    // Method to stop the thread and wait for it to finish.
+    void stop();
+
+protected:
+    // Overrides the QThread::run() method with the checkpoint loop.
+    void run() override;
+
+private:
+    DataBaseShard *db; // Shard whose account table is written by the checkpoints.
+    std::atomic<qint32> interval; // Time between two checkpoints in milliseconds.
+    std::atomic<qint32> maxPending; // Number of pending changes that triggers an early checkpoint.
+    bool requested; // Set when a checkpoint was requested before the interval elapsed.
+    bool stopping; // Set when the thread has to leave its loop.
+    QMutex mutex; // Mutex protecting requested and stopping.
+    QWaitCondition wakeUp; // Wait condition used to sleep between checkpoints.
+};
+
+#endif // CHECKPOINTER_H
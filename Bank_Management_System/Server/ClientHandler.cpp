@@ -1,8 +1,13 @@
 #include "ClientHandler.h"
 
+// Connections are numbered from 1; 0 stands for no connection
+std::atomic<quint64> ClientHandler::lastConnectionID{0};
+
 // Constructor for ClientHandler
 ClientHandler::ClientHandler(qint32 cp_id, QObject *parent)
-    : QThread{parent}, id{cp_id}, socket(nullptr), req_handler(nullptr)
+    : QThread{parent}, id{cp_id}, connectionID{++lastConnectionID}, socket(nullptr), req_handler(nullptr),
+      rateLimit(AdmissionControl::getInstance()->limits().connectionRate, AdmissionControl::getInstance()->limits().connectionBurst),
+      lastActivity{QDateTime::currentMSecsSinceEpoch()}, aborting{false}
 {
     // Initializes the QThread base class with the given parent.
     // Sets the client socket descriptor (id) to the provided client ID.
@@ -21,30 +26,148 @@ ClientHandler::~ClientHandler()
 void ClientHandler::SendResponse(const QByteArray &response)
 {
     // Checks if the socket is valid and open before attempting to send data
-    if (socket && socket->isOpen())
+    if (socket && socket->isOpen() && !aborting)
     {
         socket->write(response); // Write the response data to the socket
-        socket->waitForBytesWritten(); // Wait until the response is fully written to ensure it is sent
+
+        // Wait until the response is fully written, in short steps so an aborted connection
+        // stops waiting for a client that does not read
+        QDeadlineTimer deadline(30000);
+        while (!aborting && (socket->bytesToWrite() > 0) && !deadline.hasExpired())
+        {
+            if (!socket->waitForBytesWritten(100) && (socket->state() != QAbstractSocket::ConnectedState))
+            {
+                break;
+            }
+        }
     }
 }
 
+// Returns the time of the last request from the client
+qint64 ClientHandler::lastActivityMs() const
+{
+    return lastActivity;
+}
+
+// Returns the client socket descriptor
+qint32 ClientHandler::clientID() const
+{
+    return id;
+}
+
+// Forces the connection closed; the socket itself is aborted on the handler's thread
+void ClientHandler::abortConnection()
+{
+    aborting = true;
+    quit();
+}
+
 // Handles incoming data from the client
 void ClientHandler::onReadyRead()
 {
     // Ensures that the socket is valid before attempting to read data
     if (socket)
     {
-        QByteArray request = socket->readAll(); // Read all available data from the socket
+        pending.append(socket->readAll()); // Read all available data from the socket
+        lastActivity = QDateTime::currentMSecsSinceEpoch(); // Any request, including a ping, keeps the connection alive
+
+        // Data that does not start a JSON object is handled as one request, which the request handler rejects
+        qsizetype start = 0;
+        while ((start < pending.size()) && QChar::isSpace(static_cast<uchar>(pending.at(start))))
+        {
+            start++;
+        }
+        if ((start < pending.size()) && (pending.at(start) != '{'))
+        {
+            QByteArray request = pending;
+            pending.clear();
+            scan = ScanState();
+            handleRequest(request);
+            return;
+        }
+
+        // Handle every whole request in the order it was sent; the rest waits for more data
+        qint32 consumed = 0;
+        qint32 length;
+        while (socket && !aborting && ((length = messageLength(pending, consumed, scan)) > 0))
+        {
+            QByteArray request = pending.mid(consumed, length);
+            consumed += length;
+            handleRequest(request);
+        }
+
+        // Drop the handled requests at once instead of moving the rest after each of them
+        pending.remove(0, consumed);
+        scan.offset -= consumed;
+
+        // A client that never completes its request must not grow the buffer without bound
+        if (pending.size() > maxPendingBytes)
+        {
+            ClientLogs->log("Client " + QString::number(id) + " sent an oversized request", Logger::Warning);
+            pending.clear();
+            scan = ScanState();
+            socket->disconnectFromHost();
+        }
+    }
+}
+
+// Handles one whole request from the client
+void ClientHandler::handleRequest(const QByteArray &request)
+{
+    // Refuse requests beyond the rate of this connection without processing them
+    if (!rateLimit.tryTake())
+    {
+        ClientLogs->log("Client " + QString::number(id) + " exceeded its request rate");
+        SendResponse(req_handler->rejectRequest(request, -16));
+        return;
+    }
 
-        // Create a RequestHandler using a unique pointer for automatic memory management
-        // Using std::make_unique ensures that the RequestHandler will be automatically cleaned up
-        req_handler = std::make_unique<RequestHandler>();
-        QByteArray response = req_handler->handleReaquest(request); // Process the request and generate a response
+    QByteArray response = req_handler->handleReaquest(request); // Process the request and generate a response
 
-        SendResponse(response); // Send the generated response back to the client
+    SendResponse(response); // Send the generated response back to the client
+}
 
-        // No need to manually delete req_handler; it will be automatically cleaned up
+// Returns the length of the whole JSON object starting at start, counting the braces outside of strings
+// from the first byte not looked at yet
+qint32 ClientHandler::messageLength(const QByteArray &buffer, qint32 start, ScanState &scan)
+{
+    for (qint32 i = qMax(scan.offset, start); i < buffer.size(); i++)
+    {
+        char c = buffer.at(i);
+        if (scan.inString)
+        {
+            if (scan.escaped)
+            {
+                scan.escaped = false;
+            }
+            else if (c == '\\')
+            {
+                scan.escaped = true;
+            }
+            else if (c == '"')
+            {
+                scan.inString = false;
+            }
+        }
+        else if (c == '"')
+        {
+            scan.inString = true;
+        }
+        else if (c == '{')
+        {
+            scan.depth++;
+        }
+        else if ((c == '}') && (scan.depth > 0) && (--scan.depth == 0))
+        {
+            // The next request starts right after this one
+            scan = ScanState();
+            scan.offset = i + 1;
+            return i + 1 - start;
+        }
     }
+
+    scan.offset = static_cast<qint32>(buffer.size());
+    return 0;
 }
 
 // Handles client disconnection
@@ -57,6 +180,8 @@ void ClientHandler::onDisconnect()
         qDebug() << "Client " << id << " has disconnected..." << Qt::endl; // Log client disconnection
         ClientLogs->log("Client " + QString::number(id) + " has disconnected...");
     }
+
+    quit(); // End the event loop so the thread finishes and frees its connection slot
 }
 
 // Thread execution function
@@ -65,15 +190,53 @@ void ClientHandler::run()
     qDebug() << "Client " << id << " is running on thread => " << QThread::currentThreadId() << Qt::endl;
     ClientLogs->log("Client " + QString::number(id) + " is running");
 
-    // Create a QTcpSocket instance using a unique pointer
-    // Using std::make_unique ensures that the QTcpSocket will be automatically cleaned up
-    socket = std::make_unique<QTcpSocket>();
-    socket->setSocketDescriptor(id); // Set the socket descriptor for the client connection
+    // Create the socket using a unique pointer so it will be automatically cleaned up
+    bool tls = TlsConfig::isEnabled();
+    if (tls)
+    {
+        // The handshake runs in this thread's event loop; requests are read once it completes
+        auto sslSocket = std::make_unique<QSslSocket>();
+        sslSocket->setSslConfiguration(TlsConfig::configuration());
+        connect(sslSocket.get(), &QSslSocket::sslErrors, this, [this](const QList<QSslError> &errors) {
+            ClientLogs->log("Client " + QString::number(id) + " TLS error: " + errors.value(0).errorString(), Logger::Warning);
+        }, Qt::DirectConnection);
+        sslSocket->setSocketDescriptor(id);
+        sslSocket->startServerEncryption();
+        TlsConfig::shareSessionTickets(sslSocket.get()); // Tickets of any connection resume on this one
+        socket = std::move(sslSocket);
+    }
+    else
+    {
+        socket = std::make_unique<QTcpSocket>();
+        socket->setSocketDescriptor(id); // Set the socket descriptor for the client connection
+    }
+    socket->setSocketOption(QAbstractSocket::KeepAliveOption, 1); // Let the OS detect peers that vanished
 
     // Connect signals from QTcpSocket to the appropriate slots in this ClientHandler
     // Signals and slots are connected with Qt::DirectConnection to ensure immediate execution
     connect(socket.get(), &QTcpSocket::readyRead, this, &ClientHandler::onReadyRead, Qt::DirectConnection);
     connect(socket.get(), &QTcpSocket::disconnected, this, &ClientHandler::onDisconnect, Qt::DirectConnection);
 
+    // The same RequestHandler serves every request of this connection
+    req_handler = std::make_unique<RequestHandler>(tls, connectionID);
+
+    // Account change events are queued to the socket, which lives on this thread, and written between responses
+    SubscriptionManager::getInstance()->addConnection(connectionID, socket.get(), [this](const QJsonObject &event) {
+        SendResponse(req_handler->eventMessage(event));
+    });
+
     exec(); // Start the event loop for this thread, allowing it to process events
+
+    // Stop the events before the socket they are queued to goes away
+    SubscriptionManager::getInstance()->removeConnection(connectionID);
+
+    // An aborted connection drops its unsent data instead of waiting for the client
+    if (aborting)
+    {
+        socket->abort();
+    }
+
+    // Delete the socket on the thread that created it and let another client connect
+    socket.reset();
+    AdmissionControl::getInstance()->releaseConnection();
 }
@@ -4,13 +4,23 @@
 #include <QObject>    // Includes the base class for all Qt objects, providing essential features such as signals and slots
 #include <QThread>    // Includes the QThread class, which enables multi-threading capabilities by allowing execution of code in separate threads
 #include <QTcpSocket> // Includes the QTcpSocket class, which provides a TCP socket for network communication
+#include <QSslSocket> // Includes the QSslSocket class for TLS connections
 #include <QDebug>     // Includes the QDebug class, used for outputting debug information and logging
 #include <memory>     // Includes smart pointers such as std::unique_ptr
+#include <atomic>     // Includes std::atomic for the time of the last request
+#include <QDateTime>  // Includes the QDateTime class for the time of the last request
+#include <QDeadlineTimer> // Includes the QDeadlineTimer class for the time a response may take to send
 #include "RequestHandler.h" // Includes the header file for handling client requests
+#include "AdmissionControl.h" // Includes the header file for the connection limits
+#include "TokenBucket.h" // Includes the header file for the request rate limit of the connection
+#include "TlsConfig.h" // Includes the header file for the TLS settings
+#include "SubscriptionManager.h" // Includes the header file for the account change events
 #include "Logger.h"
 
 // The ClientHandler class is designed to manage communication with a single client in a separate thread.
 // It inherits from QThread to enable concurrent processing.
+// The received bytes are split into whole JSON requests, so a client may pipeline several requests
+// without waiting for their responses; they are answered in the order they were sent.
 class ClientHandler : public QThread
 {
     Q_OBJECT // Macro to enable the Qt meta-object system for signals and slots
@@ -25,6 +35,17 @@ public:
     // The response is provided as a QByteArray.
     void SendResponse(const QByteArray &response);
 
+    // Method to get the time of the last request from the client, in milliseconds since the epoch.
+    qint64 lastActivityMs() const;
+
+    // Method to get the client socket descriptor identifying the connection.
+    qint32 clientID() const;
+
+    // Method to force the connection closed; safe to call from any thread.
+    // The handler stops sending and handling requests, and its thread aborts the socket once the
+    // request it is running returns.
+    void abortConnection();
+
 signals:
          // Define signals here if needed for communication with other objects.
          // Signals are emitted to indicate events or data changes.
@@ -44,9 +65,34 @@ protected:
     void run() override;
 
 private:
+    // Method to handle one whole request received from the client.
+    void handleRequest(const QByteArray &request);
+
+    // Progress of the search for the end of the next request in the pending bytes, kept between reads
+    // so every received byte is looked at once, however many pieces a large request arrives in.
+    struct ScanState
+    {
+        qint32 offset = 0;     // Bytes of the buffer already looked at.
+        qint32 depth = 0;      // Braces opened and not closed yet.
+        bool inString = false; // Whether the offset is inside a string.
+        bool escaped = false;  // Whether the last character looked at escapes the next one.
+    };
+
+    // Method to get the length of the whole JSON object starting at start in the buffer, or 0 if it is incomplete.
+    // The scan continues where the last call stopped and is reset for the next object.
+    static qint32 messageLength(const QByteArray &buffer, qint32 start, ScanState &scan);
+
     qint32 id; // Client socket descriptor to identify the client's connection.
-    std::unique_ptr<QTcpSocket> socket; // Unique pointer to the QTcpSocket used to communicate with the client.
+    quint64 connectionID; // Unique number of the connection; the descriptor is reused once the socket is closed.
+    static std::atomic<quint64> lastConnectionID; // Number of the last connection created.
+    std::unique_ptr<QTcpSocket> socket; // Unique pointer to the QTcpSocket used to communicate with the client; a QSslSocket when TLS is enabled.
     std::unique_ptr<RequestHandler> req_handler; // Unique pointer to the RequestHandler that processes client requests.
+    TokenBucket rateLimit; // Request rate limit of this connection.
+    std::atomic<qint64> lastActivity; // Time of the last request, read by the server's timer wheel.
+    std::atomic<bool> aborting; // Set when the connection is forced closed.
+    QByteArray pending; // Received bytes not forming a whole request yet.
+    ScanState scan; // Progress of the search for the end of the next request in pending.
+    static constexpr qint32 maxPendingBytes = 16 * 1024 * 1024; // Largest incomplete request kept before the connection is closed.
     Logger *ClientLogs;
 };
 
@@ -1,61 +1,111 @@
 #include "DataBaseHandler.h"
 
-// Constructor: Initializes the database file and populates it if it doesn't exist
+// Number of shards used when setShardCount() is not called
+qint32 DataBaseHandler::shardCount = 4;
+
+// Directory of the shard files when setDataDirectory() is not called
+QString DataBaseHandler::dataDirectory = ".";
+
+// Storage engine when setStorageEngine() is not called
+DataBaseHandler::StorageKind DataBaseHandler::storageKind = DataBaseHandler::JsonStorage;
+
+// Constructor: Opens the shards and moves existing accounts into them
 DataBaseHandler::DataBaseHandler()
+    : nextTransferID{1}, readOnly{false}
 {
-    DataBaseFile = std::make_unique<QFile>("BankDataBase.json");
     DBLogs = new Logger("Logs/DBLogs.txt");
-    initilaize(); // Set up the initial database state if the file does not exist
+
+    // Each shard loads its own storage and starts its executor and checkpoint threads
+    for (qint32 i = 0; i < shardCount; i++)
+    {
+        shards.push_back(std::make_unique<DataBaseShard>(i, createEngine(i), &changeLog, DBLogs));
+    }
+
+    initilaize(); // Migrate older files or set up the initial database state
+    buildDirectory();
 }
 
-// Destructor: Default destructor
+// Destructor: Stops the shards, which write their pending changes
 DataBaseHandler::~DataBaseHandler()
 {
+    shards.clear();
     DBLogs->log("Destroying the DataBaseHandler object along with its resources");
     delete DBLogs;
 }
 
-// Initializes the database file with default values if it does not already exist
+// Moves accounts from the single-file database or from shards beyond the current shard count
+// into their shards, and creates the default users if no database exists at all
 void DataBaseHandler::initilaize()
 {
-    // Check if the database file exists
-    if (!DataBaseFile->exists())
+    QDir dataDir(dataDirectory);
+    const QString legacyFile = dataDir.filePath("BankDataBase.json");
+    bool databaseExists = false;
+
+    for (const auto &shard : shards)
+    {
+        databaseExists = databaseExists || shard->hasStoredData();
+    }
+
+    // An in-memory database never takes over the files, which would be lost on exit
+    if (storageKind != MemoryStorage)
     {
-        // Open the database file for writing
-        DataBaseFile->open(QIODevice::WriteOnly | QIODevice::Text);
-        QTextStream stream(DataBaseFile.get());
+        // Accounts of the single-file database are split over the shards
+        if (QFile::exists(legacyFile))
+        {
+            databaseExists = true;
+            migrateFile(legacyFile);
+        }
+
+        // Files of shards that no longer exist after lowering the shard count,
+        // and shards stored by another engine before switching engines
+        const QString currentSuffix = (storageKind == SqliteStorage) ? "sqlite" : "json";
+        for (const QString &suffix : {QString("json"), QString("sqlite")})
+        {
+            QStringList shardFiles = dataDir.entryList(QStringList() << "BankDataBase_*." + suffix, QDir::Files);
+            for (const QString &fileName : shardFiles)
+            {
+                bool ok;
+                qint32 shardID = fileName.mid(13, fileName.size() - 14 - suffix.size()).toInt(&ok);
+                if (ok && ((shardID >= shardCount) || (suffix != currentSuffix)))
+                {
+                    databaseExists = true;
+                    migrateFile(dataDir.filePath(fileName));
+                }
+            }
+        }
+    }
+
+    // Accounts hashed to another shard after changing the shard count
+    rebalanceShards();
 
+    if (!databaseExists)
+    {
         // Prepare default user data
         QJsonObject admin1, user1;
         QJsonArray history; // Transaction history is initialized as an empty array
-        QJsonObject container;
-        QJsonDocument doc;
 
         // Admin user data
         admin1["FullName"] = "Ahmed Aseel";
         admin1["AccountNumber"] = "100";
         admin1["Age"] = "24";
-        admin1["Password"] = "252000";
+        admin1["Password"] = PasswordHasher::hash("252000");
         admin1["IsAdmin"] = true;
         admin1["AccountBalance"] = "0";
         admin1["TransactionHistory"] = history;
-        container["Ahmed25"] = admin1;
+        shardFor("100")->insertAccount("Ahmed25", admin1);
 
         // Regular user data
         user1["FullName"] = "Shimaa Aseel";
         user1["AccountNumber"] = "200";
         user1["Age"] = "26";
-        user1["Password"] = "891998";
+        user1["Password"] = PasswordHasher::hash("891998");
         user1["IsAdmin"] = false;
         user1["AccountBalance"] = "0";
         user1["TransactionHistory"] = history;
-        container["Shimaa98"] = user1;
+        shardFor("200")->insertAccount("Shimaa98", user1);
 
-        // Set the container as the document's root object
-        doc.setObject(container);
-        stream << QString::fromUtf8(doc.toJson(QJsonDocument::Indented));
-        stream.flush(); // Ensure all data is written to the file
-        DataBaseFile->close(); // Close the file after writing
+        // Write the default users to the shard files
+        checkpoint();
     }
 }
 
@@ -66,72 +116,160 @@ std::shared_ptr<DataBaseHandler> DataBaseHandler::getInstance()
     return instance;
 }
 
-// Checks if the database file exists and is readable, and parses it into a QJsonDocument
-bool DataBaseHandler::CheckDataBase(QJsonObject &jResponse, QJsonParseError &jError, QJsonDocument &doc)
+// Sets the number of shards used by the singleton instance
+void DataBaseHandler::setShardCount(qint32 count)
+{
+    shardCount = qMax(count, 1);
+}
+
+// Sets the directory the shard files are read from and written to
+void DataBaseHandler::setDataDirectory(const QString &directory)
 {
-    // Check if the database file exists
-    if (!DataBaseFile->exists())
+    dataDirectory = directory;
+}
+
+// Sets the storage engine of the shards
+void DataBaseHandler::setStorageEngine(StorageKind kind)
+{
+    storageKind = kind;
+}
+
+// Creates the storage engine of a shard in the data directory
+std::unique_ptr<StorageEngine> DataBaseHandler::createEngine(qint32 shardID) const
+{
+    QDir dataDir(dataDirectory);
+
+    switch (storageKind)
     {
-        DBLogs->log("Database file doesn't exist.");
-        jResponse["State"] = false;
-        jResponse["Reason"] = -5; // File does not exist
-        return false;
+    case MemoryStorage:
+        return std::make_unique<MemoryEngine>();
+    case SqliteStorage:
+        return std::make_unique<SqliteEngine>(dataDir.filePath(DataBaseShard::shardFileName(shardID, "sqlite")), shardID, DBLogs);
+    default:
+        return std::make_unique<JsonFileEngine>(dataDir.filePath(DataBaseShard::shardFileName(shardID)), shardID, DBLogs);
     }
+}
 
-    // Open the database file for reading
-    if (!DataBaseFile->open(QIODevice::ReadOnly))
+// Returns the shard owning an account number
+DataBaseShard *DataBaseHandler::shardFor(const QString &accountNumber) const
+{
+    return shards[DataBaseShard::shardOf(accountNumber, static_cast<qint32>(shards.size()))].get();
+}
+
+// Moves every account of a database file into its shard, then renames the file out of the way
+bool DataBaseHandler::migrateFile(const QString &fileName)
+{
+    // SQLite files are read through their engine, all others are JSON files
+    QJsonObject database;
+    qint32 reason = fileName.endsWith(".sqlite") ? SqliteEngine(fileName, -1, DBLogs).load(database)
+                                                 : JsonFileEngine::readDataBase(fileName, database, DBLogs, fileName.endsWith("BankDataBase.json"));
+    if (reason != 0)
     {
-        DBLogs->log("Failed to open database file for reading.");
-        DataBaseFile->close(); // Close the file if opening fails
-        jResponse["State"] = false;
-        jResponse["Reason"] = -4; // Failed to open file for reading
+        DBLogs->log("Cannot migrate " + fileName + "; the file is kept as it is.", Logger::Error);
         return false;
     }
 
-    // Read and parse the JSON data from the file
-    doc = QJsonDocument::fromJson(DataBaseFile->readAll(), &jError);
-    DataBaseFile->close(); // Close the file after reading
+    for (auto it = database.constBegin(); it != database.constEnd(); ++it)
+    {
+        QJsonObject account = it.value().toObject();
+        QJsonObject jResponse = shardFor(account.value("AccountNumber").toString())->insertAccount(it.key(), account);
+        if (!jResponse.value("State").toBool())
+        {
+            DBLogs->log("Cannot migrate " + fileName + "; the file is kept as it is.", Logger::Error);
+            return false;
+        }
+    }
 
-    // Check for parsing errors
-    if (jError.error != QJsonParseError::NoError)
+    // Only move the old file away once its accounts are safely stored in the shard files
+    if (!checkpoint())
     {
-        DBLogs->log("Failed to parse JSON.");
-        jResponse["State"] = false;
-        jResponse["Reason"] = -3; // Failed to parse JSON
+        DBLogs->log("Cannot write the shards while migrating " + fileName + "; the file is kept as it is.", Logger::Error);
         return false;
     }
 
-    return true; // Successfully checked and parsed the database
+    QFile::remove(fileName + ".migrated");
+    QFile::rename(fileName, fileName + ".migrated");
+    DBLogs->log("Migrated " + QString::number(database.size()) + " accounts from " + fileName + ".");
+    return true;
 }
 
-// Handles user login by checking credentials against the database
+// Moves accounts that hash to another shard than the one whose file they were loaded from
+void DataBaseHandler::rebalanceShards()
+{
+    qint32 moved = 0;
+
+    for (const auto &shard : shards)
+    {
+        QJsonObject table = shard->snapshot();
+        for (auto it = table.constBegin(); it != table.constEnd(); ++it)
+        {
+            DataBaseShard *target = shardFor(it.value().toObject().value("AccountNumber").toString());
+            if (target != shard.get())
+            {
+                QJsonObject jResponse = shard->removeAccount(it.key());
+                target->insertAccount(it.key(), jResponse.value("Account").toObject());
+                moved++;
+            }
+        }
+    }
+
+    if (moved > 0)
+    {
+        checkpoint();
+        DBLogs->log("Moved " + QString::number(moved) + " accounts to their shards.");
+    }
+}
+
+// Fills the username directory and the set of used account numbers from all shards
+void DataBaseHandler::buildDirectory()
+{
+    QWriteLocker locker(&directoryLock);
+
+    for (const auto &shard : shards)
+    {
+        QJsonObject table = shard->snapshot();
+        for (auto it = table.constBegin(); it != table.constEnd(); ++it)
+        {
+            QString accountNumber = it.value().toObject().value("AccountNumber").toString();
+            userDirectory.insert(it.key(), accountNumber);
+            usedAccountNumbers.insert(accountNumber);
+        }
+    }
+}
+
+// Handles user login by checking credentials against the database and opening a session
 QJsonObject DataBaseHandler::logIn(const QJsonObject &data)
 {
     QJsonObject jResponse;
-    QJsonParseError jError;
-    QJsonDocument doc;
-    QJsonObject obj;
+    QString userName = data.value("UserName").toString();
+    QString password = data.value("Password").toString();
+    QString accountNumber;
 
-    // Verify the database file and parse it
-    if (!CheckDataBase(jResponse, jError, doc))
+    // Find the account of the user in the directory
     {
-        return jResponse; // Return response indicating failure
+        QReadLocker locker(&directoryLock);
+        if (!userDirectory.contains(userName))
+        {
+            DBLogs->log("Incorrect Username.");
+            jResponse["State"] = false;
+            jResponse["Reason"] = -1; // User not found
+            return jResponse;
+        }
+        accountNumber = userDirectory.value(userName);
     }
 
-    obj = doc.object(); // Convert QJsonDocument to QJsonObject
-
-    // Check if the user exists in the database
-    if (!obj.contains(data.value("UserName").toString()))
+    // Read the stored password from the shard holding the account
+    DataBaseShard *shard = shardFor(accountNumber);
+    QJsonObject found = shard->findUser(userName);
+    if (!found.value("State").toBool())
     {
-        DBLogs->log("Incorrect Username.");
-        jResponse["State"] = false;
-        jResponse["Reason"] = -1; // User not found
-        return jResponse;
+        return found; // Return response indicating failure
     }
 
-    // Validate the provided password
-    QString userPass = obj.value(data.value("UserName").toString()).toObject().value("Password").toString();
-    if (data.value("Password").toString() != userPass)
+    // The hash is checked on the client's thread so a slow derivation does not hold up the shard
+    QJsonObject userObj = found.value("Account").toObject();
+    QString stored = userObj.value("Password").toString();
+    if (!PasswordHasher::verify(password, stored))
     {
         DBLogs->log("Incorrect Password.");
         jResponse["State"] = false;
@@ -139,270 +277,212 @@ QJsonObject DataBaseHandler::logIn(const QJsonObject &data)
         return jResponse;
     }
 
-    // If login is successful, return user details
-    bool isAdmin = obj.value(data.value("UserName").toString()).toObject().value("IsAdmin").toBool();
-    QString accountNumber = obj.value(data.value("UserName").toString()).toObject().value("AccountNumber").toString();
+    // Replace plaintext passwords of older databases, or hashes with an old work factor
+    if (!readOnly && PasswordHasher::needsRehash(stored))
+    {
+        shard->updatePassword(userName, PasswordHasher::hash(password));
+    }
+
+    bool isAdmin = userObj.value("IsAdmin").toBool();
 
+    // If login is successful, return user details and the session token for later requests
     jResponse["State"] = true;
     jResponse["IsAdmin"] = isAdmin;
-    jResponse["UserName"] = data.value("UserName").toString();
+    jResponse["UserName"] = userName;
     jResponse["AccountNumber"] = accountNumber;
+    jResponse["SessionToken"] = SessionManager::getInstance()->createSession(userName, accountNumber, isAdmin);
 
-    DBLogs->log("User: " + data.value("UserName").toString() + " has logged in successfully.");
-
-    return jResponse; // Return successful login response
+    DBLogs->log("User: " + userName + " has logged in successfully.");
+    return jResponse;
 }
 
 // Creates a new user in the database
 QJsonObject DataBaseHandler::createUser(QJsonObject &data)
 {
     QJsonObject jResponse;
-    QJsonParseError jError;
-    QJsonDocument doc;
+    QString userName = data.value("UserName").toString();
+    QString accountNumber;
 
-    // Verify the database file and parse it
-    if (!CheckDataBase(jResponse, jError, doc))
     {
-        return jResponse; // Return response indicating failure
-    }
-
-    QJsonObject jsonObj = doc.object(); // Convert QJsonDocument to QJsonObject
+        QWriteLocker locker(&directoryLock);
 
-    // Check if the username is already taken
-    if (jsonObj.contains(data.value("UserName").toString()))
-    {
-        DBLogs->log("Username already taken.");
-        jResponse["State"] = false;
-        jResponse["Reason"] = -1; // Username already taken
-        return jResponse;
-    }
-
-    // Generate a unique account number
-    bool flag;
-    qint32 accountNum;
-    QStringList list = jsonObj.keys();
+        // Check if the username is already taken
+        if (userDirectory.contains(userName))
+        {
+            DBLogs->log("Username already taken.");
+            jResponse["State"] = false;
+            jResponse["Reason"] = -1; // Username already taken
+            return jResponse;
+        }
 
-    while (true)
-    {
-        accountNum = randomNumGen.bounded(1, 1000); // Generate a random account number
-        flag = false;
-        for (const QString &key : list)
+        // Generate a unique account number. The range is large enough for a free number to be found
+        // within a few tries; the tries are bounded since the directory lock is held meanwhile.
+        for (qint32 attempt = 0; attempt < accountNumberAttempts; attempt++)
         {
-            qint32 number = jsonObj.value(key).toObject().value("AccountNumber").toString().toInt();
-            if (number == accountNum)
+            QString candidate = QString::number(randomNumGen.bounded(1, accountNumberLimit)); // Generate a random account number
+            if (!usedAccountNumbers.contains(candidate))
             {
-                flag = true; // Account number already exists
+                accountNumber = candidate; // Unique account number found
                 break;
             }
         }
-        if (!flag)
+        if (accountNumber.isEmpty())
         {
-            break; // Unique account number found
+            DBLogs->log("No free account number found for user: " + userName, Logger::Error);
+            jResponse["State"] = false;
+            jResponse["Reason"] = -2; // No free account number
+            return jResponse;
         }
+
+        // Reserve the username and the account number until the shard stores the user
+        userDirectory.insert(userName, accountNumber);
+        usedAccountNumbers.insert(accountNumber);
     }
 
     // Prepare new user data
     QJsonArray history; // Transaction history initialized as an empty array
     data["TransactionHistory"] = history;
-    data["AccountNumber"] = QString::number(accountNum);
+    data["AccountNumber"] = accountNumber;
 
-    // Insert new user data into the JSON object
+    // Insert new user data into the shard owning the account number
     data.remove("RequestID"); // Remove request ID from user data
+    data["Password"] = PasswordHasher::hash(data.value("Password").toString()); // Only the hash is stored
     QJsonObject newobj = data;
     newobj.remove("UserName"); // Remove username from the user object before adding
-    jsonObj.insert(data.value("UserName").toString(), newobj);
+    jResponse = shardFor(accountNumber)->insertAccount(userName, newobj);
 
-    // Open the database file for writing and update it
-    if (!DataBaseFile->open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate))
+    if (!jResponse.value("State").toBool())
     {
-        DBLogs->log("Failed to open file for writing.");
-        jResponse["State"] = false;
-        jResponse["Reason"] = -4; // Failed to open file for writing
+        // Release the reservation if the shard could not store the user
+        QWriteLocker locker(&directoryLock);
+        userDirectory.remove(userName);
+        usedAccountNumbers.remove(accountNumber);
         return jResponse;
     }
 
-    // Write the updated JSON to the file
-    QJsonDocument writableDoc(jsonObj);
-    QTextStream stream(DataBaseFile.get());
-    stream << QString::fromUtf8(writableDoc.toJson(QJsonDocument::Indented));
-    DataBaseFile->close(); // Close the file after writing
-
-    DBLogs->log("User: " + data.value("UserName").toString() + " created successfully.");
-    jResponse["State"] = true; // Indicate successful user creation
-    return jResponse;
+    DBLogs->log("User: " + userName + " created successfully.");
+    return jResponse; // Indicate successful user creation
 }
 
 // Updates an existing user's information in the database
 QJsonObject DataBaseHandler::updateUser(const QJsonObject &data)
 {
     QJsonObject jResponse;
-    QJsonParseError jError;
-    QJsonDocument doc;
+    QString accountNumber = data.value("AccountNumber").toString();
+    QString newUserName = data.value("UserName").toString();
 
-    // Check if the database file is valid and readable
-    if (!CheckDataBase(jResponse, jError, doc))
     {
-        return jResponse; // Return response indicating failure
-    }
-
-    QJsonObject jsonObj = doc.object(); // Get the JSON object from the document
-    QStringList list = jsonObj.keys(); // Get all keys (usernames) from the JSON object
-    QString desiredKey;
-    bool flag = false;
+        QWriteLocker locker(&directoryLock);
 
-    // Search for the user with the specified account number
-    foreach (QString key, list)
-    {
-        QString number = jsonObj.value(key).toObject().value("AccountNumber").toString();
-        if (number == data.value("AccountNumber").toString())
+        // Search for the user with the specified account number
+        if (!usedAccountNumbers.contains(accountNumber))
         {
-            desiredKey = key;
-            flag = true;
-            break;
+            DBLogs->log("User: " + accountNumber + " not found.");
+            jResponse["State"] = false;
+            jResponse["Reason"] = -1; // User not found in database
+            return jResponse;
         }
-    }
-
-    if (flag)
-    {
-        // User found, proceed with updating
-        QJsonObject desiredObj = jsonObj.value(desiredKey).toObject();
-        desiredObj["IsAdmin"] = data.value("IsAdmin").toBool(); // Update admin status
 
-        // Update other fields if provided
-        if (!data.value("FullName").toString().isEmpty())
-        {
-            desiredObj["FullName"] = data.value("FullName").toString();
-        }
-        if (!data.value("Password").toString().isEmpty())
-        {
-            desiredObj["Password"] = data.value("Password").toString();
-        }
-        if (!data.value("Age").toString().isEmpty())
-        {
-            desiredObj["Age"] = data.value("Age").toString();
-        }
-        if (!data.value("UserName").toString().isEmpty())
+        if (!newUserName.isEmpty())
         {
             // Check if the new username is already taken
-            if (!jsonObj.contains(data.value("UserName").toString()))
-            {
-                jsonObj[data.value("UserName").toString()] = desiredObj; // Update the username
-                jsonObj.remove(desiredKey); // Remove old username
-            }
-            else
+            if (userDirectory.contains(newUserName))
             {
-                DBLogs->log("User: " + data.value("UserName").toString() + " already exists.");
+                DBLogs->log("User: " + newUserName + " already exists.");
                 jResponse["State"] = false;
                 jResponse["Reason"] = -2; // New username already exists
                 return jResponse;
             }
-        }
-        else
-        {
-            // Just update the existing username
-            jsonObj.remove(desiredKey);
-            jsonObj[desiredKey] = desiredObj;
-        }
 
-        // Write the modified JSON object back to the file
-        if (!DataBaseFile->open(QIODevice::ReadWrite | QIODevice::Text))
-        {
-            DBLogs->log("Failed to open file for reading and writing.");
-            jResponse["State"] = false;
-            jResponse["Reason"] = -4; // Failed to open file for reading and writing
-            DataBaseFile->close();
-            return jResponse;
+            // Reserve the new username until the shard renames the user
+            userDirectory.insert(newUserName, accountNumber);
         }
+    }
 
-        DataBaseFile->resize(0); // Clear existing content
-        QTextStream stream(DataBaseFile.get());
-        stream << QJsonDocument(jsonObj).toJson(QJsonDocument::Indented);
-        DataBaseFile->close(); // Close the file after writing
+    // Only the hash of a new password is stored
+    QJsonObject update = data;
+    if (!update.value("Password").toString().isEmpty())
+    {
+        update["Password"] = PasswordHasher::hash(update.value("Password").toString());
+    }
 
-        DBLogs->log("User: " + data.value("AccountNumber").toString() + " updated successfully.");
-        jResponse["State"] = true; // Indicate successful update
-        return jResponse;
+    QString oldUserName;
+    jResponse = shardFor(accountNumber)->updateUser(update, oldUserName);
+
+    if (!newUserName.isEmpty())
+    {
+        // Drop the old username on success, or the reservation on failure
+        QWriteLocker locker(&directoryLock);
+        userDirectory.remove(jResponse.value("State").toBool() ? oldUserName : newUserName);
+    }
+
+    // Open sessions still carry the old username and admin status
+    if (jResponse.value("State").toBool())
+    {
+        SessionManager::getInstance()->endSessionsOf(accountNumber);
     }
 
-    // User not found
-    DBLogs->log("User: " + data.value("AccountNumber").toString() + " not found.");
-    jResponse["State"] = false;
-    jResponse["Reason"] = -1; // User not found in database
     return jResponse;
 }
 
 // Deletes a user from the database
 QJsonObject DataBaseHandler::deleteUser(const QJsonObject &data)
 {
-    QJsonObject jResponse;
-    QJsonParseError jError;
-    QJsonDocument doc;
-
-    // Check if the database file is valid and readable
-    if (!CheckDataBase(jResponse, jError, doc))
-    {
-        return jResponse; // Return response indicating failure
-    }
+    QString accountNumber = data.value("AccountNumber").toString();
+    QString userName;
 
-    QJsonObject jsonObj = doc.object(); // Get the JSON object from the document
-    QStringList list = jsonObj.keys(); // Get all keys (usernames) from the JSON object
-    bool flag = false;
+    QJsonObject jResponse = shardFor(accountNumber)->deleteUser(accountNumber, userName);
 
-    // Search for the user with the specified account number
-    foreach (QString key, list)
+    if (jResponse.value("State").toBool())
     {
-        QString number = jsonObj.value(key).toObject().value("AccountNumber").toString();
-        if (number == data.value("AccountNumber").toString())
-        {
-            jsonObj.remove(key); // Remove the user
-            flag = true;
-            break;
-        }
-    }
+        // Remove the user from the directory as well
+        QWriteLocker locker(&directoryLock);
+        userDirectory.remove(userName);
+        usedAccountNumbers.remove(accountNumber);
+        locker.unlock();
 
-    if (flag)
-    {
-        // Write the modified JSON object back to the file
-        if (!DataBaseFile->open(QIODevice::ReadWrite | QIODevice::Text))
-        {
-            DBLogs->log("Failed to open file for reading and writing.");
-            jResponse["State"] = false;
-            jResponse["Reason"] = -4; // Failed to open file for reading and writing
-            DataBaseFile->close();
-            return jResponse;
-        }
-
-        DataBaseFile->resize(0); // Clear existing content
-        QTextStream stream(DataBaseFile.get());
-        stream << QJsonDocument(jsonObj).toJson(QJsonDocument::Indented);
-        DataBaseFile->close(); // Close the file after writing
-
-        DBLogs->log("User: " + data.value("AccountNumber").toString() + " deleted successfully.");
-        jResponse["State"] = true; // Indicate successful deletion
-        return jResponse;
+        SessionManager::getInstance()->endSessionsOf(accountNumber); // Sessions of a deleted user end with it
     }
 
-    // User not found
-    DBLogs->log("User: " + data.value("AccountNumber").toString() + " not found.");
-    jResponse["State"] = false;
-    jResponse["Reason"] = -1; // User not found in database
     return jResponse;
 }
 
 // Retrieves the entire database
-QJsonObject DataBaseHandler::viewBankDB()
+QJsonObject DataBaseHandler::viewBankDB(const QJsonObject &data)
 {
+    // A client presenting the version of its copy only gets the accounts changed since then,
+    // unless the version is from an earlier run of the server or too old for the change log
+    if (data.contains("SinceVersion") && (data.value("Epoch").toString() == changeLog.epoch()))
+    {
+        QSet<QString> changed;
+        quint64 version;
+        if (changeLog.changesSince(data.value("SinceVersion").toString().toULongLong(), changed, version))
+        {
+            return viewBankDBChanges(changed, version);
+        }
+        DBLogs->log("Change log does not reach back to version " + data.value("SinceVersion").toString() + ", sending the whole database.");
+    }
+
     QJsonObject jResponse;
-    QJsonParseError jError;
-    QJsonDocument doc;
+    QJsonObject obj;
+
+    // Taken before the snapshots, so changes made meanwhile are sent again with the next delta
+    quint64 version = changeLog.version();
 
-    // Check if the database file is valid and readable
-    if (!CheckDataBase(jResponse, jError, doc))
+    // Merge the account tables of all shards
+    for (const auto &shard : shards)
     {
-        return jResponse; // Return response indicating failure
-    }
+        if (!shard->CheckDataBase(jResponse))
+        {
+            return jResponse; // Return response indicating failure
+        }
 
-    QJsonObject obj = doc.object(); // Get the JSON object from the document
+        QJsonObject table = shard->snapshot();
+        for (auto it = table.constBegin(); it != table.constEnd(); ++it)
+        {
+            obj.insert(it.key(), it.value());
+        }
+    }
 
     // Check if the database is empty
     if (obj.isEmpty())
@@ -416,320 +496,605 @@ QJsonObject DataBaseHandler::viewBankDB()
     // Return the database content
     DBLogs->log("Return the database content.");
     jResponse["DataBase"] = obj;
+    jResponse["Version"] = QString::number(version);
+    jResponse["Epoch"] = changeLog.epoch();
     jResponse["State"] = true; // Indicate successful retrieval
     return jResponse;
 }
 
-// Retrieves the account number associated with a given username
-QJsonObject DataBaseHandler::getAccount_Number(const QJsonObject &data)
+// Returns the current accounts of the changed usernames; usernames without an account were deleted or renamed
+QJsonObject DataBaseHandler::viewBankDBChanges(const QSet<QString> &changed, quint64 version)
 {
     QJsonObject jResponse;
-    QJsonParseError jError;
-    QJsonDocument doc;
+    QJsonObject updated;
+    QJsonArray deleted;
+
+    // Group the usernames by the shard holding their account
+    QHash<DataBaseShard*, QStringList> byShard;
+    {
+        QReadLocker locker(&directoryLock);
+        for (const QString &userName : changed)
+        {
+            if (userDirectory.contains(userName))
+            {
+                byShard[shardFor(userDirectory.value(userName))].append(userName);
+            }
+            else
+            {
+                deleted.append(userName);
+            }
+        }
+    }
 
-    // Check if the database file is valid and readable
-    if (!CheckDataBase(jResponse, jError, doc))
+    for (auto it = byShard.constBegin(); it != byShard.constEnd(); ++it)
     {
-        return jResponse; // Return response indicating failure
+        QJsonObject shardResponse = it.key()->findUsers(it.value());
+        if (!shardResponse.value("State").toBool())
+        {
+            return shardResponse; // Return response indicating failure
+        }
+
+        QJsonObject found = shardResponse.value("Accounts").toObject();
+        for (const QString &userName : it.value())
+        {
+            if (found.contains(userName))
+            {
+                updated[userName] = found.value(userName);
+            }
+            else
+            {
+                deleted.append(userName); // Removed between the directory lookup and the shard
+            }
+        }
     }
 
-    QJsonObject obj = doc.object(); // Get the JSON object from the document
+    DBLogs->log("Return " + QString::number(changed.size()) + " database changes.");
+    jResponse["Delta"] = true;
+    jResponse["Updated"] = updated;
+    jResponse["Deleted"] = deleted;
+    jResponse["Version"] = QString::number(version);
+    jResponse["Epoch"] = changeLog.epoch();
+    jResponse["State"] = true;
+    return jResponse;
+}
+
+// Retrieves the account number associated with a given username
+QJsonObject DataBaseHandler::getAccount_Number(const QJsonObject &data)
+{
+    QJsonObject jResponse;
+    QString userName = data.value("UserName").toString();
+
+    QReadLocker locker(&directoryLock);
 
-    // Check if the user exists in the database
-    if (obj.value(data.value("UserName").toString()) == QJsonValue::Undefined)
+    // Check if the user exists in the directory
+    if (!userDirectory.contains(userName))
     {
-        DBLogs->log("User: " + data.value("UserName").toString() + " not found.");
+        DBLogs->log("User: " + userName + " not found.");
         jResponse["State"] = false;
         jResponse["Reason"] = -1; // User not found
         return jResponse;
     }
 
-    // Retrieve the account number of the user
-    QString accountNumber = obj.value(data.value("UserName").toString()).toObject().value("AccountNumber").toString();
-
     DBLogs->log("Return account number of the user.");
     jResponse["State"] = true;
-    jResponse["AccountNumber"] = accountNumber;
+    jResponse["AccountNumber"] = userDirectory.value(userName);
     return jResponse;
 }
 
 // Retrieves the balance of a given account number
 QJsonObject DataBaseHandler::viewAccount_Balance(const QJsonObject &data)
+{
+    return shardFor(data.value("AccountNumber").toString())->viewAccount_Balance(data);
+}
+
+// Retrieves the transaction history for a given account number
+QJsonObject DataBaseHandler::viewTransaction_History(const QJsonObject &data)
+{
+    return shardFor(data.value("AccountNumber").toString())->viewTransaction_History(data);
+}
+
+// Performs a transaction (deposit or withdrawal) on a given account
+QJsonObject DataBaseHandler::makeTransaction(const QJsonObject &data)
+{
+    return shardFor(data.value("AccountNumber").toString())->makeTransaction(data);
+}
+
+// Transfers an amount from one account to another.
+// Both accounts may live on different shards, so the transfer runs in two phases:
+// both shards first check their account and hold the amount, then both apply it.
+QJsonObject DataBaseHandler::transferAmount(const QJsonObject &data)
 {
     QJsonObject jResponse;
-    QJsonParseError jError;
-    QJsonDocument doc;
+    QString senderAccount = data.value("SenderAccountNumber").toString();
+    QString receiverAccount = data.value("ReceiverAccountNumber").toString();
+    double amount = data.value("Amount").toString().toDouble();
 
-    // Check if the database file is valid and readable
-    if (!CheckDataBase(jResponse, jError, doc))
+    DataBaseShard *senderShard = shardFor(senderAccount);
+    DataBaseShard *receiverShard = shardFor(receiverAccount);
+
+    // Each leg holds its amount under its own ID, as both may be on the same shard
+    quint64 receiverHold = nextTransferID++;
+    quint64 senderHold = nextTransferID++;
+
+    // Phase 1: check that the receiver exists
+    QJsonObject receiverResponse = receiverShard->prepareTransfer(receiverHold, receiverAccount, amount);
+    if (!receiverResponse.value("State").toBool())
     {
-        return jResponse; // Return response indicating failure
+        DBLogs->log("User: " + receiverAccount + " receiver not found.");
+        jResponse["State"] = false;
+        jResponse["Reason"] = receiverResponse.value("Reason").toInt(); // Receiver account not found
+        return jResponse;
+    }
+
+    // Phase 1: check that the sender exists and holds enough balance
+    QJsonObject senderResponse = senderShard->prepareTransfer(senderHold, senderAccount, amount * (-1));
+    if (!senderResponse.value("State").toBool())
+    {
+        receiverShard->abortTransfer(receiverHold);
+        DBLogs->log("Sender transaction failed.");
+        jResponse["State"] = false;
+        jResponse["Reason"] = senderResponse.value("Reason").toInt();
+        return jResponse;
     }
 
-    QJsonObject database = doc.object(); // Get the JSON object from the document
-    QJsonObject desiredObj;
-    QStringList list = database.keys(); // Get all keys (usernames) from the JSON object
-    bool flag = false;
+    // Phase 2: apply both legs; prepared accounts cannot be deleted, so both commits succeed
+    senderShard->commitTransfer(senderHold);
+    receiverShard->commitTransfer(receiverHold);
+
+    DBLogs->log("Transfer done successful.");
+    jResponse["State"] = true; // Transfer successful
+    return jResponse;
+}
 
-    // Search for the account number
-    foreach (QString key, list)
+// Combines the running totals of all shards.
+// Credits, including received transfers, count as deposits and debits as withdrawals.
+QJsonObject DataBaseHandler::summary(const QJsonObject &data)
+{
+    QJsonObject jResponse;
+    qint32 accounts = 0;
+    qint32 admins = 0;
+    double totalBalance = 0;
+    QMap<QString, QJsonObject> days; // Sorted by the ISO date
+
+    for (const auto &shard : shards)
     {
-        QString number = database.value(key).toObject().value("AccountNumber").toString();
-        if (number == data.value("AccountNumber").toString())
+        QJsonObject shardSummary = shard->summary(data);
+        if (!shardSummary.value("State").toBool())
         {
-            desiredObj = database.value(key).toObject(); // Retrieve the account details
-            flag = true;
-            break;
+            return shardSummary; // Return response indicating failure
+        }
+
+        accounts += shardSummary.value("Accounts").toInt();
+        admins += shardSummary.value("Admins").toInt();
+        totalBalance += shardSummary.value("TotalBalance").toDouble();
+
+        QJsonObject shardDays = shardSummary.value("Days").toObject();
+        for (auto it = shardDays.constBegin(); it != shardDays.constEnd(); ++it)
+        {
+            QJsonObject shardDay = it.value().toObject();
+            QJsonObject &day = days[it.key()];
+            day["Deposits"] = day.value("Deposits").toDouble() + shardDay.value("Deposits").toDouble();
+            day["Withdrawals"] = day.value("Withdrawals").toDouble() + shardDay.value("Withdrawals").toDouble();
+            day["Transactions"] = day.value("Transactions").toInt() + shardDay.value("Transactions").toInt();
         }
     }
 
-    // User found
-    if (flag)
+    // Amounts are sent as strings, like the account balances, with two decimals:
+    // the default format keeps 6 significant digits, which rounds large totals,
+    // and the sums of many doubles carry noise below the cent
+    QJsonArray dayList;
+    for (auto it = days.constBegin(); it != days.constEnd(); ++it)
     {
-        jResponse["AccountBalance"] = desiredObj.value("AccountBalance"); // Retrieve and return the balance
-        DBLogs->log("Return balance of the user.");
-        jResponse["State"] = true;
-        return jResponse;
+        QJsonObject day;
+        day["Date"] = it.key();
+        day["Deposits"] = QString::number(it.value().value("Deposits").toDouble(), 'f', 2);
+        day["Withdrawals"] = QString::number(it.value().value("Withdrawals").toDouble(), 'f', 2);
+        day["Transactions"] = it.value().value("Transactions").toInt();
+        dayList.append(day);
     }
 
-    // User not found
-    DBLogs->log("User: " + data.value("AccountNumber").toString() + " not found.");
-    jResponse["State"] = false;
-    jResponse["Reason"] = -1; // Account number not found
+    DBLogs->log("Return the database summary.");
+    jResponse["Accounts"] = accounts;
+    jResponse["Admins"] = admins;
+    jResponse["Users"] = accounts - admins;
+    jResponse["TotalBalance"] = QString::number(totalBalance, 'f', 2);
+    jResponse["Days"] = dayList;
+    jResponse["State"] = true;
     return jResponse;
 }
 
-// Retrieves the transaction history for a given account number
-QJsonObject DataBaseHandler::viewTransaction_History(const QJsonObject &data)
+// Lists the richest accounts, or the poorest ones
+QJsonObject DataBaseHandler::topAccounts(const QJsonObject &data)
+{
+    qint32 count = data.value("Count").toString().toInt();
+    if (count <= 0)
+    {
+        QJsonObject jResponse;
+        jResponse["State"] = false;
+        jResponse["Reason"] = -1; // Missing or invalid count
+        return jResponse;
+    }
+
+    // Like the other fields, "Bottom" may come as a string as well as a JSON bool
+    QJsonValue bottomValue = data.value("Bottom");
+    bool bottom = bottomValue.isString() ? (bottomValue.toString().compare("true", Qt::CaseInsensitive) == 0) : bottomValue.toBool();
+
+    DBLogs->log("Return the top " + QString::number(count) + " accounts.");
+    return mergeBalanceQuery(-std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(),
+                             count, !bottom);
+}
+
+// Lists the accounts within a balance range; a missing bound leaves that side of the range open
+QJsonObject DataBaseHandler::balanceRange(const QJsonObject &data)
+{
+    bool minOk;
+    bool maxOk;
+    double minBalance = data.value("MinBalance").toString().toDouble(&minOk);
+    double maxBalance = data.value("MaxBalance").toString().toDouble(&maxOk);
+
+    DBLogs->log("Return the accounts within a balance range.");
+    return mergeBalanceQuery(minOk ? minBalance : -std::numeric_limits<double>::infinity(),
+                             maxOk ? maxBalance : std::numeric_limits<double>::infinity(),
+                             data.value("Count").toString().toInt(), false);
+}
+
+// Finds accounts by a part of their names on every shard
+QJsonObject DataBaseHandler::search(const QJsonObject &data)
 {
     QJsonObject jResponse;
-    QJsonParseError jError;
-    QJsonDocument doc;
+    QString text = data.value("Query").toString().trimmed();
+    bool substring = (data.value("Mode").toString() == "Substring");
+    qint32 count = data.contains("Count") ? data.value("Count").toString().toInt() : 100;
 
-    // Check if the database file is valid and readable
-    if (!CheckDataBase(jResponse, jError, doc))
+    SearchIndex::Field field = SearchIndex::AnyField;
+    if (data.value("Field").toString() == "UserName")
     {
-        return jResponse; // Return response indicating failure
+        field = SearchIndex::UserNameField;
+    }
+    else if (data.value("Field").toString() == "FullName")
+    {
+        field = SearchIndex::FullNameField;
     }
 
-    QJsonObject database = doc.object(); // Get the JSON object from the document
-    QJsonObject desiredObj;
-    QJsonArray newArr;
-    int count = data.value("Count").toString().toInt(); // Number of transactions to retrieve
-    QStringList list = database.keys(); // Get all keys (usernames) from the JSON object
-    bool flag = false;
-
-    // Search for the account number
-    foreach (QString key, list)
+    if (text.isEmpty() || (substring && (text.size() < SearchIndex::trigramLength)))
     {
-        QString number = database.value(key).toObject().value("AccountNumber").toString();
-        if (number == data.value("AccountNumber").toString())
-        {
-            desiredObj = database.value(key).toObject(); // Retrieve the account details
-            flag = true;
-            break;
-        }
+        DBLogs->log("Search text too short.");
+        jResponse["State"] = false;
+        jResponse["Reason"] = -1; // Empty text, or too short for a substring search
+        return jResponse;
     }
 
-    // User found
-    if (flag)
+    std::vector<QJsonObject> merged;
+    for (const auto &shard : shards)
     {
-        QJsonArray transHistory = desiredObj.value("TransactionHistory").toArray(); // Retrieve transaction history
-        if (transHistory.isEmpty())
+        QJsonObject shardResponse = shard->search(text, substring, field, count);
+        if (!shardResponse.value("State").toBool())
         {
-            DBLogs->log("No transactions history of the user found.");
-            jResponse["State"] = false;
-            jResponse["Reason"] = -2; // No transactions found
-            return jResponse;
+            return shardResponse; // Return response indicating failure
         }
 
-        // Retrieve the most recent transactions up to the specified count
-        for (int i = transHistory.size() - 1; i >= 0; i--)
+        for (const QJsonValue &account : shardResponse.value("Accounts").toArray())
         {
-            newArr.append(transHistory.at(i).toObject());
-            count--;
-            if (count == 0)
-            {
-                break;
-            }
+            merged.push_back(account.toObject());
         }
+    }
 
-        DBLogs->log("Return transactions history of the user.");
-        jResponse["Transactions"] = newArr;
-        jResponse["State"] = true;
-        return jResponse;
+    std::sort(merged.begin(), merged.end(), [](const QJsonObject &a, const QJsonObject &b) {
+        return a.value("UserName").toString() < b.value("UserName").toString();
+    });
+
+    QJsonArray list;
+    for (const QJsonObject &account : merged)
+    {
+        if ((count > 0) && (list.size() >= count))
+        {
+            break;
+        }
+        list.append(account);
     }
 
-    // User not found
-    DBLogs->log("User: " + data.value("AccountNumber").toString() + " not found.");
-    jResponse["State"] = false;
-    jResponse["Reason"] = -1; // Account number not found
+    DBLogs->log("Return " + QString::number(list.size()) + " accounts found by the search.");
+    jResponse["Accounts"] = list;
+    jResponse["State"] = true;
     return jResponse;
 }
 
-// Performs a transaction (deposit or withdrawal) on a given account
-QJsonObject DataBaseHandler::makeTransaction(const QJsonObject &data)
+// Every shard returns its own first count accounts of the range, so the first count of their union are the answer
+QJsonObject DataBaseHandler::mergeBalanceQuery(double minBalance, double maxBalance, qint32 count, bool descending)
 {
     QJsonObject jResponse;
-    QJsonParseError jError;
-    QJsonDocument doc;
+    std::vector<QJsonObject> merged;
 
-    // Check if the database file is valid and readable
-    if (!CheckDataBase(jResponse, jError, doc))
+    for (const auto &shard : shards)
     {
-        return jResponse; // Return response indicating failure
+        QJsonObject shardResponse = shard->balanceQuery(minBalance, maxBalance, count, descending);
+        if (!shardResponse.value("State").toBool())
+        {
+            return shardResponse; // Return response indicating failure
+        }
+
+        for (const QJsonValue &account : shardResponse.value("Accounts").toArray())
+        {
+            merged.push_back(account.toObject());
+        }
     }
 
-    QJsonObject desiredObj;
-    QString desiredKey;
-    QJsonObject database = doc.object(); // Get the JSON object from the document
-    QStringList list = database.keys(); // Get all keys (usernames) from the JSON object
-    bool flag = false;
+    // Order by balance, then by account number like the shards do
+    auto before = [descending](const QJsonObject &a, const QJsonObject &b) {
+        double balanceA = a.value("AccountBalance").toString().toDouble();
+        double balanceB = b.value("AccountBalance").toString().toDouble();
+        if (balanceA != balanceB)
+        {
+            return descending ? (balanceA > balanceB) : (balanceA < balanceB);
+        }
+        return descending ? (a.value("AccountNumber").toString() > b.value("AccountNumber").toString())
+                          : (a.value("AccountNumber").toString() < b.value("AccountNumber").toString());
+    };
+    std::sort(merged.begin(), merged.end(), before);
 
-    // Search for the account number
-    foreach (QString key, list)
+    QJsonArray list;
+    for (const QJsonObject &account : merged)
     {
-        QString number = database.value(key).toObject().value("AccountNumber").toString();
-        if (number == data.value("AccountNumber").toString())
+        if ((count > 0) && (list.size() >= count))
         {
-            desiredKey = key; // Save the key for updating
-            desiredObj = database.value(key).toObject(); // Retrieve the account details
-            database.remove(key); // Temporarily remove the user object for update
-            flag = true;
             break;
         }
+        list.append(account);
+    }
+
+    jResponse["Accounts"] = list;
+    jResponse["State"] = true;
+    return jResponse;
+}
+
+// Holds back the early checkpoints of every shard while a batch runs
+void DataBaseHandler::beginBatch()
+{
+    for (const auto &shard : shards)
+    {
+        shard->deferCheckpoints();
     }
+}
 
-    // User found, perform the transaction
-    if (flag)
+// Lets every shard write the changes of the finished batch
+void DataBaseHandler::endBatch()
+{
+    for (const auto &shard : shards)
     {
-        double oldBalance = desiredObj.value("AccountBalance").toString().toDouble();
-        double amount = data.value("Amount").toString().toDouble();
-        double newBalance = oldBalance + amount; // Calculate new balance
+        shard->resumeCheckpoints();
+    }
+}
+
+// Applies a list of transactions and transfers all together or not at all.
+// Every leg is first held on its shard as in transferAmount; only if all legs can be held
+// are they committed, otherwise every hold is released and nothing changes.
+QJsonObject DataBaseHandler::transactBatch(const QJsonArray &requests)
+{
+    QJsonObject jResponse;
+    QJsonArray results;
 
-        // Check if the new balance is non-negative
-        if (newBalance < 0)
+    // A leg of the batch held on a shard
+    struct Leg
+    {
+        DataBaseShard *shard;
+        quint64 holdID;
+    };
+    QList<Leg> legs;
+
+    // Holds an amount on the shard of an account, returning 0 or the reason of the failure
+    auto holdLeg = [&](const QString &accountNumber, double amount, const QString &type) {
+        DataBaseShard *shard = shardFor(accountNumber);
+        quint64 holdID = nextTransferID++;
+        QJsonObject response = shard->prepareTransfer(holdID, accountNumber, amount, type);
+        if (!response.value("State").toBool())
         {
-            DBLogs->log("Insufficient funds.");
-            jResponse["State"] = false;
-            jResponse["Reason"] = -2; // Insufficient funds
-            return jResponse;
+            return response.value("Reason").toInt();
         }
+        legs.append(Leg{shard, holdID});
+        return 0;
+    };
+
+    // Phase 1: hold every leg; withdrawals must be covered by the balance minus the earlier holds
+    qint32 failedIndex = -1;
+    qint32 failedReason = 0;
+    for (qint32 i = 0; (i < requests.size()) && (failedIndex < 0); i++)
+    {
+        QJsonObject data = requests.at(i).toObject();
+        double amount = data.value("Amount").toString().toDouble();
 
-        // Update account balance and transaction history
-        desiredObj["AccountBalance"] = QString::number(newBalance);
-
-        // Create a new transaction record
-        QJsonArray transactionHistory = desiredObj.value("TransactionHistory").toArray();
-        QJsonObject transaction;
-        QString date = QDateTime::currentDateTime().toString("dd-MM-yyyy");
-        QString time = QDateTime::currentDateTime().toString("hh:mm:ss");
-        transaction["Date"] = date;
-        transaction["Time"] = time;
-        transaction["Type"] = (amount > 0) ? "Deposit" : "Withdraw";
-        transaction["Amount"] = QString::number(amount);
-        transactionHistory.append(transaction); // Append new transaction
+        if (data.contains("SenderAccountNumber"))
+        {
+            failedReason = holdLeg(data.value("ReceiverAccountNumber").toString(), amount, "Transfer");
+            if (failedReason == 0)
+            {
+                failedReason = holdLeg(data.value("SenderAccountNumber").toString(), amount * (-1), "Transfer");
+            }
+        }
+        else
+        {
+            failedReason = holdLeg(data.value("AccountNumber").toString(), amount, (amount > 0) ? "Deposit" : "Withdraw");
+        }
 
-        desiredObj["TransactionHistory"] = transactionHistory;
-        database[desiredKey] = desiredObj; // Update user object in database
+        if (failedReason != 0)
+        {
+            failedIndex = i;
+        }
+    }
 
-        // Write the modified JSON back to the file
-        if (!DataBaseFile->open(QIODevice::ReadWrite | QIODevice::Text))
+    if (failedIndex >= 0)
+    {
+        // Release every hold; no account was changed
+        for (const Leg &leg : legs)
         {
-            DBLogs->log("Failed to open file for reading and writing.");
-            jResponse["State"] = false;
-            jResponse["Reason"] = -4; // Failed to open file for reading and writing
-            DataBaseFile->close();
-            return jResponse;
+            leg.shard->abortTransfer(leg.holdID);
         }
 
-        DataBaseFile->resize(0); // Clear existing content
-        QTextStream stream(DataBaseFile.get());
-        stream << QJsonDocument(database).toJson(QJsonDocument::Indented);
-        DataBaseFile->close();
+        for (qint32 i = 0; i < requests.size(); i++)
+        {
+            QJsonObject result;
+            result["State"] = false;
+            result["Reason"] = (i == failedIndex) ? failedReason : -12; // -12: not applied
+            results.append(result);
+        }
 
-        DBLogs->log("Transaction done successful.");
-        jResponse["State"] = true; // Transaction successful
+        DBLogs->log("Batch rolled back at request " + QString::number(failedIndex) + ".");
+        jResponse["State"] = false;
+        jResponse["Reason"] = -12;
+        jResponse["FailedIndex"] = failedIndex;
+        jResponse["Results"] = results;
         return jResponse;
     }
 
-    // User not found
-    DBLogs->log("User: " + data.value("AccountNumber").toString() + " not found.");
-    jResponse["State"] = false;
-    jResponse["Reason"] = -1; // Account number not found
+    // Phase 2: apply every leg; held accounts cannot be deleted, so all commits succeed
+    beginBatch();
+    for (const Leg &leg : legs)
+    {
+        leg.shard->commitTransfer(leg.holdID);
+    }
+    endBatch();
+
+    for (qint32 i = 0; i < requests.size(); i++)
+    {
+        QJsonObject result;
+        result["State"] = true;
+        results.append(result);
+    }
+
+    DBLogs->log("Batch of " + QString::number(requests.size()) + " requests applied.");
+    jResponse["State"] = true;
+    jResponse["Results"] = results;
     return jResponse;
 }
 
-// Transfers an amount from one account to another
-QJsonObject DataBaseHandler::transferAmount(const QJsonObject &data)
+// Writes every shard's pending changes to disk
+bool DataBaseHandler::checkpoint()
 {
-    QJsonObject jResponse;
-    QJsonParseError jError;
-    QJsonDocument doc;
+    bool result = true;
+    for (const auto &shard : shards)
+    {
+        result = shard->checkpoint() && result;
+    }
+    return result;
+}
 
-    // Check if the database file is valid and readable
-    if (!CheckDataBase(jResponse, jError, doc))
+// Sets the checkpoint interval and the number of changes that trigger an early checkpoint on every shard
+void DataBaseHandler::configureCheckpoint(qint32 intervalMs, qint32 maxPendingChanges)
+{
+    for (const auto &shard : shards)
     {
-        return jResponse; // Return response indicating failure
+        shard->configureCheckpoint(intervalMs, maxPendingChanges);
     }
+}
 
-    QJsonObject DataBaseObj = doc.object(); // Get the JSON object from the document
-    QStringList list = DataBaseObj.keys(); // Get all keys (usernames) from the JSON object
-    bool receiverFound = false;
+// Sets the number of changes remembered for clients syncing their copy
+void DataBaseHandler::configureChangeLog(qint32 entries)
+{
+    changeLog.setCapacity(entries);
+}
 
-    // Check if the receiver exists
-    foreach (QString key, list)
+// Writes every shard to disk and then the snapshots the next start loads without parsing JSON
+bool DataBaseHandler::prepareRestart()
+{
+    if (!checkpoint())
     {
-        QString number = DataBaseObj.value(key).toObject().value("AccountNumber").toString();
-        if (number == data.value("ReceiverAccountNumber").toString())
-        {
-            receiverFound = true;
-            break;
-        }
+        DBLogs->log("Final checkpoint failed; the next start loads the JSON files.", Logger::Warning);
+        return false;
     }
 
-    // Receiver not found
-    if (!receiverFound)
+    bool result = true;
+    for (const auto &shard : shards)
     {
-        DBLogs->log("User: " + data.value("ReceiverAccountNumber").toString() + " receiver not found.");
-        jResponse["State"] = false;
-        jResponse["Reason"] = -1; // Receiver account not found
-        return jResponse;
+        result = shard->writeRestartSnapshot() && result;
     }
 
-    // Transfer amount: Call makeTransaction twice (once for sender and once for receiver)
-    QJsonObject senderObj;
-    double senderAmount = data.value("Amount").toString().toDouble() * (-1); // Amount to be subtracted from sender
-    senderObj["AccountNumber"] = data.value("SenderAccountNumber").toString();
-    senderObj["Amount"] = QString::number(senderAmount);
-
-    QJsonObject senderTransResponseObj = makeTransaction(senderObj);
+    DBLogs->log(result ? "Restart snapshots written." : "Some restart snapshots could not be written.");
+    return result;
+}
 
-    // Check if the sender transaction was successful
-    if (!(senderTransResponseObj.value("State").toBool()))
+// Registers the change record callback on every shard
+void DataBaseHandler::setMutationListener(std::function<void(const QJsonObject &)> listener)
+{
+    for (const auto &shard : shards)
     {
-        DBLogs->log("Sender transaction failed.");
-        jResponse["State"] = false;
-        jResponse["Reason"] = senderTransResponseObj.value("Reason").toString();
-        return jResponse;
+        shard->setMutationListener(listener);
     }
+}
 
-    QJsonObject receiverObj;
-    receiverObj["AccountNumber"] = data.value("ReceiverAccountNumber").toString();
-    receiverObj["Amount"] = data.value("Amount").toString();
+// Applies a record streamed by the replication leader.
+// Records carry the whole account, so applying one twice leaves the same state.
+void DataBaseHandler::applyReplication(const QJsonObject &record)
+{
+    QString op = record.value("Op").toString();
+
+    if (op == "Store")
+    {
+        QString userName = record.value("UserName").toString();
+        QJsonObject account = record.value("Account").toObject();
+        QString accountNumber = account.value("AccountNumber").toString();
 
-    QJsonObject receiverTransResponseObj = makeTransaction(receiverObj);
+        shardFor(accountNumber)->insertAccount(userName, account);
 
-    // Check if the receiver transaction was successful
-    if (!(receiverTransResponseObj.value("State").toBool()))
+        QWriteLocker locker(&directoryLock);
+        userDirectory.insert(userName, accountNumber);
+        usedAccountNumbers.insert(accountNumber);
+    }
+    else if (op == "Erase")
     {
-        DBLogs->log("Receiver transaction failed.");
-        jResponse["State"] = false;
-        jResponse["Reason"] = receiverTransResponseObj.value("Reason").toString();
-        return jResponse;
+        QString userName = record.value("UserName").toString();
+        QString accountNumber = record.value("AccountNumber").toString();
+
+        shardFor(accountNumber)->removeAccount(userName);
+
+        // A rename arrives as an erase followed by a store, which adds the account number back
+        QWriteLocker locker(&directoryLock);
+        userDirectory.remove(userName);
+        usedAccountNumbers.remove(accountNumber);
     }
+    else if (op == "Snapshot")
+    {
+        QJsonObject database = record.value("DataBase").toObject();
 
-    DBLogs->log("Transfer done successful.");
-    jResponse["State"] = true; // Transfer successful
-    return jResponse;
+        // Drop the local accounts the leader does not have under the same username and account number,
+        // then store all of the leader's accounts. An account whose number changed would otherwise stay
+        // in its old shard, next to the leader's account stored in the shard of the new number.
+        for (const auto &shard : shards)
+        {
+            QJsonObject table = shard->snapshot();
+            for (auto it = table.constBegin(); it != table.constEnd(); ++it)
+            {
+                QString localNumber = it.value().toObject().value("AccountNumber").toString();
+                if (!database.contains(it.key())
+                    || (database.value(it.key()).toObject().value("AccountNumber").toString() != localNumber))
+                {
+                    shard->removeAccount(it.key());
+                }
+            }
+        }
+        for (auto it = database.constBegin(); it != database.constEnd(); ++it)
+        {
+            QJsonObject account = it.value().toObject();
+            shardFor(account.value("AccountNumber").toString())->insertAccount(it.key(), account);
+        }
+
+        // Rebuild the directory from the new shard contents
+        {
+            QWriteLocker locker(&directoryLock);
+            userDirectory.clear();
+            usedAccountNumbers.clear();
+        }
+        buildDirectory();
+        DBLogs->log("Replica loaded a snapshot of " + QString::number(database.size()) + " accounts.");
+    }
+}
+
+// Marks the database as a read-only replica
+void DataBaseHandler::setReadOnly(bool value)
+{
+    readOnly = value;
+}
+
+// Returns true if the database is a read-only replica
+bool DataBaseHandler::isReadOnly() const
+{
+    return readOnly;
 }
@@ -1,22 +1,47 @@
 #ifndef DATABASEHANDLER_H
 #define DATABASEHANDLER_H
 
-#include <QTextStream>       // Includes the QTextStream class for text stream operations
 #include <QByteArray>        // Includes the QByteArray class for handling byte arrays
 #include <QJsonDocument>     // Includes the QJsonDocument class for handling JSON documents
 #include <QJsonObject>       // Includes the QJsonObject class for handling JSON objects
 #include <QJsonArray>        // Includes the QJsonArray class for handling JSON arrays
-#include <QJsonParseError>   // Includes the QJsonParseError class for handling JSON parse errors
 #include <QFile>             // Includes the QFile class for file handling
+#include <QDir>              // Includes the QDir class for finding leftover shard files
+#include <QHash>             // Includes the QHash class for the username directory
+#include <QSet>              // Includes the QSet class for the set of used account numbers
+#include <QReadWriteLock>    // Includes the QReadWriteLock class for protecting the username directory
 #include <QRandomGenerator>  // Includes the QRandomGenerator class for random number generation
 #include <memory>            // Includes smart pointers such as std::unique_ptr
+#include <vector>            // Includes std::vector for the list of shards and the merged balance queries
+#include <algorithm>         // Includes std::sort for merging the balance queries of the shards
+#include <atomic>            // Includes std::atomic for the transfer ID counter and the read-only flag
+#include <functional>        // Includes std::function for the mutation listener
 #include <QDebug>            // Includes the QDebug class for logging and debugging
 #include "Logger.h"
+#include "DataBaseShard.h"
+#include "ChangeLog.h"
+#include "JsonFileEngine.h"
+#include "MemoryEngine.h"
+#include "SqliteEngine.h"
+#include "PasswordHasher.h"
+#include "SessionManager.h"
 
 // The DataBaseHandler class is responsible for managing database operations, including user authentication,
 // user creation, user updates, user deletion, and handling various database queries.
+// The account space is partitioned into shards by a hash of the account number; the handler
+// routes every operation to the shard owning the account and keeps a username directory
+// for the operations that identify a user by name.
 class DataBaseHandler
 {
+public:
+    // Storage engines the shards can be kept in.
+    enum StorageKind
+    {
+        JsonStorage,   // One JSON file per shard, rewritten at every checkpoint (the default).
+        MemoryStorage, // Nothing is stored; every start begins with the default users.
+        SqliteStorage  // One SQLite database per shard, updated per changed account.
+    };
+
 private:
     // Constructor to initialize the DataBaseHandler object.
     DataBaseHandler();
@@ -24,17 +49,63 @@ private:
     // Method to initialize the database.
     void initilaize();
 
-    // Method to check the integrity of the database.
-    bool CheckDataBase(QJsonObject &jResponse, QJsonParseError &jError, QJsonDocument &doc);
+    // Method to get the shard owning an account number.
+    DataBaseShard *shardFor(const QString &accountNumber) const;
+
+    // Method to create the storage engine of a shard.
+    std::unique_ptr<StorageEngine> createEngine(qint32 shardID) const;
+
+    // Method to move the accounts of a legacy or leftover database file into their shards.
+    bool migrateFile(const QString &fileName);
+
+    // Method to move accounts stored in the wrong shard after the shard count changed.
+    void rebalanceShards();
+
+    // Method to fill the username directory from the shards.
+    void buildDirectory();
+
+    // Method to build the viewBankDB response holding only the accounts of the changed usernames.
+    QJsonObject viewBankDBChanges(const QSet<QString> &changed, quint64 version);
+
+    // Method to run a balance query on every shard and merge the sorted results into one list.
+    QJsonObject mergeBalanceQuery(double minBalance, double maxBalance, qint32 count, bool descending);
+
+    // Number of shards used by the next DataBaseHandler instance.
+    static qint32 shardCount;
+
+    // Directory holding the shard files.
+    static QString dataDirectory;
+
+    // Storage engine used by the next DataBaseHandler instance.
+    static StorageKind storageKind;
+
+    // Log numbering the changes of all shards; declared before the shards, which write to it.
+    ChangeLog changeLog;
+
+    // Shards holding the accounts.
+    std::vector<std::unique_ptr<DataBaseShard>> shards;
+
+    // Directory from username to account number, covering all shards.
+    QHash<QString, QString> userDirectory;
+
+    // Account numbers in use across all shards.
+    QSet<QString> usedAccountNumbers;
+
+    // Lock protecting userDirectory and usedAccountNumbers.
+    QReadWriteLock directoryLock;
 
-    // Smart pointer to manage the QFile instance for the database file.
-    std::unique_ptr<QFile> DataBaseFile;
+    // Counter for the IDs of two-phase transfers.
+    std::atomic<quint64> nextTransferID;
+
+    // Set when the database is a read-only replica of a replication leader.
+    std::atomic<bool> readOnly;
 
     // Instance of QRandomGenerator for generating random numbers.
     QRandomGenerator randomNumGen;
 
-    // Static variable for user ID generation.
-    // static qint16 userID;
+    // Upper bound (exclusive) of the account numbers and number of random picks before createUser gives up.
+    static constexpr qint32 accountNumberLimit = 100000000;
+    static constexpr qint32 accountNumberAttempts = 64;
 
 public:
     // Destructor to clean up resources.
@@ -43,6 +114,16 @@ public:
     // Method to get the singleton instance of DataBaseHandler.
     static std::shared_ptr<DataBaseHandler> getInstance();
 
+    // Method to set the number of shards; must be called before the first getInstance().
+    static void setShardCount(qint32 count);
+
+    // Method to set the directory of the shard files; must be called before the first getInstance().
+    static void setDataDirectory(const QString &directory);
+
+    // Method to set the storage engine of the shards; must be called before the first getInstance().
+    // Accounts stored in another format are moved into the new one on start-up.
+    static void setStorageEngine(StorageKind kind);
+
     // Delete the copy constructor to prevent copying.
     DataBaseHandler(const DataBaseHandler&) = delete;
 
@@ -54,13 +135,58 @@ public:
     QJsonObject createUser(QJsonObject &data);
     QJsonObject updateUser(const QJsonObject &data);
     QJsonObject deleteUser(const QJsonObject &data);
-    QJsonObject viewBankDB();
+    QJsonObject viewBankDB(const QJsonObject &data = QJsonObject());
     QJsonObject getAccount_Number(const QJsonObject &data);
     QJsonObject viewAccount_Balance(const QJsonObject &data);
     QJsonObject viewTransaction_History(const QJsonObject &data);
     QJsonObject makeTransaction(const QJsonObject &data);
     QJsonObject transferAmount(const QJsonObject &data);
 
+    // Method to answer a summary request from the running totals of the shards, at a cost independent
+    // of the number of accounts: account and admin counts, the total balance and per-day totals.
+    QJsonObject summary(const QJsonObject &data);
+
+    // Methods to list accounts by balance from the balance indexes of the shards, in O(log n + k):
+    // topAccounts returns the "Count" richest accounts, or the poorest ones with "Bottom": true (or "true");
+    // balanceRange returns the accounts with a balance from "MinBalance" to "MaxBalance", lowest first.
+    QJsonObject topAccounts(const QJsonObject &data);
+    QJsonObject balanceRange(const QJsonObject &data);
+
+    // Method to find accounts by the start ("Mode": "Prefix", the default) or any part ("Mode": "Substring")
+    // of their "UserName" or "FullName" ("Field", both by default) with the search indexes of the shards.
+    // Returns at most "Count" accounts (100 by default), sorted by username.
+    QJsonObject search(const QJsonObject &data);
+
+    // Methods to run a batch of requests: early checkpoints are held back between
+    // beginBatch() and endBatch(), so the shards write the whole batch once.
+    void beginBatch();
+    void endBatch();
+
+    // Method to apply a list of MakeTransaction and TransferAmount requests all together or not at all.
+    QJsonObject transactBatch(const QJsonArray &requests);
+
+    // Method to write a snapshot of every shard to disk if it has pending changes.
+    bool checkpoint();
+
+    // Method to set the checkpoint interval and the change count that triggers an early checkpoint.
+    void configureCheckpoint(qint32 intervalMs, qint32 maxPendingChanges);
+
+    // Method to set the number of changes remembered for clients syncing their copy of the database.
+    void configureChangeLog(qint32 entries);
+
+    // Method to write a final checkpoint and the restart snapshots, called on shutdown once no request runs.
+    bool prepareRestart();
+
+    // Method to register a callback receiving a change record for every account stored or erased.
+    void setMutationListener(std::function<void(const QJsonObject &)> listener);
+
+    // Method to apply a change record or a full snapshot streamed by the replication leader.
+    void applyReplication(const QJsonObject &record);
+
+    // Methods to mark the database as a read-only replica and to query it.
+    void setReadOnly(bool value);
+    bool isReadOnly() const;
+
     Logger *DBLogs;
 };
 
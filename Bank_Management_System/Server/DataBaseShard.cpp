@@ -0,0 +1,921 @@
+#include "DataBaseShard.h"
+
+// Constructor: Loads the shard from its storage engine and starts its executor and checkpoint threads
+DataBaseShard::DataBaseShard(qint32 shardID, std::unique_ptr<StorageEngine> engine, ChangeLog *changes, Logger *logs)
+    : id{shardID}, storage{std::move(engine)}, loadReason{0}, pendingChanges{0}, deferredCheckpoints{0},
+      changeLog{changes}, DBLogs{logs}
+{
+    subscriptions = SubscriptionManager::getInstance();
+    loadReason = storage->load(accounts);
+
+    // Build the account number and history indexes of the loaded accounts
+    for (auto it = accounts.constBegin(); it != accounts.constEnd(); ++it)
+    {
+        QJsonObject account = it.value().toObject();
+        QString accountNumber = account.value("AccountNumber").toString();
+        accountIndex.insert(accountNumber, it.key());
+        indexHistory(accountNumber, account);
+        updateAggregates(QJsonObject(), account);
+        updateBalanceIndex(QJsonObject(), account);
+        searchIndex.insert(accountNumber, it.key(), account.value("FullName").toString());
+    }
+    DBLogs->log("Shard " + QString::number(id) + " loaded with " + QString::number(accounts.size()) + " accounts.");
+
+    // A single thread that never expires executes the shard's operations in order
+    executor.setMaxThreadCount(1);
+    executor.setExpiryTimeout(-1);
+
+    // Persist the in-memory account table in the background
+    checkpointer = std::make_unique<Checkpointer>(this);
+    checkpointer->start();
+}
+
+// Destructor: Finishes the queued operations, stops the checkpoint thread and writes any pending changes
+DataBaseShard::~DataBaseShard()
+{
+    executor.waitForDone();
+    checkpointer->stop();
+    checkpoint();
+}
+
+// Returns the file name of a shard
+QString DataBaseShard::shardFileName(qint32 shardID, const QString &suffix)
+{
+    return "BankDataBase_" + QString::number(shardID) + "." + suffix;
+}
+
+// Returns the index of the shard owning an account number.
+// qChecksum is used instead of qHash because qHash is seeded per process,
+// and an account must map to the same shard file on every start and in the bulk tool.
+qint32 DataBaseShard::shardOf(const QString &accountNumber, qint32 shardCount)
+{
+    quint16 hash = qChecksum(accountNumber.toUtf8());
+    return hash % shardCount;
+}
+
+// Checks if the storage engine found stored data when the shard was created
+bool DataBaseShard::hasStoredData() const
+{
+    return storage->exists();
+}
+
+// Returns a copy of the account table; the copy is implicitly shared and costs nothing until modified
+QJsonObject DataBaseShard::snapshot()
+{
+    QMutexLocker locker(&stateMutex);
+    return accounts;
+}
+
+// Checks that the shard was loaded and fills the response with the load failure otherwise
+bool DataBaseShard::CheckDataBase(QJsonObject &jResponse)
+{
+    if (loadReason != 0)
+    {
+        jResponse["State"] = false;
+        jResponse["Reason"] = loadReason; // Reason recorded while loading the file
+        return false;
+    }
+    return true;
+}
+
+// Stores an account in the table and the index and marks a pending change
+void DataBaseShard::storeAccount(const QString &userName, const QJsonObject &account)
+{
+    // Runs on the executor thread, the only thread modifying the table and the indexes
+    QJsonObject previous = accounts.value(userName).toObject();
+    updateAggregates(previous, account);
+    updateBalanceIndex(previous, account);
+
+    qint32 pending;
+    {
+        // Modify the table in place; it only detaches while a checkpoint holds a snapshot
+        QMutexLocker locker(&stateMutex);
+        accounts.insert(userName, account);
+        changedUsers.insert(userName);
+        pending = ++pendingChanges;
+    }
+
+    // Numbered once the table holds the new version, so a client syncing to this number sees it
+    changeLog->record(userName);
+    accountIndex.insert(account.value("AccountNumber").toString(), userName);
+    indexHistory(account.value("AccountNumber").toString(), account);
+
+    // Transactions leave the names alone, so most changes skip the search index
+    if (!searchIndex.contains(account.value("AccountNumber").toString(), userName, account.value("FullName").toString()))
+    {
+        searchIndex.insert(account.value("AccountNumber").toString(), userName, account.value("FullName").toString());
+    }
+
+    // Push the new transactions to the connections watching the account; accounts that were just
+    // created or moved between shards have no previous version and send nothing
+    QJsonArray history = account.value("TransactionHistory").toArray();
+    qint32 known = static_cast<qint32>(previous.value("TransactionHistory").toArray().size());
+    if (!previous.isEmpty() && (history.size() > known))
+    {
+        QJsonArray transactions;
+        for (qint32 i = known; i < history.size(); i++)
+        {
+            transactions.append(history.at(i));
+        }
+        subscriptions->publish(account.value("AccountNumber").toString(), account.value("AccountBalance").toString(), transactions);
+    }
+
+    // Report the change, e.g. to the replication leader
+    if (mutationListener)
+    {
+        QJsonObject record;
+        record["Op"] = "Store";
+        record["UserName"] = userName;
+        record["Account"] = account;
+        mutationListener(record);
+    }
+
+    // Wake the checkpoint thread early once enough changes have piled up, unless a batch is running
+    if ((pending >= checkpointer->maxPendingChanges()) && (deferredCheckpoints == 0))
+    {
+        checkpointer->requestCheckpoint();
+    }
+}
+
+// Removes an account from the table and the index and marks a pending change
+void DataBaseShard::eraseAccount(const QString &userName)
+{
+    QJsonObject previous = accounts.value(userName).toObject();
+    updateAggregates(previous, QJsonObject());
+    updateBalanceIndex(previous, QJsonObject());
+
+    qint32 pending;
+    QString accountNumber;
+    {
+        QMutexLocker locker(&stateMutex);
+        accountNumber = accounts.value(userName).toObject().value("AccountNumber").toString();
+        accounts.remove(userName);
+        changedUsers.insert(userName);
+        pending = ++pendingChanges;
+    }
+    changeLog->record(userName);
+    accountIndex.remove(accountNumber);
+    historyIndex.remove(accountNumber);
+    searchIndex.remove(accountNumber);
+
+    if (mutationListener)
+    {
+        QJsonObject record;
+        record["Op"] = "Erase";
+        record["UserName"] = userName;
+        record["AccountNumber"] = accountNumber;
+        mutationListener(record);
+    }
+
+    if ((pending >= checkpointer->maxPendingChanges()) && (deferredCheckpoints == 0))
+    {
+        checkpointer->requestCheckpoint();
+    }
+}
+
+// Appends a deposit or withdrawal record to an account and updates its balance
+void DataBaseShard::applyTransaction(const QString &userName, double amount, const QString &type)
+{
+    QJsonObject desiredObj = accounts.value(userName).toObject();
+    double newBalance = desiredObj.value("AccountBalance").toString().toDouble() + amount;
+    desiredObj["AccountBalance"] = QString::number(newBalance);
+
+    // Timestamps never go back within a history, even if the clock does, so the time index stays sorted
+    QDateTime now = QDateTime::currentDateTime();
+    qint64 timestamp = now.toMSecsSinceEpoch();
+    const HistoryIndex &index = historyIndex[desiredObj.value("AccountNumber").toString()];
+    if (!index.times.isEmpty())
+    {
+        timestamp = qMax(timestamp, index.times.last());
+    }
+
+    // Create a new transaction record; Date and Time are kept for display
+    QJsonArray transactionHistory = desiredObj.value("TransactionHistory").toArray();
+    QJsonObject transaction;
+    transaction["Timestamp"] = timestamp;
+    transaction["Date"] = now.toString("dd-MM-yyyy");
+    transaction["Time"] = now.toString("hh:mm:ss");
+    transaction["Type"] = !type.isEmpty() ? type : ((amount > 0) ? "Deposit" : "Withdraw");
+    transaction["Amount"] = QString::number(amount);
+    transactionHistory.append(transaction); // Append new transaction
+
+    desiredObj["TransactionHistory"] = transactionHistory;
+    storeAccount(userName, desiredObj);
+}
+
+// Replaces the contribution of an account's previous version to the aggregates by the new one
+void DataBaseShard::updateAggregates(const QJsonObject &previous, const QJsonObject &account)
+{
+    if (!previous.isEmpty())
+    {
+        aggregates.accounts--;
+        aggregates.admins -= previous.value("IsAdmin").toBool() ? 1 : 0;
+        aggregates.totalBalance -= previous.value("AccountBalance").toString().toDouble();
+    }
+    if (!account.isEmpty())
+    {
+        aggregates.accounts++;
+        aggregates.admins += account.value("IsAdmin").toBool() ? 1 : 0;
+        aggregates.totalBalance += account.value("AccountBalance").toString().toDouble();
+    }
+
+    // Histories only grow, so usually just the new entries are added. A shorter history was replaced
+    // or belongs to an erased account, and its old entries are taken out of the totals.
+    QJsonArray previousHistory = previous.value("TransactionHistory").toArray();
+    QJsonArray history = account.value("TransactionHistory").toArray();
+    if (history.size() >= previousHistory.size())
+    {
+        addToDays(history, static_cast<qint32>(previousHistory.size()), 1);
+    }
+    else
+    {
+        addToDays(previousHistory, 0, -1);
+        addToDays(history, 0, 1);
+    }
+}
+
+// Replaces the balance index entry of an account's previous version by the one of its new version
+void DataBaseShard::updateBalanceIndex(const QJsonObject &previous, const QJsonObject &account)
+{
+    if (!previous.isEmpty())
+    {
+        balanceIndex.erase({previous.value("AccountBalance").toString().toDouble(), previous.value("AccountNumber").toString()});
+    }
+    if (!account.isEmpty())
+    {
+        balanceIndex.insert({account.value("AccountBalance").toString().toDouble(), account.value("AccountNumber").toString()});
+    }
+}
+
+// Adds or removes the history entries from position first on to the per-day totals
+void DataBaseShard::addToDays(const QJsonArray &history, qint32 first, qint32 sign)
+{
+    for (qint32 i = first; i < history.size(); i++)
+    {
+        QJsonObject transaction = history.at(i).toObject();
+        QDate day = QDateTime::fromMSecsSinceEpoch(transactionTime(transaction)).date();
+        double amount = transaction.value("Amount").toString().toDouble();
+
+        DayTotals &totals = aggregates.days[day];
+        if (amount > 0)
+        {
+            totals.deposits += sign * amount;
+        }
+        else
+        {
+            totals.withdrawals -= sign * amount;
+        }
+        totals.transactions += sign;
+
+        // Days left without transactions are dropped so the totals only cover the stored histories
+        if (totals.transactions == 0)
+        {
+            aggregates.days.remove(day);
+        }
+    }
+}
+
+// Indexes the history entries appended since the account was last indexed.
+// A history that got shorter was replaced, e.g. by a replication snapshot, and is indexed again.
+void DataBaseShard::indexHistory(const QString &accountNumber, const QJsonObject &account)
+{
+    QJsonArray history = account.value("TransactionHistory").toArray();
+    HistoryIndex &index = historyIndex[accountNumber];
+    if (history.size() < index.times.size())
+    {
+        index = HistoryIndex();
+    }
+
+    for (qint32 i = static_cast<qint32>(index.times.size()); i < history.size(); i++)
+    {
+        QJsonObject transaction = history.at(i).toObject();
+
+        // Older entries only have second precision, so equal times are common; they must not go back
+        qint64 time = transactionTime(transaction);
+        if (!index.times.isEmpty())
+        {
+            time = qMax(time, index.times.last());
+        }
+        index.times.append(time);
+        index.byType[transaction.value("Type").toString()].append(i);
+    }
+}
+
+// Returns the time of a history entry in milliseconds since the epoch
+qint64 DataBaseShard::transactionTime(const QJsonObject &transaction)
+{
+    if (transaction.contains("Timestamp"))
+    {
+        return transaction.value("Timestamp").toInteger();
+    }
+
+    QDateTime time = QDateTime::fromString(transaction.value("Date").toString() + " " + transaction.value("Time").toString(),
+                                           "dd-MM-yyyy hh:mm:ss");
+    return time.isValid() ? time.toMSecsSinceEpoch() : 0;
+}
+
+// Reads a time filter; request fields are usually strings, but numbers are accepted as well
+qint64 DataBaseShard::epochValue(const QJsonValue &value, qint64 defaultValue)
+{
+    if (value.isDouble())
+    {
+        return value.toInteger();
+    }
+
+    bool ok;
+    qint64 epoch = value.toString().toLongLong(&ok);
+    return ok ? epoch : defaultValue;
+}
+
+// Returns the amount held by prepared withdrawals of an account
+double DataBaseShard::heldAmount(const QString &accountNumber) const
+{
+    double held = 0;
+    for (const Hold &hold : holds)
+    {
+        if ((hold.accountNumber == accountNumber) && (hold.amount < 0))
+        {
+            held += hold.amount;
+        }
+    }
+    return held;
+}
+
+// Adds a whole account to the shard
+QJsonObject DataBaseShard::insertAccount(const QString &userName, const QJsonObject &account)
+{
+    return execute([&]() {
+        QJsonObject jResponse;
+        if (!CheckDataBase(jResponse))
+        {
+            return jResponse; // Return response indicating failure
+        }
+
+        storeAccount(userName, account);
+        jResponse["State"] = true;
+        return jResponse;
+    });
+}
+
+// Removes a whole account from the shard and returns it in the response
+QJsonObject DataBaseShard::removeAccount(const QString &userName)
+{
+    return execute([&]() {
+        QJsonObject jResponse;
+        if (!CheckDataBase(jResponse))
+        {
+            return jResponse; // Return response indicating failure
+        }
+
+        jResponse["Account"] = accounts.value(userName).toObject();
+        eraseAccount(userName);
+        jResponse["State"] = true;
+        return jResponse;
+    });
+}
+
+// Returns the stored account of a user, used by the login to check the password outside the executor thread
+QJsonObject DataBaseShard::findUser(const QString &userName)
+{
+    return execute([&]() {
+        QJsonObject jResponse;
+        if (!CheckDataBase(jResponse))
+        {
+            return jResponse; // Return response indicating failure
+        }
+
+        // Check if the user exists in the shard
+        if (!accounts.contains(userName))
+        {
+            DBLogs->log("Incorrect Username.");
+            jResponse["State"] = false;
+            jResponse["Reason"] = -1; // User not found
+            return jResponse;
+        }
+
+        jResponse["State"] = true;
+        jResponse["Account"] = accounts.value(userName).toObject();
+        return jResponse;
+    });
+}
+
+// Returns the stored accounts of several users, used to send the accounts changed since a version
+QJsonObject DataBaseShard::findUsers(const QStringList &userNames)
+{
+    return execute([&]() {
+        QJsonObject jResponse;
+        if (!CheckDataBase(jResponse))
+        {
+            return jResponse; // Return response indicating failure
+        }
+
+        QJsonObject found;
+        for (const QString &userName : userNames)
+        {
+            if (accounts.contains(userName))
+            {
+                found[userName] = accounts.value(userName);
+            }
+        }
+
+        jResponse["State"] = true;
+        jResponse["Accounts"] = found;
+        return jResponse;
+    });
+}
+
+// Replaces the stored password of a user, e.g. to upgrade a plaintext password to a hash
+bool DataBaseShard::updatePassword(const QString &userName, const QString &passwordHash)
+{
+    return execute([&]() {
+        if (!accounts.contains(userName))
+        {
+            return false;
+        }
+
+        QJsonObject userObj = accounts.value(userName).toObject();
+        userObj["Password"] = passwordHash;
+        storeAccount(userName, userObj);
+        return true;
+    });
+}
+
+// Updates an existing user's information; the new username was already reserved by the caller
+QJsonObject DataBaseShard::updateUser(const QJsonObject &data, QString &oldUserName)
+{
+    return execute([&]() {
+        QJsonObject jResponse;
+        if (!CheckDataBase(jResponse))
+        {
+            return jResponse; // Return response indicating failure
+        }
+
+        // Search for the user with the specified account number
+        QString accountNumber = data.value("AccountNumber").toString();
+        if (!accountIndex.contains(accountNumber))
+        {
+            DBLogs->log("User: " + accountNumber + " not found.");
+            jResponse["State"] = false;
+            jResponse["Reason"] = -1; // User not found in database
+            return jResponse;
+        }
+
+        oldUserName = accountIndex.value(accountNumber);
+        QJsonObject desiredObj = accounts.value(oldUserName).toObject();
+        desiredObj["IsAdmin"] = data.value("IsAdmin").toBool(); // Update admin status
+
+        // Update other fields if provided
+        if (!data.value("FullName").toString().isEmpty())
+        {
+            desiredObj["FullName"] = data.value("FullName").toString();
+        }
+        if (!data.value("Password").toString().isEmpty())
+        {
+            desiredObj["Password"] = data.value("Password").toString();
+        }
+        if (!data.value("Age").toString().isEmpty())
+        {
+            desiredObj["Age"] = data.value("Age").toString();
+        }
+
+        if (!data.value("UserName").toString().isEmpty())
+        {
+            eraseAccount(oldUserName); // Remove old username
+            storeAccount(data.value("UserName").toString(), desiredObj); // Store under the new username
+        }
+        else
+        {
+            storeAccount(oldUserName, desiredObj); // Just update the existing username
+        }
+
+        DBLogs->log("User: " + accountNumber + " updated successfully.");
+        jResponse["State"] = true; // Indicate successful update
+        return jResponse;
+    });
+}
+
+// Deletes a user from the shard and returns its username
+QJsonObject DataBaseShard::deleteUser(const QString &accountNumber, QString &userName)
+{
+    return execute([&]() {
+        QJsonObject jResponse;
+        if (!CheckDataBase(jResponse))
+        {
+            return jResponse; // Return response indicating failure
+        }
+
+        if (!accountIndex.contains(accountNumber))
+        {
+            DBLogs->log("User: " + accountNumber + " not found.");
+            jResponse["State"] = false;
+            jResponse["Reason"] = -1; // User not found in database
+            return jResponse;
+        }
+
+        // Keep the account until the transfers holding an amount on it are finished
+        for (const Hold &hold : holds)
+        {
+            if (hold.accountNumber == accountNumber)
+            {
+                DBLogs->log("User: " + accountNumber + " has a transfer in progress.");
+                jResponse["State"] = false;
+                jResponse["Reason"] = -2; // Transfer in progress
+                return jResponse;
+            }
+        }
+
+        userName = accountIndex.value(accountNumber);
+        eraseAccount(userName); // Remove the user
+
+        DBLogs->log("User: " + accountNumber + " deleted successfully.");
+        jResponse["State"] = true; // Indicate successful deletion
+        return jResponse;
+    });
+}
+
+// Retrieves the balance of a given account number
+QJsonObject DataBaseShard::viewAccount_Balance(const QJsonObject &data)
+{
+    return execute([&]() {
+        QJsonObject jResponse;
+        if (!CheckDataBase(jResponse))
+        {
+            return jResponse; // Return response indicating failure
+        }
+
+        QString accountNumber = data.value("AccountNumber").toString();
+        if (!accountIndex.contains(accountNumber))
+        {
+            DBLogs->log("User: " + accountNumber + " not found.");
+            jResponse["State"] = false;
+            jResponse["Reason"] = -1; // Account number not found
+            return jResponse;
+        }
+
+        QJsonObject desiredObj = accounts.value(accountIndex.value(accountNumber)).toObject();
+        jResponse["AccountBalance"] = desiredObj.value("AccountBalance"); // Retrieve and return the balance
+        DBLogs->log("Return balance of the user.");
+        jResponse["State"] = true;
+        return jResponse;
+    });
+}
+
+// Retrieves the transaction history for a given account number
+QJsonObject DataBaseShard::viewTransaction_History(const QJsonObject &data)
+{
+    return execute([&]() {
+        QJsonObject jResponse;
+        if (!CheckDataBase(jResponse))
+        {
+            return jResponse; // Return response indicating failure
+        }
+
+        QString accountNumber = data.value("AccountNumber").toString();
+        if (!accountIndex.contains(accountNumber))
+        {
+            DBLogs->log("User: " + accountNumber + " not found.");
+            jResponse["State"] = false;
+            jResponse["Reason"] = -1; // Account number not found
+            return jResponse;
+        }
+
+        QJsonObject desiredObj = accounts.value(accountIndex.value(accountNumber)).toObject();
+        QJsonArray transHistory = desiredObj.value("TransactionHistory").toArray(); // Retrieve transaction history
+        if (transHistory.isEmpty())
+        {
+            DBLogs->log("No transactions history of the user found.");
+            jResponse["State"] = false;
+            jResponse["Reason"] = -2; // No transactions found
+            return jResponse;
+        }
+
+        // Narrow the history down to the requested time range with the time index
+        const HistoryIndex &index = historyIndex[accountNumber];
+        qint64 from = epochValue(data.value("From"), std::numeric_limits<qint64>::min());
+        qint64 to = epochValue(data.value("To"), std::numeric_limits<qint64>::max());
+        qint32 begin = static_cast<qint32>(std::lower_bound(index.times.begin(), index.times.end(), from) - index.times.begin());
+        qint32 end = static_cast<qint32>(std::upper_bound(index.times.begin(), index.times.end(), to) - index.times.begin());
+
+        // The cursor is the position of the oldest entry of the previous page
+        if (data.contains("Cursor"))
+        {
+            end = qMin(end, qMax(data.value("Cursor").toString().toInt(), 0));
+        }
+
+        // With a type, only the positions of that type between begin and end are visited
+        QString type = data.value("Type").toString();
+        const QVector<qint32> typePositions = index.byType.value(type);
+        qint32 low = begin;
+        qint32 high = end;
+        if (!type.isEmpty())
+        {
+            low = static_cast<qint32>(std::lower_bound(typePositions.begin(), typePositions.end(), begin) - typePositions.begin());
+            high = static_cast<qint32>(std::lower_bound(typePositions.begin(), typePositions.end(), end) - typePositions.begin());
+        }
+        auto positionAt = [&](qint32 k) { return type.isEmpty() ? k : typePositions.at(k); };
+
+        // Retrieve the most recent matching transactions up to the specified count (0: all of them)
+        QJsonArray newArr;
+        int count = data.value("Count").toString().toInt(); // Number of transactions to retrieve
+        qint32 k = high;
+        while ((k > low) && ((count <= 0) || (newArr.size() < count)))
+        {
+            k--;
+            QJsonObject transaction = transHistory.at(positionAt(k)).toObject();
+            transaction["Timestamp"] = index.times.at(positionAt(k)); // Also set for entries stored without one
+            newArr.append(transaction);
+        }
+
+        // More matching entries are left for the next page
+        if (k > low)
+        {
+            jResponse["NextCursor"] = QString::number(positionAt(k));
+        }
+
+        DBLogs->log("Return transactions history of the user.");
+        jResponse["Transactions"] = newArr;
+        jResponse["State"] = true;
+        return jResponse;
+    });
+}
+
+// Performs a transaction (deposit or withdrawal) on a given account
+QJsonObject DataBaseShard::makeTransaction(const QJsonObject &data)
+{
+    return execute([&]() {
+        QJsonObject jResponse;
+        if (!CheckDataBase(jResponse))
+        {
+            return jResponse; // Return response indicating failure
+        }
+
+        QString accountNumber = data.value("AccountNumber").toString();
+        if (!accountIndex.contains(accountNumber))
+        {
+            DBLogs->log("User: " + accountNumber + " not found.");
+            jResponse["State"] = false;
+            jResponse["Reason"] = -1; // Account number not found
+            return jResponse;
+        }
+
+        QString userName = accountIndex.value(accountNumber);
+        double oldBalance = accounts.value(userName).toObject().value("AccountBalance").toString().toDouble();
+        double amount = data.value("Amount").toString().toDouble();
+
+        // Check if the new balance is non-negative, counting amounts held by pending transfers
+        if (oldBalance + heldAmount(accountNumber) + amount < 0)
+        {
+            DBLogs->log("Insufficient funds.");
+            jResponse["State"] = false;
+            jResponse["Reason"] = -2; // Insufficient funds
+            return jResponse;
+        }
+
+        applyTransaction(userName, amount);
+
+        DBLogs->log("Transaction done successful.");
+        jResponse["State"] = true; // Transaction successful
+        return jResponse;
+    });
+}
+
+// Returns the running totals of the shard, with the per-day totals of the requested days
+QJsonObject DataBaseShard::summary(const QJsonObject &data)
+{
+    return execute([&]() {
+        QJsonObject jResponse;
+        if (!CheckDataBase(jResponse))
+        {
+            return jResponse; // Return response indicating failure
+        }
+
+        QDate fromDate = QDate::fromString(data.value("FromDate").toString(), Qt::ISODate);
+        QDate toDate = QDate::fromString(data.value("ToDate").toString(), Qt::ISODate);
+
+        // The days are sorted, so the range starts with a binary search
+        QJsonObject days;
+        const QMap<QDate, DayTotals> &totals = aggregates.days;
+        auto it = fromDate.isValid() ? totals.lowerBound(fromDate) : totals.constBegin();
+        for (; (it != totals.constEnd()) && (!toDate.isValid() || (it.key() <= toDate)); ++it)
+        {
+            QJsonObject day;
+            day["Deposits"] = it.value().deposits;
+            day["Withdrawals"] = it.value().withdrawals;
+            day["Transactions"] = it.value().transactions;
+            days[it.key().toString(Qt::ISODate)] = day;
+        }
+
+        jResponse["Accounts"] = aggregates.accounts;
+        jResponse["Admins"] = aggregates.admins;
+        jResponse["TotalBalance"] = aggregates.totalBalance;
+        jResponse["Days"] = days;
+        jResponse["State"] = true;
+        return jResponse;
+    });
+}
+
+// Lists the accounts within a balance range, walking the balance index from one end of the range
+QJsonObject DataBaseShard::balanceQuery(double minBalance, double maxBalance, qint32 count, bool descending)
+{
+    return execute([&]() {
+        QJsonObject jResponse;
+        if (!CheckDataBase(jResponse))
+        {
+            return jResponse; // Return response indicating failure
+        }
+
+        // Two binary searches find the range; the empty account number sorts before every other one,
+        // and the next representable balance after the maximum ends the range after its last account
+        auto begin = balanceIndex.lower_bound({minBalance, QString()});
+        auto end = (maxBalance < minBalance) ? begin : balanceIndex.lower_bound({std::nextafter(maxBalance, std::numeric_limits<double>::infinity()), QString()});
+
+        QJsonArray list;
+        if (descending)
+        {
+            for (auto it = end; (it != begin) && ((count <= 0) || (list.size() < count)); )
+            {
+                list.append(publicAccount((--it)->second));
+            }
+        }
+        else
+        {
+            for (auto it = begin; (it != end) && ((count <= 0) || (list.size() < count)); ++it)
+            {
+                list.append(publicAccount(it->second));
+            }
+        }
+
+        jResponse["Accounts"] = list;
+        jResponse["State"] = true;
+        return jResponse;
+    });
+}
+
+// Finds accounts by a part of their names
+QJsonObject DataBaseShard::search(const QString &text, bool substring, SearchIndex::Field field, qint32 count)
+{
+    return execute([&]() {
+        QJsonObject jResponse;
+        if (!CheckDataBase(jResponse))
+        {
+            return jResponse; // Return response indicating failure
+        }
+
+        QStringList found = substring ? searchIndex.findSubstring(text, field, count)
+                                      : searchIndex.findPrefix(text, field, count);
+        QJsonArray list;
+        for (const QString &accountNumber : found)
+        {
+            list.append(publicAccount(accountNumber));
+        }
+
+        jResponse["Accounts"] = list;
+        jResponse["State"] = true;
+        return jResponse;
+    });
+}
+
+// Returns an account with its username but without its password and transaction history
+QJsonObject DataBaseShard::publicAccount(const QString &accountNumber) const
+{
+    QJsonObject account = accounts.value(accountIndex.value(accountNumber)).toObject();
+    account.remove("Password");
+    account.remove("TransactionHistory");
+    account["UserName"] = accountIndex.value(accountNumber);
+    return account;
+}
+
+// First phase of a transfer: checks the account and holds the amount
+QJsonObject DataBaseShard::prepareTransfer(quint64 transferID, const QString &accountNumber, double amount, const QString &type)
+{
+    return execute([&]() {
+        QJsonObject jResponse;
+        if (!CheckDataBase(jResponse))
+        {
+            return jResponse; // Return response indicating failure
+        }
+
+        if (!accountIndex.contains(accountNumber))
+        {
+            DBLogs->log("User: " + accountNumber + " not found.");
+            jResponse["State"] = false;
+            jResponse["Reason"] = -1; // Account number not found
+            return jResponse;
+        }
+
+        // A withdrawal must be covered by the balance minus what other transfers already hold
+        double balance = accounts.value(accountIndex.value(accountNumber)).toObject().value("AccountBalance").toString().toDouble();
+        if (balance + heldAmount(accountNumber) + amount < 0)
+        {
+            DBLogs->log("Insufficient funds.");
+            jResponse["State"] = false;
+            jResponse["Reason"] = -2; // Insufficient funds
+            return jResponse;
+        }
+
+        holds.insert(transferID, Hold{accountNumber, amount, type});
+        jResponse["State"] = true;
+        return jResponse;
+    });
+}
+
+// Second phase of a transfer: applies the held amount to the account
+bool DataBaseShard::commitTransfer(quint64 transferID)
+{
+    return execute([&]() {
+        if (!holds.contains(transferID))
+        {
+            return false;
+        }
+
+        Hold hold = holds.take(transferID);
+        if (!accountIndex.contains(hold.accountNumber))
+        {
+            DBLogs->log("User: " + hold.accountNumber + " disappeared before the transfer commit.");
+            return false;
+        }
+
+        applyTransaction(accountIndex.value(hold.accountNumber), hold.amount, hold.type);
+        return true;
+    });
+}
+
+// Releases the amount held by a transfer that could not complete
+bool DataBaseShard::abortTransfer(quint64 transferID)
+{
+    return execute([&]() {
+        return holds.remove(transferID) > 0;
+    });
+}
+
+// Registers the change record callback on the executor thread, which is the only thread calling it
+void DataBaseShard::setMutationListener(std::function<void(const QJsonObject &)> listener)
+{
+    execute([&]() {
+        mutationListener = listener;
+        return true;
+    });
+}
+
+// Writes a snapshot of the account table to disk if it changed since the last checkpoint
+bool DataBaseShard::checkpoint()
+{
+    // Only one checkpoint may write the file at a time
+    QMutexLocker checkpointLocker(&checkpointMutex);
+
+    QJsonObject snapshot;
+    QSet<QString> changed;
+    qint32 pending;
+    {
+        // Take a copy-on-write snapshot; the executor detaches on its next modification
+        QMutexLocker locker(&stateMutex);
+        if (pendingChanges == 0)
+        {
+            return true; // Nothing changed since the last checkpoint
+        }
+        snapshot = accounts;
+        changed.swap(changedUsers);
+        pending = pendingChanges;
+        pendingChanges = 0;
+    }
+
+    // Write the snapshot without holding the state lock
+    if (!storage->save(snapshot, changed))
+    {
+        // Keep the changes marked as pending so the next checkpoint retries
+        QMutexLocker locker(&stateMutex);
+        pendingChanges += pending;
+        changedUsers.unite(changed);
+        return false;
+    }
+
+    DBLogs->log("Shard " + QString::number(id) + " checkpoint written with " + QString::number(pending) + " changes.");
+    return true;
+}
+
+// Leaves a copy of the account table that the storage engine loads faster on the next start
+bool DataBaseShard::writeRestartSnapshot()
+{
+    return storage->writeRestartSnapshot(snapshot());
+}
+
+// Sets the checkpoint interval and the number of changes that trigger an early checkpoint
+void DataBaseShard::configureCheckpoint(qint32 intervalMs, qint32 maxPendingChanges)
+{
+    checkpointer->configure(intervalMs, maxPendingChanges);
+}
+
+// Holds back early checkpoints until the running batch ends
+void DataBaseShard::deferCheckpoints()
+{
+    deferredCheckpoints++;
+}
+
+// Ends a batch and writes its changes with a single checkpoint
+void DataBaseShard::resumeCheckpoints()
+{
+    if (--deferredCheckpoints == 0)
+    {
+        checkpointer->requestCheckpoint();
+    }
+}
@@ -0,0 +1,229 @@
+#ifndef DATABASESHARD_H
+#define DATABASESHARD_H
+
+#include <QByteArray>        // Includes the QByteArray class for handling byte arrays
+#include <QJsonDocument>     // Includes the QJsonDocument class for handling JSON documents
+#include <QJsonObject>       // Includes the QJsonObject class for handling JSON objects
+#include <QJsonArray>        // Includes the QJsonArray class for handling JSON arrays
+#include <QDateTime>         // Includes the QDateTime class for transaction timestamps
+#include <QHash>             // Includes the QHash class for the account number index
+#include <QSet>              // Includes the QSet class for the usernames changed since the last checkpoint
+#include <QVector>           // Includes the QVector class for the transaction time index
+#include <QMap>              // Includes the QMap class for the per-day transaction totals
+#include <algorithm>         // Includes std::lower_bound and std::upper_bound for searching the time index
+#include <limits>            // Includes std::numeric_limits for open time and balance ranges
+#include <set>               // Includes std::set for the balance index
+#include <cmath>             // Includes std::nextafter for closing balance ranges
+#include <utility>           // Includes std::pair for the entries of the balance index
+#include <QMutex>            // Includes the QMutex class for protecting the in-memory account table
+#include <QThreadPool>       // Includes the QThreadPool class used as the shard's executor thread
+#include <future>            // Includes std::packaged_task and std::future for waiting on the executor thread
+#include <memory>            // Includes smart pointers such as std::unique_ptr
+#include <functional>        // Includes std::function for the mutation listener
+#include <atomic>            // Includes std::atomic for the number of running batches
+#include "Logger.h"
+#include "Checkpointer.h"
+#include "StorageEngine.h"
+#include "SearchIndex.h"
+#include "SubscriptionManager.h"
+#include "ChangeLog.h"
+
+// The DataBaseShard class owns one partition of the account space.
+// Each shard has its own storage engine, in-memory account table, account number index,
+// executor thread and checkpoint thread. All operations on the shard run on its executor
+// thread one after another, so shards never block each other.
+class DataBaseShard
+{
+public:
+    // Constructor to load the shard from its storage engine and start its threads.
+    // Every change of the shard is numbered in changes, which all shards share.
+    DataBaseShard(qint32 shardID, std::unique_ptr<StorageEngine> engine, ChangeLog *changes, Logger *logs);
+    ~DataBaseShard();
+
+    // Delete the copy constructor and the assignment operator to prevent copying.
+    DataBaseShard(const DataBaseShard&) = delete;
+    DataBaseShard& operator=(const DataBaseShard&) = delete;
+
+    // Method to get the file name of a shard for the given storage format.
+    static QString shardFileName(qint32 shardID, const QString &suffix = "json");
+
+    // Method to get the index of the shard owning an account number for a given number of shards.
+    static qint32 shardOf(const QString &accountNumber, qint32 shardCount);
+
+    // Method to check if the storage engine found stored data when the shard was created.
+    bool hasStoredData() const;
+
+    // Method to check that the shard was loaded, filling jResponse with the reason otherwise.
+    bool CheckDataBase(QJsonObject &jResponse);
+
+    // Method to get a copy of the shard's account table, keyed by username.
+    QJsonObject snapshot();
+
+    // Methods for adding and removing whole accounts, used by user creation and rebalancing.
+    QJsonObject insertAccount(const QString &userName, const QJsonObject &account);
+    QJsonObject removeAccount(const QString &userName);
+
+    // Methods for reading a user's account and replacing its password, used by the login.
+    QJsonObject findUser(const QString &userName);
+
+    // Method to get the stored accounts of several users in "Accounts", keyed by username;
+    // users the shard does not hold are left out.
+    QJsonObject findUsers(const QStringList &userNames);
+    bool updatePassword(const QString &userName, const QString &passwordHash);
+
+    // Methods for handling the account operations routed to this shard.
+    // viewTransaction_History returns the newest entries first. Besides "Count" it accepts a time
+    // range ("From"/"To", milliseconds since the epoch, inclusive), a "Type" (Deposit, Withdraw or
+    // Transfer) and the "Cursor" returned as "NextCursor" by the previous page.
+    QJsonObject updateUser(const QJsonObject &data, QString &oldUserName);
+    QJsonObject deleteUser(const QString &accountNumber, QString &userName);
+    QJsonObject viewAccount_Balance(const QJsonObject &data);
+    QJsonObject viewTransaction_History(const QJsonObject &data);
+    QJsonObject makeTransaction(const QJsonObject &data);
+
+    // Method to get the running totals of the shard without visiting its accounts: the number of
+    // accounts and admins, the sum of the balances and the per-day transaction totals, optionally
+    // limited to the days from "FromDate" to "ToDate" (yyyy-MM-dd, inclusive).
+    QJsonObject summary(const QJsonObject &data);
+
+    // Method to get the accounts with a balance between minBalance and maxBalance (inclusive) from the
+    // balance index, in ascending or descending order of balance, at most count of them (0: all).
+    // Runs in O(log n + k); the response lists the accounts in "Accounts" without their passwords.
+    QJsonObject balanceQuery(double minBalance, double maxBalance, qint32 count, bool descending);
+
+    // Method to find at most count accounts (0: all) whose names start with (or, with substring set,
+    // contain) the text, using the search index. The response lists them like balanceQuery does.
+    QJsonObject search(const QString &text, bool substring, SearchIndex::Field field, qint32 count);
+
+    // Methods implementing the two-phase protocol used by transfers.
+    // prepareTransfer checks the account and holds the amount, commitTransfer applies it
+    // and abortTransfer releases the hold. type is recorded in the transaction history.
+    QJsonObject prepareTransfer(quint64 transferID, const QString &accountNumber, double amount, const QString &type = "Transfer");
+    bool commitTransfer(quint64 transferID);
+    bool abortTransfer(quint64 transferID);
+
+    // Method to register a callback receiving a change record for every account stored or erased.
+    // The callback runs on the shard's executor thread.
+    void setMutationListener(std::function<void(const QJsonObject &)> listener);
+
+    // Method to write a snapshot of the account table to disk if it has pending changes.
+    bool checkpoint();
+
+    // Method to set the checkpoint interval and the change count that triggers an early checkpoint.
+    void configureCheckpoint(qint32 intervalMs, qint32 maxPendingChanges);
+
+    // Method to leave a copy of the account table after a final checkpoint that loads faster on the next
+    // start, if the storage engine supports it.
+    bool writeRestartSnapshot();
+
+    // Methods to hold back early checkpoints while a batch runs, so the batch is written once at its end.
+    void deferCheckpoints();
+    void resumeCheckpoints();
+
+private:
+    // An amount held by a prepared transfer until it is committed or aborted.
+    struct Hold
+    {
+        QString accountNumber;
+        double amount;
+        QString type;
+    };
+
+    // Time index of the transaction history of an account. Entries are only ever appended, with
+    // ascending timestamps, so both the positions and the times ascend and a time range is found
+    // with two binary searches instead of a scan of the whole history.
+    struct HistoryIndex
+    {
+        QVector<qint64> times; // Timestamp of every history entry, by position.
+        QHash<QString, QVector<qint32>> byType; // Positions of the entries of each type.
+    };
+
+    // Transaction totals of one day.
+    struct DayTotals
+    {
+        double deposits = 0;      // Sum of the amounts credited.
+        double withdrawals = 0;   // Sum of the amounts debited, as a positive number.
+        qint32 transactions = 0;  // Number of transactions.
+    };
+
+    // Running totals over the accounts of the shard. They always equal what a scan of the account
+    // table would compute, so they are kept up to date by storeAccount() and eraseAccount().
+    struct Aggregates
+    {
+        qint32 accounts = 0;          // Number of accounts.
+        qint32 admins = 0;            // Number of admin accounts.
+        double totalBalance = 0;      // Sum of the account balances.
+        QMap<QDate, DayTotals> days;  // Transaction totals by day.
+    };
+
+    // Method to run a task on the shard's executor thread and wait for its result.
+    // The result is awaited with a std::future, which only blocks: QFuture::result() may take a task
+    // still queued and run it on the calling thread, next to the task the executor is running.
+    template <typename Task>
+    auto execute(Task task) -> decltype(task())
+    {
+        std::packaged_task<decltype(task())()> job(task);
+        std::future<decltype(task())> result = job.get_future();
+        executor.start([&job]() { job(); });
+        return result.get();
+    }
+
+    // Methods to modify the account table and the index; both mark a pending change.
+    void storeAccount(const QString &userName, const QJsonObject &account);
+    void eraseAccount(const QString &userName);
+
+    // Method to append a transaction to an account and update its balance.
+    // Without a type the entry is a Deposit or a Withdraw depending on the sign of the amount.
+    void applyTransaction(const QString &userName, double amount, const QString &type = QString());
+
+    // Method to move the aggregates from an account's previous version to its new one; an empty
+    // object stands for a missing account. Only appended history entries are visited, so a
+    // transaction costs O(1) whatever the size of the history.
+    void updateAggregates(const QJsonObject &previous, const QJsonObject &account);
+
+    // Method to get an account as listed by the queries, without its password and history.
+    QJsonObject publicAccount(const QString &accountNumber) const;
+
+    // Method to move an account in the balance index from its previous balance to its new one.
+    void updateBalanceIndex(const QJsonObject &previous, const QJsonObject &account);
+
+    // Method to add (sign 1) or remove (sign -1) history entries from the per-day totals.
+    void addToDays(const QJsonArray &history, qint32 first, qint32 sign);
+
+    // Method to index the history entries of an account that are not indexed yet.
+    void indexHistory(const QString &accountNumber, const QJsonObject &account);
+
+    // Method to get the time of a history entry; entries written before timestamps were stored
+    // are timed from their Date and Time strings.
+    static qint64 transactionTime(const QJsonObject &transaction);
+
+    // Method to read a time filter given as a number or a numeric string.
+    static qint64 epochValue(const QJsonValue &value, qint64 defaultValue);
+
+    // Method to get the amount currently held by prepared withdrawals of an account.
+    double heldAmount(const QString &accountNumber) const;
+
+    qint32 id; // Index of the shard.
+    std::unique_ptr<StorageEngine> storage; // Medium the account table is loaded from and checkpointed to.
+    QJsonObject accounts; // In-memory account table, keyed by username.
+    QHash<QString, QString> accountIndex; // Index from account number to username.
+    QHash<QString, HistoryIndex> historyIndex; // Time index of the transaction histories, by account number.
+    Aggregates aggregates; // Running totals answering summary requests.
+    std::set<std::pair<double, QString>> balanceIndex; // Accounts ordered by balance, as (balance, account number).
+    SearchIndex searchIndex; // Index of the usernames and full names.
+    std::shared_ptr<SubscriptionManager> subscriptions; // Connections receiving the changes of accounts.
+    QHash<quint64, Hold> holds; // Amounts held by prepared transfers.
+    qint32 loadReason; // Reason code of the load failure, 0 if the shard was loaded.
+    qint32 pendingChanges; // Number of modifications not yet written by a checkpoint.
+    QSet<QString> changedUsers; // Usernames stored or erased since the last checkpoint.
+    std::atomic<qint32> deferredCheckpoints; // Number of running batches holding back early checkpoints.
+    QMutex stateMutex; // Mutex protecting accounts, pendingChanges and changedUsers against the checkpoint thread.
+    QMutex checkpointMutex; // Mutex serializing checkpoints so only one of them writes to the storage engine at a time.
+    QThreadPool executor; // Single-thread pool running the shard's operations in order.
+    std::unique_ptr<Checkpointer> checkpointer; // Background thread writing the account table to disk.
+    std::function<void(const QJsonObject &)> mutationListener; // Callback receiving the change records.
+    ChangeLog *changeLog; // Log numbering the changes of all shards, owned by the DataBaseHandler.
+    Logger *DBLogs; // Database logger shared with the DataBaseHandler.
+};
+
+#endif // DATABASESHARD_H
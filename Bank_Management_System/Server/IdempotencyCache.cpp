@@ -0,0 +1,100 @@
+#include "IdempotencyCache.h"
+
+// Time a retry waits for the original request to finish before giving up
+static const qint32 InProgressWaitMs = 10000;
+
+// Constructor: Keeps up to 100000 responses for 10 minutes unless configure() is called
+IdempotencyCache::IdempotencyCache()
+    : capacity{100000}, ttl{600}
+{
+}
+
+// Static method to get the singleton instance of IdempotencyCache
+std::shared_ptr<IdempotencyCache> IdempotencyCache::getInstance()
+{
+    static std::shared_ptr<IdempotencyCache> instance(new IdempotencyCache());
+    return instance;
+}
+
+// Looks up a key and reserves it if unknown
+IdempotencyCache::Status IdempotencyCache::begin(const QString &key, const QByteArray &fingerprint, QJsonObject &response)
+{
+    QMutexLocker locker(&mutex);
+    evict();
+
+    QDeadlineTimer deadline(InProgressWaitMs);
+    while (true)
+    {
+        auto it = entries.find(key);
+        if (it == entries.end())
+        {
+            // First request with this key; concurrent retries wait for it below
+            entries.insert(key, Entry{fingerprint, QJsonObject(), false, 0});
+            return Started;
+        }
+
+        if (it->fingerprint != fingerprint)
+        {
+            return Mismatch;
+        }
+
+        if (it->done)
+        {
+            response = it->response;
+            return Replayed;
+        }
+
+        // Wait for the original request instead of running it a second time
+        if (!finished.wait(&mutex, deadline))
+        {
+            return Busy;
+        }
+    }
+}
+
+// Stores the response of a finished request and wakes the retries waiting for it
+void IdempotencyCache::finish(const QString &key, const QJsonObject &response)
+{
+    QMutexLocker locker(&mutex);
+
+    auto it = entries.find(key);
+    if (it != entries.end())
+    {
+        it->response = response;
+        it->done = true;
+        it->expiry = QDateTime::currentMSecsSinceEpoch() + qint64(ttl) * 1000;
+        order.push_back(key);
+    }
+
+    finished.wakeAll();
+}
+
+// Sets the maximum number of entries and their lifetime
+void IdempotencyCache::configure(qint32 maxEntries, qint32 ttlSeconds)
+{
+    QMutexLocker locker(&mutex);
+    capacity = qMax(maxEntries, 1);
+    ttl = qMax(ttlSeconds, 1);
+}
+
+// Drops entries from the oldest on while they are expired or the cache is over capacity.
+// All entries live equally long, so the oldest finished entry is always the first to expire.
+void IdempotencyCache::evict()
+{
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    while (!order.empty())
+    {
+        auto it = entries.find(order.front());
+        if ((it != entries.end()) && (it->expiry >= now) && (order.size() <= static_cast<size_t>(capacity)))
+        {
+            break;
+        }
+
+        if (it != entries.end())
+        {
+            entries.erase(it);
+        }
+        order.pop_front();
+    }
+}
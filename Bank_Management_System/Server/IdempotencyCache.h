@@ -0,0 +1,72 @@
+#ifndef IDEMPOTENCYCACHE_H
+#define IDEMPOTENCYCACHE_H
+
+#include <QString>        // Includes the QString class for the idempotency keys
+#include <QByteArray>     // Includes the QByteArray class for the request fingerprints
+#include <QHash>          // Includes the QHash class for the cached responses
+#include <QJsonObject>    // Includes the QJsonObject class for the cached responses
+#include <QMutex>         // Includes the QMutex class for protecting the cache
+#include <QWaitCondition> // Includes the QWaitCondition class for waiting on a request in progress
+#include <QDeadlineTimer> // Includes the QDeadlineTimer class for bounding that wait
+#include <QDateTime>      // Includes the QDateTime class for the entry expiry
+#include <memory>         // Includes smart pointers such as std::shared_ptr
+#include <deque>          // Includes std::deque for the eviction order
+
+// The IdempotencyCache class remembers the responses of write requests sent with an idempotency key.
+// A client retrying a request with the same key gets the original response back instead of
+// applying the request a second time. Entries expire after a fixed time, and the oldest ones
+// are dropped once the cache is full.
+class IdempotencyCache
+{
+public:
+    // Result of looking up a key.
+    enum Status
+    {
+        Started,  // Unknown key; the caller runs the request and calls finish()
+        Replayed, // Known key; the original response was returned
+        Mismatch, // Known key sent with a different request
+        Busy      // The original request is still running
+    };
+
+    // Method to get the singleton instance of IdempotencyCache.
+    static std::shared_ptr<IdempotencyCache> getInstance();
+
+    // Delete the copy constructor and the assignment operator to prevent copying.
+    IdempotencyCache(const IdempotencyCache&) = delete;
+    IdempotencyCache& operator=(const IdempotencyCache&) = delete;
+
+    // Method to look up a key. If the original request with this key is still running,
+    // waits for it to finish up to a timeout.
+    Status begin(const QString &key, const QByteArray &fingerprint, QJsonObject &response);
+
+    // Method to store the response of a request started with begin().
+    void finish(const QString &key, const QJsonObject &response);
+
+    // Method to set the maximum number of entries and their lifetime in seconds.
+    void configure(qint32 maxEntries, qint32 ttlSeconds);
+
+private:
+    // Constructor to initialize the IdempotencyCache object.
+    IdempotencyCache();
+
+    // A request seen with a key, and its response once it finished.
+    struct Entry
+    {
+        QByteArray fingerprint;
+        QJsonObject response;
+        bool done;
+        qint64 expiry; // Expiry time in milliseconds since the epoch, set when the request finished.
+    };
+
+    // Method to drop the expired entries and the oldest ones beyond the capacity.
+    void evict();
+
+    QHash<QString, Entry> entries; // Entries keyed by idempotency key.
+    std::deque<QString> order; // Keys of the finished entries, oldest first.
+    QMutex mutex; // Mutex protecting the entries.
+    QWaitCondition finished; // Signaled whenever a request finishes.
+    qint32 capacity; // Maximum number of finished entries.
+    qint32 ttl; // Lifetime of the finished entries in seconds.
+};
+
+#endif // IDEMPOTENCYCACHE_H
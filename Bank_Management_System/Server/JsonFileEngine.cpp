@@ -0,0 +1,230 @@
+#include "JsonFileEngine.h"
+
+// Constructor for JsonFileEngine
+JsonFileEngine::JsonFileEngine(const QString &fileName, qint32 shardID, Logger *logs)
+    : fileName{fileName}, id{shardID}, DBLogs{logs}
+{
+}
+
+// Loads the shard file, or its restart snapshot after a graceful shutdown.
+// A missing file is an empty shard; it is created by the first checkpoint.
+qint32 JsonFileEngine::load(QJsonObject &accounts)
+{
+    if (!exists() || loadRestartSnapshot(accounts))
+    {
+        return 0;
+    }
+
+    qint32 reason = readDataBase(fileName, accounts, DBLogs);
+
+    // A file of the old format is rewritten with its checksum right away, so it is accepted only once
+    if ((reason == 0) && readChecksumTrailer(fileName).isEmpty() && !save(accounts, QSet<QString>()))
+    {
+        DBLogs->log("Shard " + QString::number(id) + " could not be rewritten with a checksum.", Logger::Warning);
+    }
+    return reason;
+}
+
+// Checks if the shard's database file exists on disk
+bool JsonFileEngine::exists() const
+{
+    return QFile::exists(fileName);
+}
+
+// Reads a database file, verifies its checksum trailer and parses it into database
+qint32 JsonFileEngine::readDataBase(const QString &fileName, QJsonObject &database, Logger *logs, bool allowLegacy)
+{
+    QFile file(fileName);
+
+    // Check if the database file exists
+    if (!file.exists())
+    {
+        logs->log("Database file " + fileName + " doesn't exist.");
+        return -5; // File does not exist
+    }
+
+    // Open the database file for reading
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        logs->log("Failed to open database file " + fileName + " for reading.", Logger::Error);
+        return -4; // Failed to open file for reading
+    }
+
+    // Read the file content and split off its checksum trailer
+    QByteArray content = file.readAll();
+    file.close(); // Close the file after reading
+
+    const QByteArray marker = "#SHA256:";
+    qsizetype pos = content.lastIndexOf(marker);
+
+    // Files written before the trailer was introduced have no checksum to verify. Once a checksummed
+    // file was written to the directory, a missing trailer means the file was cut off.
+    if (pos < 0)
+    {
+        if (!allowLegacy && QFile::exists(checksumMarker(fileName)))
+        {
+            logs->log("Database file " + fileName + " has no checksum trailer.", Logger::Error);
+            return -3; // Corrupted database
+        }
+        logs->log("Database file " + fileName + " has no checksum trailer; loading it to migrate it.", Logger::Warning);
+    }
+    else
+    {
+        QByteArray storedHash = QByteArray::fromHex(content.mid(pos + marker.size()).trimmed());
+        content.truncate(pos); // Keep only the JSON part of the file
+
+        if (QCryptographicHash::hash(content, QCryptographicHash::Sha256) != storedHash)
+        {
+            logs->log("Database file " + fileName + " checksum mismatch.");
+            return -3; // Corrupted database
+        }
+    }
+
+    // Parse the JSON data from the file
+    QJsonParseError jError;
+    QJsonDocument doc = QJsonDocument::fromJson(content, &jError);
+
+    // Check for parsing errors
+    if (jError.error != QJsonParseError::NoError)
+    {
+        logs->log("Failed to parse JSON of " + fileName + ".", Logger::Error);
+        return -3; // Failed to parse JSON
+    }
+
+    database = doc.object();
+    return 0;
+}
+
+// Reads the "#SHA256:<hex>" trailer from the last bytes of a database file
+QByteArray JsonFileEngine::readChecksumTrailer(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return QByteArray();
+    }
+
+    // The trailer is the last line, so only the end of the file is read
+    file.seek(qMax<qint64>(0, file.size() - 128));
+    QByteArray tail = file.read(128);
+
+    const QByteArray marker = "#SHA256:";
+    qsizetype pos = tail.lastIndexOf(marker);
+    return (pos >= 0) ? tail.mid(pos + marker.size()).trimmed() : QByteArray();
+}
+
+// Returns the marker file in the directory of a database file
+QString JsonFileEngine::checksumMarker(const QString &fileName)
+{
+    return QFileInfo(fileName).dir().filePath(".checksummed");
+}
+
+// Creates the marker once the first checksummed file is in the directory
+void JsonFileEngine::markChecksummed(const QString &fileName)
+{
+    QString marker = checksumMarker(fileName);
+    if (!QFile::exists(marker))
+    {
+        QFile file(marker);
+        file.open(QIODevice::WriteOnly);
+    }
+}
+
+// Writes the account table as CBOR, together with the checksum of the shard file it matches.
+// Layout: SHA-256 of the CBOR data, then the CBOR map {"JsonChecksum", "Accounts"}.
+bool JsonFileEngine::writeRestartSnapshot(const QJsonObject &accounts)
+{
+    QByteArray jsonChecksum = readChecksumTrailer(fileName);
+    if (jsonChecksum.isEmpty())
+    {
+        return false;
+    }
+
+    QCborMap restart;
+    restart.insert(QStringLiteral("JsonChecksum"), QString::fromLatin1(jsonChecksum));
+    restart.insert(QStringLiteral("Accounts"), QCborMap::fromJsonObject(accounts));
+    QByteArray cbor = restart.toCborValue().toCbor();
+
+    QSaveFile saveFile(fileName + ".restart");
+    if (!saveFile.open(QIODevice::WriteOnly))
+    {
+        return false;
+    }
+    saveFile.write(QCryptographicHash::hash(cbor, QCryptographicHash::Sha256));
+    saveFile.write(cbor);
+    return saveFile.commit();
+}
+
+// Loads the account table from the restart snapshot if it was written for the current shard file.
+// The snapshot is removed afterwards; the next checkpoint changes the shard file and would make it stale anyway.
+bool JsonFileEngine::loadRestartSnapshot(QJsonObject &accounts)
+{
+    QFile file(fileName + ".restart");
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return false; // No graceful shutdown before this start
+    }
+
+    QByteArray content = file.readAll();
+    file.close();
+    file.remove();
+
+    QByteArray storedHash = content.left(32);
+    QByteArray cbor = content.mid(32);
+    if (QCryptographicHash::hash(cbor, QCryptographicHash::Sha256) != storedHash)
+    {
+        DBLogs->log("Shard " + QString::number(id) + " restart snapshot is corrupted; loading the JSON file.", Logger::Warning);
+        return false;
+    }
+
+    QCborParserError cborError;
+    QCborMap restart = QCborValue::fromCbor(cbor, &cborError).toMap();
+    if (cborError.error != QCborError::NoError)
+    {
+        return false;
+    }
+
+    // The shard file changed after the snapshot was written, e.g. by the bulk tool
+    if (restart.value(QStringLiteral("JsonChecksum")).toString().toLatin1() != readChecksumTrailer(fileName))
+    {
+        DBLogs->log("Shard " + QString::number(id) + " restart snapshot is stale; loading the JSON file.");
+        return false;
+    }
+
+    accounts = restart.value(QStringLiteral("Accounts")).toMap().toJsonObject();
+    DBLogs->log("Shard " + QString::number(id) + " loaded from its restart snapshot.");
+    return true;
+}
+
+// Writes the account table to a temporary file, syncs it and renames it over the shard's file.
+// A crash or a full disk midway leaves the previous file untouched.
+bool JsonFileEngine::save(const QJsonObject &database, const QSet<QString> &changed)
+{
+    // A JSON file cannot be updated in place, so every account is written again
+    Q_UNUSED(changed);
+
+    QSaveFile saveFile(fileName);
+
+    if (!saveFile.open(QIODevice::WriteOnly))
+    {
+        DBLogs->log("Failed to open file " + fileName + " for writing.", Logger::Error);
+        return false;
+    }
+
+    // Append the SHA-256 of the JSON content as a trailer line
+    QByteArray content = QJsonDocument(database).toJson(QJsonDocument::Indented);
+    QByteArray checksum = QCryptographicHash::hash(content, QCryptographicHash::Sha256).toHex();
+    saveFile.write(content);
+    saveFile.write("#SHA256:" + checksum + "\n");
+
+    // commit() flushes and syncs the temporary file before the atomic rename;
+    // on any write error it discards the temporary file instead
+    if (!saveFile.commit())
+    {
+        DBLogs->log("Failed to commit the database file: " + saveFile.errorString(), Logger::Error);
+        return false;
+    }
+
+    markChecksummed(fileName); // From now on files of this directory must carry the trailer
+    return true;
+}
@@ -0,0 +1,59 @@
+#ifndef JSONFILEENGINE_H
+#define JSONFILEENGINE_H
+
+#include <QByteArray>         // Includes the QByteArray class for the file content
+#include <QJsonDocument>      // Includes the QJsonDocument class for serializing the account table
+#include <QJsonParseError>    // Includes the QJsonParseError class for handling JSON parse errors
+#include <QFile>              // Includes the QFile class for file handling
+#include <QFileInfo>          // Includes the QFileInfo class for the directory of a file
+#include <QDir>               // Includes the QDir class for the checksum marker
+#include <QSaveFile>          // Includes the QSaveFile class for atomic file writes
+#include <QCryptographicHash> // Includes the QCryptographicHash class for the database checksum
+#include <QCborValue>         // Includes the QCborValue class for the binary restart snapshot
+#include <QCborMap>           // Includes the QCborMap class for the binary restart snapshot
+#include "StorageEngine.h"
+#include "Logger.h"
+
+// The JsonFileEngine class keeps a shard in one JSON file, the format the server always used.
+// Each checkpoint rewrites the whole file atomically, followed by a "#SHA256:<hex>" trailer
+// that is verified on load. Files without the trailer are only loaded as long as no checksummed
+// file was written to the data directory, to migrate the format that predates it; after that a
+// missing trailer means the file was cut off. After a graceful shutdown a binary restart snapshot
+// next to the file spares the JSON parse on the next start.
+class JsonFileEngine : public StorageEngine
+{
+public:
+    // Constructor to keep the accounts of a shard in the given file.
+    JsonFileEngine(const QString &fileName, qint32 shardID, Logger *logs);
+
+    qint32 load(QJsonObject &accounts) override;
+    bool exists() const override;
+    bool save(const QJsonObject &accounts, const QSet<QString> &changed) override;
+    bool writeRestartSnapshot(const QJsonObject &accounts) override;
+
+    // Method to read a database file, verify its checksum and parse it.
+    // allowLegacy accepts a file without checksum trailer even in a directory holding checksummed files,
+    // for files that always had the old format, such as the single-file database.
+    // Returns 0 on success or the negative reason code of the failure.
+    static qint32 readDataBase(const QString &fileName, QJsonObject &database, Logger *logs, bool allowLegacy = false);
+
+    // Method to record that a checksummed file was written to the directory of fileName,
+    // after which files of that directory without a trailer are rejected.
+    static void markChecksummed(const QString &fileName);
+
+private:
+    // Method to load the restart snapshot if it matches the shard file. Returns false if it cannot be used.
+    bool loadRestartSnapshot(QJsonObject &accounts);
+
+    // Method to read the checksum trailer at the end of a database file, without reading the rest of it.
+    static QByteArray readChecksumTrailer(const QString &fileName);
+
+    // Method to get the marker file recording that the directory of fileName holds checksummed files.
+    static QString checksumMarker(const QString &fileName);
+
+    QString fileName; // The shard's database file.
+    qint32 id; // Index of the shard, used in the log messages.
+    Logger *DBLogs; // Database logger shared with the DataBaseHandler.
+};
+
+#endif // JSONFILEENGINE_H
@@ -1,15 +1,25 @@
 #include "Logger.h"
 
+std::atomic<int> Logger::minimumLevel{Logger::Info};
+QString Logger::logDirectory = "Logs";
+
 // Constructor: Initializes the Logger with the specified log file name.
+// Only the file name is kept; the file lives in the configured log directory.
 Logger::Logger(const QString &fileName)
 {
-    logFile.setFileName(fileName);
+    logFile.setFileName(QDir(logDirectory).filePath(QFileInfo(fileName).fileName()));
 }
 
 // log: Writes a log message to the log file.
 // The message is prefixed with a timestamp.
-void Logger::log(const QString &message)
+void Logger::log(const QString &message, Level level)
 {
+    // Dropped before taking the mutex, so disabled levels cost next to nothing
+    if (level < minimumLevel.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
     // Lock the mutex to ensure thread-safe access to the log file.
     QMutexLocker locker(&mutex);
 
@@ -33,3 +43,34 @@ void Logger::log(const QString &message)
     textStream.flush(); // Ensure the message is written to the file.
     logFile.close();    // Close the log file after writing.
 }
+
+// Sets the minimum level written by every Logger.
+void Logger::setLevel(Level level)
+{
+    minimumLevel.store(level, std::memory_order_relaxed);
+}
+
+// Parses a level name; unknown names give Info and set ok to false.
+Logger::Level Logger::levelFromString(const QString &name, bool *ok)
+{
+    static const QStringList names = {"debug", "info", "warning", "error"};
+    qsizetype index = names.indexOf(name.trimmed().toLower());
+
+    if (ok)
+    {
+        *ok = (index >= 0);
+    }
+    return (index >= 0) ? static_cast<Level>(index) : Info;
+}
+
+// Sets the directory of the log files.
+void Logger::setDirectory(const QString &directory)
+{
+    logDirectory = directory;
+}
+
+// Returns the directory of the log files.
+QString Logger::directory()
+{
+    return logDirectory;
+}
@@ -7,19 +7,45 @@
 #include <QMutex>
 #include <QDateTime>
 #include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <atomic>
 
 // The Logger class provides a simple logging mechanism to write messages to a file.
 class Logger
 {
 public:
+    // Severity of a log message; messages below the configured level are dropped.
+    enum Level
+    {
+        Debug,
+        Info,
+        Warning,
+        Error
+    };
+
     // Constructor: Initializes the Logger with the specified log file name.
+    // The file is placed in the configured log directory.
     Logger(const QString &fileName);
 
     // log: Writes a log message to the log file.
     // The message is prefixed with a timestamp.
-    void log(const QString &message);
+    void log(const QString &message, Level level = Info);
+
+    // Sets the minimum level written by every Logger.
+    static void setLevel(Level level);
+
+    // Parses a level name ("debug", "info", "warning" or "error").
+    static Level levelFromString(const QString &name, bool *ok = nullptr);
+
+    // Sets the directory of the log files; must be called before the Loggers are created.
+    static void setDirectory(const QString &directory);
+    static QString directory();
 
 private:
+    static std::atomic<int> minimumLevel; // Lowest level that is written.
+    static QString logDirectory;          // Directory the log files are created in.
+
     QFile logFile;          // QFile object to handle the log file.
     QTextStream textStream; // QTextStream object for writing text to the log file.
     QMutex mutex;           // QMutex for ensuring thread-safe access to the log file.
@@ -0,0 +1,22 @@
+#include "MemoryEngine.h"
+
+// Starts with an empty account table
+qint32 MemoryEngine::load(QJsonObject &accounts)
+{
+    accounts = QJsonObject();
+    return 0;
+}
+
+// Nothing is ever stored
+bool MemoryEngine::exists() const
+{
+    return false;
+}
+
+// The account table only lives in the shard's memory
+bool MemoryEngine::save(const QJsonObject &accounts, const QSet<QString> &changed)
+{
+    Q_UNUSED(accounts);
+    Q_UNUSED(changed);
+    return true;
+}
@@ -0,0 +1,16 @@
+#ifndef MEMORYENGINE_H
+#define MEMORYENGINE_H
+
+#include "StorageEngine.h"
+
+// The MemoryEngine class keeps nothing: every start begins with an empty shard and the checkpoints
+// write nothing. It suits tests, benchmarks and caches in front of another database.
+class MemoryEngine : public StorageEngine
+{
+public:
+    qint32 load(QJsonObject &accounts) override;
+    bool exists() const override;
+    bool save(const QJsonObject &accounts, const QSet<QString> &changed) override;
+};
+
+#endif // MEMORYENGINE_H
@@ -0,0 +1,63 @@
+#include "PasswordHasher.h"
+
+// Work factor used when setIterations() is not called
+std::atomic<qint32> PasswordHasher::iterations{10000};
+
+// Hashes a password with a random 16-byte salt
+QString PasswordHasher::hash(const QString &password)
+{
+    quint32 saltWords[4];
+    QRandomGenerator::system()->fillRange(saltWords);
+    QByteArray salt(reinterpret_cast<const char*>(saltWords), sizeof(saltWords));
+
+    qint32 count = iterations;
+    QByteArray key = QPasswordDigestor::deriveKeyPbkdf2(QCryptographicHash::Sha256, password.toUtf8(), salt, count, 32);
+
+    return "pbkdf2-sha256$" + QString::number(count) + "$" + QString(salt.toHex()) + "$" + QString(key.toHex());
+}
+
+// Verifies a password against a stored hash, or against a plaintext password of an older database
+bool PasswordHasher::verify(const QString &password, const QString &stored)
+{
+    QStringList parts = stored.split('$');
+
+    if ((parts.size() != 4) || (parts[0] != "pbkdf2-sha256"))
+    {
+        return constantTimeEquals(password.toUtf8(), stored.toUtf8());
+    }
+
+    QByteArray salt = QByteArray::fromHex(parts[2].toUtf8());
+    QByteArray expected = QByteArray::fromHex(parts[3].toUtf8());
+    QByteArray key = QPasswordDigestor::deriveKeyPbkdf2(QCryptographicHash::Sha256, password.toUtf8(), salt, parts[1].toInt(), expected.size());
+
+    return constantTimeEquals(key, expected);
+}
+
+// Checks if a stored password should be replaced by a hash with the current work factor
+bool PasswordHasher::needsRehash(const QString &stored)
+{
+    QStringList parts = stored.split('$');
+    return (parts.size() != 4) || (parts[0] != "pbkdf2-sha256") || (parts[1].toInt() != iterations);
+}
+
+// Sets the number of PBKDF2 iterations of new hashes
+void PasswordHasher::setIterations(qint32 count)
+{
+    iterations = qMax(count, 1);
+}
+
+// Compares every byte so the time taken does not reveal the first difference
+bool PasswordHasher::constantTimeEquals(const QByteArray &a, const QByteArray &b)
+{
+    if (a.size() != b.size())
+    {
+        return false;
+    }
+
+    char diff = 0;
+    for (qsizetype i = 0; i < a.size(); i++)
+    {
+        diff |= a[i] ^ b[i];
+    }
+    return diff == 0;
+}
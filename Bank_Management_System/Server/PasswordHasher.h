@@ -0,0 +1,36 @@
+#ifndef PASSWORDHASHER_H
+#define PASSWORDHASHER_H
+
+#include <QString>            // Includes the QString class for the passwords and the stored hashes
+#include <QByteArray>         // Includes the QByteArray class for the salt and the derived key
+#include <QCryptographicHash> // Includes the QCryptographicHash class for the hash algorithm
+#include <QPasswordDigestor>  // Includes QPasswordDigestor for the PBKDF2 key derivation
+#include <QRandomGenerator>   // Includes the QRandomGenerator class for generating salts
+#include <atomic>             // Includes std::atomic for the work factor
+
+// The PasswordHasher class derives salted PBKDF2-SHA256 hashes of the user passwords.
+// Hashes are stored as "pbkdf2-sha256$<iterations>$<salt>$<hash>"; values without this
+// prefix are plaintext passwords from older databases and still verify.
+class PasswordHasher
+{
+public:
+    // Method to hash a password with a fresh salt and the current work factor.
+    static QString hash(const QString &password);
+
+    // Method to check a password against a stored hash or a legacy plaintext password.
+    static bool verify(const QString &password, const QString &stored);
+
+    // Method to check if a stored password is plaintext or uses another work factor.
+    static bool needsRehash(const QString &stored);
+
+    // Method to set the work factor (PBKDF2 iterations) of new hashes.
+    static void setIterations(qint32 count);
+
+private:
+    // Method to compare two byte arrays in a time independent of where they differ.
+    static bool constantTimeEquals(const QByteArray &a, const QByteArray &b);
+
+    static std::atomic<qint32> iterations; // Work factor of new hashes.
+};
+
+#endif // PASSWORDHASHER_H
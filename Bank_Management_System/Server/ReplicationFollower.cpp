@@ -0,0 +1,132 @@
+#include "ReplicationFollower.h"
+
+// Constructor for ReplicationFollower
+ReplicationFollower::ReplicationFollower(const QString &host, quint16 port, const QByteArray &secret, QObject *parent)
+    : QObject{parent}, host{host}, port{port}, secret{secret}, scanned{0}, leaderVerified{false}
+{
+    db_handler = DataBaseHandler::getInstance();
+    db_handler->setReadOnly(true); // Only the leader accepts write requests
+    ReplicationLogs = new Logger("Logs/ReplicationLogs.txt");
+
+    // Retry every two seconds while the leader is unreachable
+    reconnectTimer.setSingleShot(true);
+    reconnectTimer.setInterval(2000);
+
+    connect(&socket, &QTcpSocket::connected, this, &ReplicationFollower::onConnected);
+    connect(&socket, &QTcpSocket::readyRead, this, &ReplicationFollower::onReadyRead);
+    connect(&socket, &QTcpSocket::disconnected, this, &ReplicationFollower::onDisconnected);
+    connect(&socket, &QTcpSocket::errorOccurred, this, &ReplicationFollower::onDisconnected);
+    connect(&reconnectTimer, &QTimer::timeout, this, &ReplicationFollower::reconnect);
+}
+
+ReplicationFollower::~ReplicationFollower()
+{
+    ReplicationLogs->log("Destroying the ReplicationFollower object along with its resources");
+    delete ReplicationLogs;
+}
+
+// Connects to the leader
+void ReplicationFollower::StartFollowing()
+{
+    ReplicationLogs->log("Following the leader at " + host + ":" + QString::number(port));
+    reconnect();
+}
+
+// Logs the connection to the leader; the leader sends a challenge first
+void ReplicationFollower::onConnected()
+{
+    buffer.clear();
+    scanned = 0;
+    nonce.clear();
+    leaderVerified = false;
+    ReplicationLogs->log("Connected to the leader at " + host + ":" + QString::number(port));
+}
+
+// Applies every complete record line received from the leader
+void ReplicationFollower::onReadyRead()
+{
+    buffer.append(socket.readAll());
+
+    // Search only the bytes that arrived since the last read, as the snapshot is one very long line
+    qsizetype start = 0;
+    qsizetype end;
+    bool rejected = false;
+    while ((end = buffer.indexOf('\n', qMax(start, scanned))) >= 0)
+    {
+        QJsonObject record = QJsonDocument::fromJson(buffer.mid(start, end - start)).object();
+        start = end + 1;
+
+        if (record.isEmpty())
+        {
+            continue;
+        }
+
+        // The leader sends the snapshot once the challenge is answered with the shared secret
+        QString op = record.value("Op").toString();
+        if (op == "Challenge")
+        {
+            nonce = ReplicationLeader::newNonce();
+            QJsonObject answer;
+            answer["Op"] = "Auth";
+            answer["Response"] = QString::fromLatin1(ReplicationLeader::challengeResponse(secret, "Follower", record.value("Nonce").toString().toLatin1()));
+            answer["Nonce"] = QString::fromLatin1(nonce);
+            socket.write(QJsonDocument(answer).toJson(QJsonDocument::Compact) + '\n');
+        }
+        // The leader proves it has the secret too before anything it sends is applied
+        else if (op == "Proof")
+        {
+            QByteArray response = record.value("Response").toString().toLatin1();
+            leaderVerified = !nonce.isEmpty() && ReplicationLeader::sameResponse(response, ReplicationLeader::challengeResponse(secret, "Leader", nonce));
+            if (!leaderVerified)
+            {
+                rejected = true;
+                break;
+            }
+        }
+        else if (!leaderVerified)
+        {
+            rejected = true;
+            break;
+        }
+        // Session records go to the session table, all others change the accounts
+        else if ((op == "Session") || (op == "EndSessions") || (op == "Sessions"))
+        {
+            SessionManager::getInstance()->applyReplication(record);
+        }
+        else
+        {
+            db_handler->applyReplication(record);
+        }
+    }
+
+    // A peer that cannot prove it has the secret is dropped without applying anything it sent
+    if (rejected)
+    {
+        ReplicationLogs->log("The leader at " + host + ":" + QString::number(port) + " failed to authenticate", Logger::Warning);
+        buffer.clear();
+        scanned = 0;
+        socket.abort();
+        onDisconnected();
+        return;
+    }
+
+    buffer.remove(0, start);
+    scanned = buffer.size();
+}
+
+// Schedules a reconnection after the connection to the leader was lost or failed
+void ReplicationFollower::onDisconnected()
+{
+    if (!reconnectTimer.isActive())
+    {
+        ReplicationLogs->log("Lost the leader at " + host + ":" + QString::number(port) + ", reconnecting...");
+        reconnectTimer.start();
+    }
+}
+
+// Connects to the leader again
+void ReplicationFollower::reconnect()
+{
+    socket.abort();
+    socket.connectToHost(host, port);
+}
@@ -0,0 +1,57 @@
+#ifndef REPLICATIONFOLLOWER_H
+#define REPLICATIONFOLLOWER_H
+
+#include <QObject>       // Includes the base class for all Qt objects
+#include <QTcpSocket>    // Includes the QTcpSocket class used for the leader connection
+#include <QTimer>        // Includes the QTimer class for reconnecting to the leader
+#include <QJsonObject>   // Includes the QJsonObject class for the change records
+#include <QJsonDocument> // Includes the QJsonDocument class for parsing the change records
+#include <memory>        // Includes smart pointers such as std::shared_ptr
+#include "DataBaseHandler.h"
+#include "ReplicationLeader.h"
+#include "Logger.h"
+
+// The ReplicationFollower class keeps the local database in sync with a replication leader.
+// It answers the leader's challenge with the shared secret and checks the leader's answer to its own
+// challenge, then applies the snapshot and the change records streamed by the leader and reconnects
+// whenever the connection is lost. The local database is read-only while following.
+class ReplicationFollower : public QObject
+{
+    Q_OBJECT // Macro to enable Qt's meta-object system, including signals and slots
+
+public:
+    // Constructor to initialize the follower with the leader's address and the secret shared with it.
+    explicit ReplicationFollower(const QString &host, quint16 port, const QByteArray &secret, QObject *parent = nullptr);
+    ~ReplicationFollower();
+
+    // Method to connect to the leader.
+    void StartFollowing();
+
+private slots:
+    // Slot for handling the connection to the leader.
+    void onConnected();
+
+    // Slot for applying the records received from the leader.
+    void onReadyRead();
+
+    // Slot for scheduling a reconnection when the connection is lost or fails.
+    void onDisconnected();
+
+    // Slot for connecting to the leader again.
+    void reconnect();
+
+private:
+    QString host; // Address of the leader.
+    quint16 port; // Replication port of the leader.
+    QByteArray secret; // Secret proving to the leader that this follower may receive the accounts.
+    QTcpSocket socket; // Connection to the leader.
+    QTimer reconnectTimer; // Timer delaying the reconnection attempts.
+    QByteArray buffer; // Received bytes not yet forming a complete record line.
+    qsizetype scanned; // Bytes of the buffer already searched for the end of a line.
+    QByteArray nonce; // Challenge sent to the leader on this connection.
+    bool leaderVerified; // Set once the leader answered the challenge; records are only applied after that.
+    std::shared_ptr<DataBaseHandler> db_handler; // Database receiving the changes.
+    Logger *ReplicationLogs;
+};
+
+#endif // REPLICATIONFOLLOWER_H
@@ -0,0 +1,207 @@
+#include "ReplicationLeader.h"
+
+// Constructor for ReplicationLeader
+ReplicationLeader::ReplicationLeader(const QByteArray &secret, QObject *parent)
+    : QTcpServer{parent}, secret{secret}, sequence{0}
+{
+    db_handler = DataBaseHandler::getInstance();
+    ReplicationLogs = new Logger("Logs/ReplicationLogs.txt");
+
+    connect(this, &QTcpServer::newConnection, this, &ReplicationLeader::onNewConnection);
+}
+
+ReplicationLeader::~ReplicationLeader()
+{
+    // Stop reporting changes before the followers go away
+    db_handler->setMutationListener(nullptr);
+    SessionManager::getInstance()->setListener(nullptr);
+    ReplicationLogs->log("Destroying the ReplicationLeader object along with its resources");
+    delete ReplicationLogs;
+}
+
+// Starts listening for followers and registers for the database changes
+bool ReplicationLeader::StartReplication(const QHostAddress &address, quint16 port)
+{
+    // Without a secret anyone reaching the port would get every account
+    if (secret.isEmpty())
+    {
+        ReplicationLogs->log("Replication needs a shared secret", Logger::Error);
+        return false;
+    }
+
+    if (!this->listen(address, port))
+    {
+        ReplicationLogs->log("Replication cannot listen on " + address.toString() + ":" + QString::number(port), Logger::Error);
+        return false;
+    }
+
+    db_handler->setMutationListener([this](const QJsonObject &record) { publish(record); });
+    SessionManager::getInstance()->setListener([this](const QJsonObject &record) { publish(record); }); // Followers accept the same session tokens, replicated as digests only
+    ReplicationLogs->log("Replication is listening for followers on " + address.toString() + ":" + QString::number(port));
+    return true;
+}
+
+// Returns the HMAC-SHA256 of a role and a nonce keyed by the shared secret, in hex
+QByteArray ReplicationLeader::challengeResponse(const QByteArray &secret, const QString &role, const QByteArray &nonce)
+{
+    return QMessageAuthenticationCode::hash(role.toLatin1() + ':' + nonce, secret, QCryptographicHash::Sha256).toHex();
+}
+
+// Returns 256 random bits in hex
+QByteArray ReplicationLeader::newNonce()
+{
+    quint32 words[8];
+    QRandomGenerator::system()->fillRange(words);
+    return QByteArray(reinterpret_cast<const char*>(words), sizeof(words)).toHex();
+}
+
+// Compares every byte so the time taken does not tell how much of the answer was right
+bool ReplicationLeader::sameResponse(const QByteArray &response, const QByteArray &expected)
+{
+    if (response.size() != expected.size())
+    {
+        return false;
+    }
+
+    char difference = 0;
+    for (qsizetype i = 0; i < expected.size(); ++i)
+    {
+        difference |= response.at(i) ^ expected.at(i);
+    }
+    return difference == 0;
+}
+
+// Queues a record to the leader's thread, as the shards call this from their executor threads
+void ReplicationLeader::publish(const QJsonObject &record)
+{
+    QMetaObject::invokeMethod(this, [this, record]() { broadcast(record); }, Qt::QueuedConnection);
+}
+
+// Sends a random challenge to every newly connected follower
+void ReplicationLeader::onNewConnection()
+{
+    while (hasPendingConnections())
+    {
+        QTcpSocket *follower = nextPendingConnection();
+        connect(follower, &QTcpSocket::disconnected, this, &ReplicationLeader::onFollowerDisconnected);
+        connect(follower, &QTcpSocket::readyRead, this, &ReplicationLeader::onFollowerReadyRead);
+
+        QByteArray nonce = newNonce();
+        challenges.insert(follower, nonce);
+
+        QJsonObject challenge;
+        challenge["Op"] = "Challenge";
+        challenge["Nonce"] = QString::fromLatin1(nonce);
+        sendRecord(follower, challenge);
+
+        // A follower that does not answer in time is dropped
+        QTimer::singleShot(authTimeout, follower, [this, follower]()
+        {
+            if (challenges.contains(follower))
+            {
+                ReplicationLogs->log("Follower " + follower->peerAddress().toString() + " did not answer its challenge", Logger::Warning);
+                follower->disconnectFromHost();
+            }
+        });
+    }
+}
+
+// Checks the answer of a follower to its challenge; only a follower knowing the secret gets the snapshot
+void ReplicationLeader::onFollowerReadyRead()
+{
+    QTcpSocket *follower = qobject_cast<QTcpSocket*>(sender());
+
+    // Authenticated followers have nothing more to say
+    if (!challenges.contains(follower))
+    {
+        follower->readAll();
+        return;
+    }
+
+    if (!follower->canReadLine())
+    {
+        if (follower->bytesAvailable() > maxAnswerLength)
+        {
+            ReplicationLogs->log("Follower " + follower->peerAddress().toString() + " sent an oversized answer", Logger::Warning);
+            challenges.remove(follower);
+            follower->disconnectFromHost();
+        }
+        return;
+    }
+
+    QJsonObject answer = QJsonDocument::fromJson(follower->readLine(maxAnswerLength + 1).trimmed()).object();
+    QByteArray expected = challengeResponse(secret, "Follower", challenges.take(follower));
+    QByteArray response = answer.value("Response").toString().toLatin1();
+    QByteArray followerNonce = answer.value("Nonce").toString().toLatin1();
+
+    if ((answer.value("Op").toString() != "Auth") || followerNonce.isEmpty() || !sameResponse(response, expected))
+    {
+        ReplicationLogs->log("Follower " + follower->peerAddress().toString() + " failed to authenticate", Logger::Warning);
+        follower->disconnectFromHost();
+        return;
+    }
+
+    // Answer the follower's challenge, so it knows the snapshot comes from a server with the secret
+    QJsonObject proof;
+    proof["Op"] = "Proof";
+    proof["Response"] = QString::fromLatin1(challengeResponse(secret, "Leader", followerNonce));
+    sendRecord(follower, proof);
+
+    sendSnapshot(follower);
+}
+
+// Sends the current accounts to an authenticated follower
+void ReplicationLeader::sendSnapshot(QTcpSocket *follower)
+{
+    QJsonObject dbResponse = db_handler->viewBankDB();
+
+    // An empty database is a valid snapshot, an unreadable one is not
+    if (!dbResponse.value("State").toBool() && (dbResponse.value("Reason").toInt() != -1))
+    {
+        ReplicationLogs->log("Cannot send a snapshot to follower " + follower->peerAddress().toString());
+        follower->disconnectFromHost();
+        return;
+    }
+
+    // Changes already queued before the snapshot are sent again afterwards, which is harmless
+    // since every record carries the whole account
+    QJsonObject record;
+    record["Op"] = "Snapshot";
+    record["DataBase"] = dbResponse.value("DataBase").toObject();
+    record["Sequence"] = QString::number(sequence);
+    sendRecord(follower, record);
+
+    // Followers also need the open sessions to serve the reads of logged in users
+    QJsonObject sessions = SessionManager::getInstance()->snapshot();
+    sessions["Sequence"] = QString::number(sequence);
+    sendRecord(follower, sessions);
+
+    followers.append(follower);
+    ReplicationLogs->log("Follower " + follower->peerAddress().toString() + " connected at sequence " + QString::number(sequence));
+}
+
+// Removes a disconnected follower from the list
+void ReplicationLeader::onFollowerDisconnected()
+{
+    QTcpSocket *follower = qobject_cast<QTcpSocket*>(sender());
+    followers.removeAll(follower);
+    challenges.remove(follower);
+    follower->deleteLater();
+    ReplicationLogs->log("Follower " + follower->peerAddress().toString() + " disconnected");
+}
+
+// Sends a change record to every follower
+void ReplicationLeader::broadcast(QJsonObject record)
+{
+    record["Sequence"] = QString::number(++sequence);
+    for (QTcpSocket *follower : followers)
+    {
+        sendRecord(follower, record);
+    }
+}
+
+// Writes a record as one compact JSON line
+void ReplicationLeader::sendRecord(QTcpSocket *follower, const QJsonObject &record)
+{
+    follower->write(QJsonDocument(record).toJson(QJsonDocument::Compact) + '\n');
+}
@@ -0,0 +1,81 @@
+#ifndef REPLICATIONLEADER_H
+#define REPLICATIONLEADER_H
+
+#include <QObject>       // Includes the base class for all Qt objects
+#include <QTcpServer>    // Includes the class for TCP server functionalities
+#include <QTcpSocket>    // Includes the QTcpSocket class used for the follower connections
+#include <QJsonObject>   // Includes the QJsonObject class for the change records
+#include <QJsonDocument> // Includes the QJsonDocument class for serializing the change records
+#include <QList>         // Includes the QList class for the list of followers
+#include <QHash>         // Includes the QHash class for the followers still authenticating
+#include <QHostAddress>  // Includes the QHostAddress class for the listening address
+#include <QMessageAuthenticationCode> // Includes the HMAC used to authenticate the followers
+#include <QRandomGenerator> // Includes the QRandomGenerator class for the challenge nonces
+#include <QTimer>        // Includes the QTimer class for the challenge timeout
+#include <memory>        // Includes smart pointers such as std::shared_ptr
+#include "DataBaseHandler.h"
+#include "Logger.h"
+
+// The ReplicationLeader class streams the account changes of this server to follower servers.
+// A follower connecting to it is sent a random challenge and must answer with the HMAC of it keyed
+// by the shared secret, together with a challenge of its own that the leader answers the same way,
+// so each side knows the other has the secret. Only then does the follower receive a snapshot of
+// all accounts, then every stored or erased account as one compact JSON record per line.
+class ReplicationLeader : public QTcpServer
+{
+    Q_OBJECT // Macro to enable Qt's meta-object system, including signals and slots
+
+public:
+    // Constructor for ReplicationLeader. Initializes the server with the secret shared with the followers.
+    explicit ReplicationLeader(const QByteArray &secret, QObject *parent = nullptr);
+    ~ReplicationLeader();
+
+    // Method to start listening for followers on the given address and port.
+    bool StartReplication(const QHostAddress &address, quint16 port);
+
+    // Method to compute the answer of a role ("Leader" or "Follower") to a challenge: the HMAC-SHA256
+    // of the role and the nonce keyed by the secret, in hex. The role keeps an answer of one side from
+    // being replayed as an answer of the other.
+    static QByteArray challengeResponse(const QByteArray &secret, const QString &role, const QByteArray &nonce);
+
+    // Method to make a random challenge nonce, in hex.
+    static QByteArray newNonce();
+
+    // Method to compare an answer with the expected one in a time that does not depend on where they differ.
+    static bool sameResponse(const QByteArray &response, const QByteArray &expected);
+
+    // Method to queue a change record for all followers. Safe to call from any thread.
+    void publish(const QJsonObject &record);
+
+private slots:
+    // Slot to send a challenge to a newly connected follower.
+    void onNewConnection();
+
+    // Slot to check the answer of a follower to its challenge and send it the snapshot.
+    void onFollowerReadyRead();
+
+    // Slot to forget a follower that disconnected.
+    void onFollowerDisconnected();
+
+private:
+    // Method to send a record to every follower; runs on the leader's thread.
+    void broadcast(QJsonObject record);
+
+    // Method to send the snapshot to an authenticated follower and start streaming to it.
+    void sendSnapshot(QTcpSocket *follower);
+
+    // Method to write one record line to a follower.
+    void sendRecord(QTcpSocket *follower, const QJsonObject &record);
+
+    std::shared_ptr<DataBaseHandler> db_handler; // Database whose changes are streamed.
+    QByteArray secret; // Secret the followers must prove to know.
+    QHash<QTcpSocket*, QByteArray> challenges; // Nonces sent to the followers that have not answered yet.
+    QList<QTcpSocket*> followers; // Authenticated follower sockets.
+    quint64 sequence; // Sequence number of the last record sent.
+    Logger *ReplicationLogs;
+
+    static constexpr qint32 authTimeout = 5000; // Milliseconds a follower has to answer its challenge.
+    static constexpr qint32 maxAnswerLength = 256; // Longest answer line accepted from a follower.
+};
+
+#endif // REPLICATIONLEADER_H
@@ -1,13 +1,15 @@
 #include "RequestHandler.h"
 
-// Initialize the static mutex for synchronizing access across instances
-QMutex RequestHandler::globalMutex;
-
 // Constructor for RequestHandler
-RequestHandler::RequestHandler()
+RequestHandler::RequestHandler(bool secureTransport, quint64 connectionID)
+    : connectionID{connectionID}, secureTransport{secureTransport}
 {
     // Initialize the database handler instance using a shared pointer
     db_handler = std::shared_ptr<DataBaseHandler>(DataBaseHandler::getInstance());
+    sessions = SessionManager::getInstance();
+    idempotency = IdempotencyCache::getInstance();
+    admission = AdmissionControl::getInstance();
+    subscriptions = SubscriptionManager::getInstance();
     RequestLogs = new Logger("Logs/RequestLogs.txt");
 }
 
@@ -20,6 +22,13 @@ RequestHandler::~RequestHandler()
 // Validates the hash in the JSON request to ensure data integrity
 bool RequestHandler::validateHashRequest(QJsonObject &requestObject)
 {
+    // TLS already detects tampering and corruption; a hash sent anyway is ignored
+    if (secureTransport)
+    {
+        requestObject.remove("Hash");
+        return true;
+    }
+
     // Extract the hash from the JSON request
     QString receivedHashHex = requestObject.value("Hash").toString();
     QByteArray receivedHash = QByteArray::fromHex(receivedHashHex.toUtf8());
@@ -51,6 +60,11 @@ bool RequestHandler::validateHashRequest(QJsonObject &requestObject)
 // Adds a hash to the response object to ensure its integrity
 void RequestHandler::hashResponse(QJsonObject &responseObject)
 {
+    if (secureTransport)
+    {
+        return;
+    }
+
     // Convert the JSON object to a JSON document
     QJsonDocument responseDoc(responseObject);
 
@@ -62,6 +76,431 @@ void RequestHandler::hashResponse(QJsonObject &responseObject)
     responseObject["Hash"] = QString((hashedResponse.result()).toHex());
 }
 
+// Returns true for the requests that modify the database
+bool RequestHandler::isWriteRequest(qint32 processID)
+{
+    switch (processID)
+    {
+    case CreateUser_ID:
+    case UpDateUser_ID:
+    case DeleteUser_ID:
+    case MakeTransaction_ID:
+    case TransferAmount_ID:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Checks the session token of a request and that its user may run the request.
+// Returns 0 if allowed, otherwise the reason code of the rejection.
+qint32 RequestHandler::authorizeRequest(qint32 processID, QJsonObject &requestObject, SessionManager::Session &session)
+{
+    // The login opens the session, so it is the only request without a token
+    if (processID == LogIn_ID)
+    {
+        return 0;
+    }
+
+    QString token = requestObject.value("SessionToken").toString();
+    requestObject.remove("SessionToken"); // The token is not part of the request data
+
+    if (!sessions->findSession(token, session))
+    {
+        return -9; // Missing, unknown or expired session
+    }
+
+    return checkAccess(processID, requestObject, session);
+}
+
+// Checks that the user of a session may run a request.
+// Returns 0 if allowed, otherwise -10.
+qint32 RequestHandler::checkAccess(qint32 processID, const QJsonObject &requestObject, const SessionManager::Session &session)
+{
+    if (session.isAdmin || (processID == Batch_ID))
+    {
+        return 0; // Admins may run every request on every account; batch items are checked one by one
+    }
+
+    // Users may only run requests on their own account
+    switch (processID)
+    {
+    case GetAccount_ID:
+        return (requestObject.value("UserName").toString() == session.userName) ? 0 : -10;
+
+    case GetBalance_ID:
+    case ViewTransactionHistory_ID:
+    case MakeTransaction_ID:
+        return (requestObject.value("AccountNumber").toString() == session.accountNumber) ? 0 : -10;
+
+    case TransferAmount_ID:
+        return (requestObject.value("SenderAccountNumber").toString() == session.accountNumber) ? 0 : -10;
+
+    case Subscribe_ID:
+    case Unsubscribe_ID:
+        for (const QJsonValue &accountNumber : requestObject.value("AccountNumbers").toArray())
+        {
+            if (accountNumber.toString() != session.accountNumber)
+            {
+                return -10;
+            }
+        }
+        return 0;
+
+    default:
+        return -10; // Admin only request
+    }
+}
+
+// Starts or stops the change events of accounts on this connection
+QJsonObject RequestHandler::handleSubscription(const QJsonObject &requestObject, bool subscribe)
+{
+    QJsonObject jResponse;
+    QStringList accountNumbers;
+    for (const QJsonValue &accountNumber : requestObject.value("AccountNumbers").toArray())
+    {
+        accountNumbers.append(accountNumber.toString());
+    }
+
+    if (!subscribe)
+    {
+        // An empty list stops all events of the connection
+        RequestLogs->log("Handle unsubscribe request");
+        jResponse["State"] = subscriptions->unsubscribe(connectionID, accountNumbers);
+        return jResponse;
+    }
+
+    RequestLogs->log("Handle subscribe request");
+    if (accountNumbers.isEmpty() || !subscriptions->subscribe(connectionID, accountNumbers))
+    {
+        jResponse["State"] = false;
+        jResponse["Reason"] = -7; // Nothing to subscribe to, or a connection without events
+        return jResponse;
+    }
+
+    // Read the balances after subscribing, so no change falls between the balance and the first event
+    QJsonObject balances;
+    QStringList unknown;
+    for (const QString &accountNumber : accountNumbers)
+    {
+        QJsonObject balance;
+        balance["AccountNumber"] = accountNumber;
+        balance = db_handler->viewAccount_Balance(balance);
+        if (balance.value("State").toBool())
+        {
+            balances[accountNumber] = balance.value("AccountBalance");
+        }
+        else
+        {
+            unknown.append(accountNumber);
+        }
+    }
+
+    // Accounts that do not exist are not watched
+    if (!unknown.isEmpty())
+    {
+        subscriptions->unsubscribe(connectionID, unknown);
+        jResponse["State"] = false;
+        jResponse["Reason"] = -1; // Account number not found
+        jResponse["Balances"] = balances;
+        return jResponse;
+    }
+
+    jResponse["State"] = true;
+    jResponse["Balances"] = balances;
+    return jResponse;
+}
+
+// Runs the sub-requests of a batch with a single hash validation and session lookup.
+// Best-effort batches run every allowed item and report each result; all-or-nothing batches
+// only accept MakeTransaction and TransferAmount items and apply either all of them or none.
+QJsonObject RequestHandler::handleBatch(const QJsonObject &requestObject, const SessionManager::Session &session)
+{
+    QJsonObject jResponse;
+    QJsonArray requests = requestObject.value("Requests").toArray();
+    bool allOrNothing = requestObject.value("AllOrNothing").toBool();
+    QList<qint32> reasons; // Rejection reason of each item, 0 if it may run
+    bool allAllowed = true;
+
+    // Check every item before running any of them
+    for (const QJsonValue &value : requests)
+    {
+        QJsonObject item = value.toObject();
+        qint32 itemID = item.value("RequestID").toInt();
+        qint32 reason;
+
+        if (!value.isObject() || (itemID == LogIn_ID) || (itemID == Batch_ID))
+        {
+            reason = -7; // Not a request that can be batched
+        }
+        else if (db_handler->isReadOnly() && isWriteRequest(itemID))
+        {
+            reason = -8; // Write request on a read-only replica
+        }
+        else if (allOrNothing && (itemID != MakeTransaction_ID) && (itemID != TransferAmount_ID))
+        {
+            reason = -11; // Request that cannot be rolled back
+        }
+        else
+        {
+            reason = checkAccess(itemID, item, session);
+        }
+
+        reasons.append(reason);
+        allAllowed = allAllowed && (reason == 0);
+    }
+
+    if (allOrNothing)
+    {
+        if (!allAllowed)
+        {
+            // Nothing runs if any item is rejected
+            RequestLogs->log("All-or-nothing batch rejected");
+            QJsonArray results;
+            for (qint32 i = 0; i < reasons.size(); i++)
+            {
+                QJsonObject result;
+                result["State"] = false;
+                result["Reason"] = (reasons[i] != 0) ? reasons[i] : -12; // -12: not applied
+                results.append(result);
+            }
+            jResponse["State"] = false;
+            jResponse["Reason"] = -12;
+            jResponse["Results"] = results;
+        }
+        else
+        {
+            RequestLogs->log("Handle all-or-nothing batch of " + QString::number(requests.size()) + " requests");
+            jResponse = db_handler->transactBatch(requests);
+        }
+
+        // Tag every result with the request ID of its item
+        QJsonArray results = jResponse.value("Results").toArray();
+        for (qint32 i = 0; i < results.size(); i++)
+        {
+            QJsonObject result = results.at(i).toObject();
+            result["ResponseID"] = requests.at(i).toObject().value("RequestID").toInt();
+            results.replace(i, result);
+        }
+        jResponse["Results"] = results;
+        return jResponse;
+    }
+
+    // Best-effort batch: the shards write their changes once the whole batch is done
+    RequestLogs->log("Handle batch of " + QString::number(requests.size()) + " requests");
+    QJsonArray results;
+    db_handler->beginBatch();
+    for (qint32 i = 0; i < requests.size(); i++)
+    {
+        QJsonObject item = requests.at(i).toObject();
+        qint32 itemID = item.value("RequestID").toInt();
+        QJsonObject result;
+
+        if (reasons[i] != 0)
+        {
+            result["State"] = false;
+            result["Reason"] = reasons[i];
+        }
+        else
+        {
+            result = dispatchRequest(itemID, item);
+        }
+
+        result["ResponseID"] = itemID;
+        results.append(result);
+    }
+    db_handler->endBatch();
+
+    jResponse["State"] = true;
+    jResponse["Results"] = results;
+    return jResponse;
+}
+
+// Runs a single request on the database based on its ID
+QJsonObject RequestHandler::dispatchRequest(qint32 processID, QJsonObject &requestObj)
+{
+    QJsonObject db_response; // Object to hold the database response
+
+    // Process the request based on its ID.
+    // No global lock is taken: the database routes each operation to the shard owning the account,
+    // and every shard runs its operations in order on its own executor thread.
+    switch(processID)
+    {
+    case LogIn_ID:
+        RequestLogs->log("Handle logIn request");
+        db_handler->DBLogs->log("Handle logIn request");
+        db_response = db_handler->logIn(requestObj);
+        break;
+
+    case CreateUser_ID:
+        RequestLogs->log("Handle createUser request");
+        db_handler->DBLogs->log("Handle createUser request");
+        db_response = db_handler->createUser(requestObj);
+        break;
+
+    case UpDateUser_ID:
+        RequestLogs->log("Handle updateUser request");
+        db_handler->DBLogs->log("Handle updateUser request");
+        db_response = db_handler->updateUser(requestObj);
+        break;
+
+    case DeleteUser_ID:
+        RequestLogs->log("Handle deleteUser request");
+        db_handler->DBLogs->log("Handle deleteUser request");
+        db_response = db_handler->deleteUser(requestObj);
+        break;
+
+    case ViewBankDB_ID:
+        RequestLogs->log("Handle viewBankDB request");
+        db_handler->DBLogs->log("Handle viewBankDB request");
+        db_response = db_handler->viewBankDB(requestObj);
+        break;
+
+    case GetAccount_ID:
+        RequestLogs->log("Handle getAccount_Number request");
+        db_handler->DBLogs->log("Handle getAccount_Number request");
+        db_response = db_handler->getAccount_Number(requestObj);
+        break;
+
+    case GetBalance_ID:
+        RequestLogs->log("Handle viewAccount_Balance request");
+        db_handler->DBLogs->log("Handle viewAccount_Balance request");
+        db_response = db_handler->viewAccount_Balance(requestObj);
+        break;
+
+    case ViewTransactionHistory_ID:
+        RequestLogs->log("Handle viewTransaction_History request");
+        db_handler->DBLogs->log("Handle viewTransaction_History request");
+        db_response = db_handler->viewTransaction_History(requestObj);
+        break;
+
+    case MakeTransaction_ID:
+        RequestLogs->log("Handle makeTransaction request");
+        db_handler->DBLogs->log("Handle makeTransaction request");
+        db_response = db_handler->makeTransaction(requestObj);
+        break;
+
+    case TransferAmount_ID:
+        RequestLogs->log("Handle transferAmount request");
+        db_handler->DBLogs->log("Handle transferAmount request");
+        db_response = db_handler->transferAmount(requestObj);
+        break;
+
+    case Summary_ID:
+        RequestLogs->log("Handle summary request");
+        db_handler->DBLogs->log("Handle summary request");
+        db_response = db_handler->summary(requestObj);
+        break;
+
+    case TopAccounts_ID:
+        RequestLogs->log("Handle topAccounts request");
+        db_handler->DBLogs->log("Handle topAccounts request");
+        db_response = db_handler->topAccounts(requestObj);
+        break;
+
+    case BalanceRange_ID:
+        RequestLogs->log("Handle balanceRange request");
+        db_handler->DBLogs->log("Handle balanceRange request");
+        db_response = db_handler->balanceRange(requestObj);
+        break;
+
+    case Search_ID:
+        RequestLogs->log("Handle search request");
+        db_handler->DBLogs->log("Handle search request");
+        db_response = db_handler->search(requestObj);
+        break;
+
+    case Subscribe_ID:
+        db_response = handleSubscription(requestObj, true);
+        break;
+
+    case Unsubscribe_ID:
+        db_response = handleSubscription(requestObj, false);
+        break;
+
+    default:
+        // Handle unknown request ID
+        RequestLogs->log("Unknown request");
+        db_response["State"] = false;
+        db_response["Reason"] = -7;
+        break;
+    }
+
+    return db_response;
+}
+
+// Runs a request that passed the checks, either a batch or a single request
+QJsonObject RequestHandler::runRequest(qint32 processID, QJsonObject &requestObj, const SessionManager::Session &session)
+{
+    if (processID == Batch_ID)
+    {
+        // Run the sub-requests of a batch under the session checked above
+        return handleBatch(requestObj, session);
+    }
+    return dispatchRequest(processID, requestObj);
+}
+
+// Runs a write request at most once per idempotency key
+QJsonObject RequestHandler::handleIdempotent(qint32 processID, QJsonObject &requestObj, const SessionManager::Session &session)
+{
+    QJsonObject db_response;
+
+    // Keys are scoped to the account of the session, so clients cannot see each other's responses
+    QString key = session.accountNumber + ":" + requestObj.value("IdempotencyKey").toString();
+    requestObj.remove("IdempotencyKey"); // The key is not part of the request data
+
+    // A key sent again with other request data is a client error, not a retry
+    QByteArray fingerprint = QCryptographicHash::hash(QJsonDocument(requestObj).toJson(QJsonDocument::Compact), QCryptographicHash::Sha256);
+
+    switch (idempotency->begin(key, fingerprint, db_response))
+    {
+    case IdempotencyCache::Started:
+        db_response = runRequest(processID, requestObj, session);
+        idempotency->finish(key, db_response);
+        break;
+
+    case IdempotencyCache::Replayed:
+        RequestLogs->log("Replayed the response of a retried request");
+        db_response["Replayed"] = true;
+        break;
+
+    case IdempotencyCache::Mismatch:
+        RequestLogs->log("Idempotency key reused with a different request");
+        db_response["State"] = false;
+        db_response["Reason"] = -14;
+        break;
+
+    case IdempotencyCache::Busy:
+        RequestLogs->log("Request with the same idempotency key still in progress");
+        db_response["State"] = false;
+        db_response["Reason"] = -13;
+        break;
+    }
+
+    return db_response;
+}
+
+// Builds the response refusing a request without running it, e.g. when its connection is over its rate
+QByteArray RequestHandler::rejectRequest(const QByteArray &request, qint32 reason)
+{
+    QJsonObject db_response;
+    db_response["State"] = false;
+    db_response["Reason"] = reason;
+    db_response["ResponseID"] = QJsonDocument::fromJson(request).object().value("RequestID").toInt();
+    hashResponse(db_response);
+
+    return QJsonDocument(db_response).toJson();
+}
+
+// Builds the message of an account change event, hashed like a response
+QByteArray RequestHandler::eventMessage(QJsonObject event)
+{
+    event["ResponseID"] = Event_ID;
+    hashResponse(event);
+
+    return QJsonDocument(event).toJson();
+}
+
 // Handles the incoming request and generates a response
 QByteArray RequestHandler::handleReaquest(const QByteArray &request)
 {
@@ -72,91 +511,63 @@ QByteArray RequestHandler::handleReaquest(const QByteArray &request)
     QJsonDocument docResponse; // JSON document for the response
     QByteArray response; // Byte array to hold the final response
     qint32 processID = requestObj.value("RequestID").toInt(); // Extract the request ID
+    SessionManager::Session session; // User of the request, filled by the session check
 
     // Validate the request's hash before processing
-    if (validateHashRequest(requestObj))
-    {
-        // Lock the global mutex to ensure thread-safe access to the database
-        QMutexLocker locker(&globalMutex);
-
-        // Process the request based on its ID
-        switch(processID)
-        {
-        case LogIn_ID:
-            RequestLogs->log("Handle logIn request");
-            db_handler->DBLogs->log("Handle logIn request");
-            db_response = db_handler->logIn(requestObj);
-            break;
-
-        case CreateUser_ID:
-            RequestLogs->log("Handle createUser request");
-            db_handler->DBLogs->log("Handle createUser request");
-            db_response = db_handler->createUser(requestObj);
-            break;
-
-        case UpDateUser_ID:
-            RequestLogs->log("Handle updateUser request");
-            db_handler->DBLogs->log("Handle updateUser request");
-            db_response = db_handler->updateUser(requestObj);
-            break;
-
-        case DeleteUser_ID:
-            RequestLogs->log("Handle deleteUser request");
-            db_handler->DBLogs->log("Handle deleteUser request");
-            db_response = db_handler->deleteUser(requestObj);
-            break;
-
-        case ViewBankDB_ID:
-            RequestLogs->log("Handle viewBankDB request");
-            db_handler->DBLogs->log("Handle viewBankDB request");
-            db_response = db_handler->viewBankDB();
-            break;
-
-        case GetAccount_ID:
-            RequestLogs->log("Handle getAccount_Number request");
-            db_handler->DBLogs->log("Handle getAccount_Number request");
-            db_response = db_handler->getAccount_Number(requestObj);
-            break;
-
-        case GetBalance_ID:
-            RequestLogs->log("Handle viewAccount_Balance request");
-            db_handler->DBLogs->log("Handle viewAccount_Balance request");
-            db_response = db_handler->viewAccount_Balance(requestObj);
-            break;
-
-        case ViewTransactionHistory_ID:
-            RequestLogs->log("Handle viewTransaction_History request");
-            db_handler->DBLogs->log("Handle viewTransaction_History request");
-            db_response = db_handler->viewTransaction_History(requestObj);
-            break;
-
-        case MakeTransaction_ID:
-            RequestLogs->log("Handle makeTransaction request");
-            db_handler->DBLogs->log("Handle makeTransaction request");
-            db_response = db_handler->makeTransaction(requestObj);
-            break;
-
-        case TransferAmount_ID:
-            RequestLogs->log("Handle transferAmount request");
-            db_handler->DBLogs->log("Handle transferAmount request");
-            db_response = db_handler->transferAmount(requestObj);
-            break;
-
-        default:
-            // Handle unknown request ID
-            RequestLogs->log("Unknown request");
-            db_response["State"] = false;
-            db_response["Reason"] = -7;
-            break;
-        }
-    }
-    else
+    if (!validateHashRequest(requestObj))
     {
         // Handle invalid request hash
         RequestLogs->log("Invalid request hash");
         db_response["State"] = false;
         db_response["Reason"] = -6;
     }
+    else if (processID == Ping_ID)
+    {
+        // Heartbeat keeping an idle connection open; needs no session and touches no data
+        db_response["State"] = true;
+        db_response["ServerTime"] = QString::number(QDateTime::currentMSecsSinceEpoch());
+    }
+    else if (qint32 reason = authorizeRequest(processID, requestObj, session))
+    {
+        // Handle requests without a valid session or not allowed for the session's user
+        RequestLogs->log(reason == -9 ? "Invalid session token" : "Request not allowed for this user");
+        db_response["State"] = false;
+        db_response["Reason"] = reason;
+    }
+    else if (!session.accountNumber.isEmpty() && !admission->allowAccount(session.accountNumber))
+    {
+        // One account may not flood the server, whichever connections it uses
+        RequestLogs->log("Request rate of account " + session.accountNumber + " exceeded");
+        db_response["State"] = false;
+        db_response["Reason"] = -16;
+    }
+    else if (db_handler->isReadOnly() && isWriteRequest(processID))
+    {
+        // A follower only serves reads; writes go to the replication leader
+        RequestLogs->log("Write request rejected by read-only replica");
+        db_response["State"] = false;
+        db_response["Reason"] = -8;
+    }
+    else if (!admission->acquireSlot())
+    {
+        // Shed the request instead of queueing it behind too many others
+        RequestLogs->log("Server busy, request shed");
+        db_response["State"] = false;
+        db_response["Reason"] = -15;
+    }
+    else
+    {
+        if (requestObj.contains("IdempotencyKey") && (isWriteRequest(processID) || (processID == Batch_ID)))
+        {
+            // A retried write returns the response of its first run instead of running again
+            db_response = handleIdempotent(processID, requestObj, session);
+        }
+        else
+        {
+            db_response = runRequest(processID, requestObj, session);
+        }
+        admission->releaseSlot();
+    }
 
     // Add the response ID and hash to the response object
     db_response["ResponseID"] = processID;
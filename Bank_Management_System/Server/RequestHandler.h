@@ -6,10 +6,13 @@
 #include <QJsonArray>         // Includes the QJsonArray class for handling JSON arrays
 #include <QJsonValue>         // Includes the QJsonValue class for handling JSON values
 #include <QCryptographicHash> // Includes the QCryptographicHash class for hashing operations
-#include <QMutex>             // Includes the QMutex class for thread synchronization
 #include <memory>             // Includes smart pointers such as std::unique_ptr
 #include <QDebug>             // Includes the QDebug class for logging and debugging
 #include "DataBaseHandler.h"  // Includes the header file for handling database operations
+#include "SessionManager.h"   // Includes the header file for the login sessions
+#include "IdempotencyCache.h" // Includes the header file for the responses of retried writes
+#include "AdmissionControl.h" // Includes the header file for the rate limits and the request queue
+#include "SubscriptionManager.h" // Includes the header file for the account change events
 #include "Logger.h"
 
 // The RequestHandler class is responsible for processing client requests and interacting with the database.
@@ -18,17 +21,31 @@ class RequestHandler
 {
 public:
     // Constructor to initialize the RequestHandler object.
-    RequestHandler();
+    // On a TLS connection (secureTransport) the requests and responses carry no hash,
+    // since TLS already protects their integrity. connectionID identifies the connection
+    // in the SubscriptionManager; without one (0), Subscribe requests are rejected.
+    explicit RequestHandler(bool secureTransport = false, quint64 connectionID = 0);
     ~RequestHandler();
 
     // Method to handle a request from the client.
     // The request is provided as a QByteArray, and the method returns a QByteArray response.
     QByteArray handleReaquest(const QByteArray &request);
 
+    // Method to build the response refusing a request with the given reason without running it.
+    QByteArray rejectRequest(const QByteArray &request, qint32 reason);
+
+    // Method to build the message pushing an account change event to a subscribed client.
+    QByteArray eventMessage(QJsonObject event);
+
 private:
     std::shared_ptr<DataBaseHandler> db_handler; // Shared pointer to the DataBaseHandler instance used for database operations
-    static QMutex globalMutex;   // Static mutex for synchronizing access to shared resources across instances
+    std::shared_ptr<SessionManager> sessions; // Shared pointer to the SessionManager instance holding the login sessions
+    std::shared_ptr<IdempotencyCache> idempotency; // Shared pointer to the IdempotencyCache instance holding the responses of keyed writes
+    std::shared_ptr<AdmissionControl> admission; // Shared pointer to the AdmissionControl instance limiting the load
+    std::shared_ptr<SubscriptionManager> subscriptions; // Shared pointer to the SubscriptionManager instance pushing account changes
+    quint64 connectionID; // Connection of this handler, used for its subscriptions
     Logger *RequestLogs;
+    bool secureTransport; // Set when the connection uses TLS, which makes the payload hash redundant
 
     // Enumeration of request IDs for identifying different types of requests.
     enum requestIDs {
@@ -41,15 +58,54 @@ private:
         GetBalance_ID = 6,
         ViewTransactionHistory_ID = 7,
         MakeTransaction_ID = 8,
-        TransferAmount_ID = 9
+        TransferAmount_ID = 9,
+        Batch_ID = 10,
+        Ping_ID = 11,
+        Summary_ID = 12,
+        TopAccounts_ID = 13,
+        BalanceRange_ID = 14,
+        Search_ID = 15,
+        Subscribe_ID = 16,
+        Unsubscribe_ID = 17,
+        Event_ID = 18 // Response ID of the events pushed to subscribed clients, not a request
     };
 
     // Method to validate the hash in the request object.
-    // Returns true if the hash is valid, otherwise false.
+    // Returns true if the hash is valid or the connection uses TLS, otherwise false.
     bool validateHashRequest(QJsonObject &requestObject);
 
-    // Method to generate a hash for the response object.
+    // Method to check the session token of a request and the rights of its user.
+    // Returns 0 if the request may run, -9 for an invalid or expired session,
+    // or -10 if the user may not run the request.
+    qint32 authorizeRequest(qint32 processID, QJsonObject &requestObject, SessionManager::Session &session);
+
+    // Method to check if the user of a session may run a request. Returns 0 or -10.
+    static qint32 checkAccess(qint32 processID, const QJsonObject &requestObject, const SessionManager::Session &session);
+
+    // Method to run a single request on the database.
+    QJsonObject dispatchRequest(qint32 processID, QJsonObject &requestObj);
+
+    // Method to run a request that passed the checks, either a batch or a single request.
+    QJsonObject runRequest(qint32 processID, QJsonObject &requestObj, const SessionManager::Session &session);
+
+    // Method to run a write request carrying an IdempotencyKey at most once.
+    // Retries get the original response; Reason -13 if the original is still running,
+    // -14 if the key was used for a different request.
+    QJsonObject handleIdempotent(qint32 processID, QJsonObject &requestObj, const SessionManager::Session &session);
+
+    // Method to start or stop the change events of the accounts in "AccountNumbers" on this connection.
+    // Subscribing returns the current balances, so the client starts from a known state.
+    QJsonObject handleSubscription(const QJsonObject &requestObject, bool subscribe);
+
+    // Method to run the sub-requests of a Batch request and collect their results.
+    QJsonObject handleBatch(const QJsonObject &requestObject, const SessionManager::Session &session);
+
+    // Method to generate a hash for the response object; skipped on TLS connections.
     void hashResponse(QJsonObject &responseObject);
+
+    // Method to check if a request modifies the database.
+    // Read-only replicas reject these requests with Reason -8.
+    static bool isWriteRequest(qint32 processID);
 };
 
 #endif // REQUESTHANDLER_H
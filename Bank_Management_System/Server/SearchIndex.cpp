@@ -0,0 +1,175 @@
+#include "SearchIndex.h"
+
+// Adds an account; the names of an account already indexed are replaced
+void SearchIndex::insert(const QString &accountNumber, const QString &userName, const QString &fullName)
+{
+    if (entries.contains(accountNumber))
+    {
+        removeTerms(accountNumber, entries.value(accountNumber));
+    }
+
+    Entry entry{userName, fullName, userName.toLower(), fullName.toLower()};
+    addTerms(accountNumber, entry);
+    entries.insert(accountNumber, entry);
+}
+
+// Removes an account and all of its names
+void SearchIndex::remove(const QString &accountNumber)
+{
+    if (!entries.contains(accountNumber))
+    {
+        return;
+    }
+
+    removeTerms(accountNumber, entries.take(accountNumber));
+}
+
+// Checks if an account is indexed with these names, so unchanged accounts are not indexed again
+bool SearchIndex::contains(const QString &accountNumber, const QString &userName, const QString &fullName) const
+{
+    auto it = entries.constFind(accountNumber);
+    return (it != entries.constEnd()) && (it->userName == userName) && (it->fullName == fullName);
+}
+
+// Finds the accounts with a name or a word of the full name starting with the text
+QStringList SearchIndex::findPrefix(const QString &text, Field field, qint32 count) const
+{
+    QString key = text.toLower();
+    QStringList result;
+    QSet<QString> found; // An account may match with several words of its full name
+    if (key.isEmpty())
+    {
+        return result;
+    }
+
+    // The names starting with the text follow each other in the sorted list
+    auto walk = [&](const std::set<std::pair<QString, QString>> &names) {
+        for (auto it = names.lower_bound({key, QString()});
+             (it != names.end()) && it->first.startsWith(key) && ((count <= 0) || (result.size() < count));
+             ++it)
+        {
+            if (!found.contains(it->second))
+            {
+                found.insert(it->second);
+                result.append(it->second);
+            }
+        }
+    };
+
+    if (field & UserNameField)
+    {
+        walk(userNames);
+    }
+    if (field & FullNameField)
+    {
+        walk(fullNames);
+    }
+    return result;
+}
+
+// Finds the accounts with a name containing the text
+QStringList SearchIndex::findSubstring(const QString &text, Field field, qint32 count) const
+{
+    QString key = text.toLower();
+    QStringList result;
+    if (key.size() < trigramLength)
+    {
+        return result;
+    }
+
+    // Every match contains all trigrams of the text, so only the accounts of the rarest one are checked
+    const QSet<QString> *candidates = nullptr;
+    for (const QString &trigram : trigramsOf(key))
+    {
+        auto it = trigrams.constFind(trigram);
+        if (it == trigrams.constEnd())
+        {
+            return result; // No name contains this trigram
+        }
+        if (!candidates || (it->size() < candidates->size()))
+        {
+            candidates = &it.value();
+        }
+    }
+
+    // The candidates come in hash order, so every match is collected before the first count are taken
+    std::vector<std::pair<QString, QString>> matches; // (username, account number) pairs
+    for (const QString &accountNumber : *candidates)
+    {
+        auto entry = entries.constFind(accountNumber);
+        if (((field & UserNameField) && entry->userNameKey.contains(key))
+            || ((field & FullNameField) && entry->fullNameKey.contains(key)))
+        {
+            matches.emplace_back(entry->userName, accountNumber);
+        }
+    }
+
+    auto last = ((count > 0) && (static_cast<size_t>(count) < matches.size())) ? matches.begin() + count : matches.end();
+    std::partial_sort(matches.begin(), last, matches.end());
+
+    result.reserve(last - matches.begin());
+    for (auto it = matches.begin(); it != last; ++it)
+    {
+        result.append(it->second);
+    }
+    return result;
+}
+
+// Adds the names of an account to the sorted lists and its trigrams to the trigram lists
+void SearchIndex::addTerms(const QString &accountNumber, const Entry &entry)
+{
+    userNames.insert({entry.userNameKey, accountNumber});
+    fullNames.insert({entry.fullNameKey, accountNumber});
+    for (const QString &word : entry.fullNameKey.split(' ', Qt::SkipEmptyParts))
+    {
+        fullNames.insert({word, accountNumber});
+    }
+
+    for (const QString &trigram : trigramsOf(entry))
+    {
+        trigrams[trigram].insert(accountNumber);
+    }
+}
+
+// Removes the names and trigrams of an account
+void SearchIndex::removeTerms(const QString &accountNumber, const Entry &entry)
+{
+    userNames.erase({entry.userNameKey, accountNumber});
+    fullNames.erase({entry.fullNameKey, accountNumber});
+    for (const QString &word : entry.fullNameKey.split(' ', Qt::SkipEmptyParts))
+    {
+        fullNames.erase({word, accountNumber});
+    }
+
+    for (const QString &trigram : trigramsOf(entry))
+    {
+        auto it = trigrams.find(trigram);
+        if (it != trigrams.end())
+        {
+            it->remove(accountNumber);
+            if (it->isEmpty())
+            {
+                trigrams.erase(it); // Keep the table free of unused trigrams
+            }
+        }
+    }
+}
+
+// Returns the trigrams of both names of an account
+QSet<QString> SearchIndex::trigramsOf(const Entry &entry)
+{
+    QSet<QString> result = trigramsOf(entry.userNameKey);
+    result.unite(trigramsOf(entry.fullNameKey));
+    return result;
+}
+
+// Returns the trigrams of a text
+QSet<QString> SearchIndex::trigramsOf(const QString &text)
+{
+    QSet<QString> result;
+    for (qint32 i = 0; i + trigramLength <= text.size(); i++)
+    {
+        result.insert(text.mid(i, trigramLength));
+    }
+    return result;
+}
@@ -0,0 +1,75 @@
+#ifndef SEARCHINDEX_H
+#define SEARCHINDEX_H
+
+#include <QString>     // Includes the QString class for the names and account numbers
+#include <QStringList> // Includes the QStringList class for the search results
+#include <QHash>       // Includes the QHash class for the indexed names and the trigram lists
+#include <QSet>        // Includes the QSet class for the accounts containing a trigram
+#include <set>         // Includes std::set for the sorted name lists
+#include <utility>     // Includes std::pair for the entries of the sorted name lists
+#include <vector>      // Includes std::vector for the matches of a substring search
+#include <algorithm>   // Includes std::partial_sort for ordering the matches of a substring search
+
+// The SearchIndex class finds accounts by a part of their username or full name.
+// Prefix searches walk a sorted list of the lower-cased names, which also holds every word of
+// the full names, so "smi" finds "John Smith". Substring searches look up the trigrams
+// (three-character pieces) of the query and only check the accounts containing the rarest one.
+// Every account is added and removed on its own, so the index follows each change.
+// An index is not thread safe; its owner serializes the calls.
+class SearchIndex
+{
+public:
+    // Fields a search looks at.
+    enum Field
+    {
+        UserNameField = 1,
+        FullNameField = 2,
+        AnyField = UserNameField | FullNameField
+    };
+
+    // Method to add an account, replacing its previous names if it was already indexed.
+    void insert(const QString &accountNumber, const QString &userName, const QString &fullName);
+
+    // Method to remove an account.
+    void remove(const QString &accountNumber);
+
+    // Method to check if an account is indexed with exactly these names.
+    bool contains(const QString &accountNumber, const QString &userName, const QString &fullName) const;
+
+    // Methods to find the accounts whose names start with or contain the text, ignoring the case.
+    // At most count account numbers are returned (0: all). Substring searches need at least
+    // three characters; shorter texts find nothing. Their matches are ordered by username, so the
+    // first count of several indexes merged by username are the first count of all accounts.
+    QStringList findPrefix(const QString &text, Field field, qint32 count) const;
+    QStringList findSubstring(const QString &text, Field field, qint32 count) const;
+
+    // Minimum length of the text of a substring search.
+    static const qint32 trigramLength = 3;
+
+private:
+    // Names of an indexed account, as given and lower-cased.
+    struct Entry
+    {
+        QString userName;
+        QString fullName;
+        QString userNameKey;
+        QString fullNameKey;
+    };
+
+    // Methods to add or remove the names of an entry in the sorted lists and the trigram lists.
+    void addTerms(const QString &accountNumber, const Entry &entry);
+    void removeTerms(const QString &accountNumber, const Entry &entry);
+
+    // Method to get the distinct trigrams of the names of an entry.
+    static QSet<QString> trigramsOf(const Entry &entry);
+
+    // Method to get the distinct trigrams of a lower-cased text.
+    static QSet<QString> trigramsOf(const QString &text);
+
+    QHash<QString, Entry> entries; // Indexed names, by account number.
+    std::set<std::pair<QString, QString>> userNames; // Sorted (username, account number) pairs.
+    std::set<std::pair<QString, QString>> fullNames; // Sorted (full name or word of it, account number) pairs.
+    QHash<QString, QSet<QString>> trigrams; // Accounts whose names contain each trigram.
+};
+
+#endif // SEARCHINDEX_H
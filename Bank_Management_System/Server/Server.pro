@@ -1,18 +1,45 @@
 QT = core
 QT = network
+QT += sql
 
 CONFIG += c++17 cmdline
 
+# Shares the TLS session ticket keys between the client connections (see TlsConfig::shareSessionTickets)
+unix:packagesExist(openssl) {
+    CONFIG += link_pkgconfig
+    PKGCONFIG += openssl
+    DEFINES += BANK_SHARED_TICKET_KEYS
+}
+
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+        Acceptor.cpp \
+        AdmissionControl.cpp \
         BankServer.cpp \
+        ChangeLog.cpp \
+        Checkpointer.cpp \
         ClientHandler.cpp \
         DataBaseHandler.cpp \
+        DataBaseShard.cpp \
+        IdempotencyCache.cpp \
+        JsonFileEngine.cpp \
         Logger.cpp \
+        MemoryEngine.cpp \
+        PasswordHasher.cpp \
+        ReplicationFollower.cpp \
+        ReplicationLeader.cpp \
         RequestHandler.cpp \
+        SearchIndex.cpp \
+        ServerConfig.cpp \
+        SessionManager.cpp \
+        SqliteEngine.cpp \
+        SubscriptionManager.cpp \
+        TimerWheel.cpp \
+        TlsConfig.cpp \
+        TokenBucket.cpp \
         main.cpp
 
 # Default rules for deployment.
@@ -21,8 +48,28 @@ else: unix:!android: target.path = /opt/$${TARGET}/bin
 !isEmpty(target.path): INSTALLS += target
 
 HEADERS += \
+    Acceptor.h \
+    AdmissionControl.h \
     BankServer.h \
+    ChangeLog.h \
+    Checkpointer.h \
     ClientHandler.h \
     DataBaseHandler.h \
+    DataBaseShard.h \
+    IdempotencyCache.h \
+    JsonFileEngine.h \
     Logger.h \
-    RequestHandler.h
+    MemoryEngine.h \
+    PasswordHasher.h \
+    ReplicationFollower.h \
+    ReplicationLeader.h \
+    RequestHandler.h \
+    SearchIndex.h \
+    ServerConfig.h \
+    SessionManager.h \
+    SqliteEngine.h \
+    StorageEngine.h \
+    SubscriptionManager.h \
+    TimerWheel.h \
+    TlsConfig.h \
+    TokenBucket.h
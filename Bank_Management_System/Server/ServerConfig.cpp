@@ -0,0 +1,168 @@
+#include "ServerConfig.h"
+#include <QFileInfo> // Includes the QFileInfo class for checking the configuration file
+#include <QDebug>
+#include <cstdlib> // Includes std::exit for stopping on configuration errors
+
+// Settings with their description and value name; the key is also the option name and the file key
+struct SettingInfo
+{
+    const char *key;
+    const char *description;
+    const char *valueName;
+};
+
+static const SettingInfo settingInfos[] = {
+    {"config", "Read settings from the INI file <file>.", "file"},
+    {"port", "Listen for clients on <port>; without it the port is asked on the terminal.", "port"},
+    {"bind-address", "Listen for clients on <address> only (default: all addresses).", "address"},
+    {"acceptors", "Accept connections on <count> threads sharing the port with SO_REUSEPORT (default: 1).", "count"},
+    {"tls-cert", "Serve clients over TLS with the PEM certificate (chain) in <file>.", "file"},
+    {"tls-key", "PEM private key of the TLS certificate.", "file"},
+    {"data-dir", "Keep the database files in <dir> (default: the working directory).", "dir"},
+    {"log-dir", "Write the log files to <dir> (default: Logs in the data directory).", "dir"},
+    {"log-level", "Write log messages of <level> and above: debug, info, warning or error (default: info).", "level"},
+    {"storage", "Persist the in-memory shards as <engine>: json, memory or sqlite (default: json).", "engine"},
+    {"shards", "Split the accounts over <count> shards, each served by its own thread (default: 4).", "count"},
+    {"checkpoint-interval", "Write pending changes to disk every <ms> milliseconds (default: 5000).", "ms"},
+    {"checkpoint-changes", "Write to disk early once <count> changes of a shard are pending (default: 100).", "count"},
+    {"password-iterations", "PBKDF2 iterations of newly hashed passwords (default: 10000).", "count"},
+    {"session-timeout", "Expire session tokens after <seconds> (default: 28800).", "seconds"},
+    {"idempotency-entries", "Remember the responses of at most <count> idempotent requests (default: 100000).", "count"},
+    {"idempotency-ttl", "Remember the responses of idempotent requests for <seconds> (default: 600).", "seconds"},
+    {"change-log-entries", "Remember the last <count> account changes for clients syncing the database (default: 10000).", "count"},
+    {"replication-port", "Stream database changes to followers connecting on <port>.", "port"},
+    {"replication-address", "Accept followers on <address> only (default: 127.0.0.1).", "address"},
+    {"replication-secret", "Shared secret the leader and its followers prove to know; required for replication.", "secret"},
+    {"follow", "Run as a read-only follower of the leader at <host:port>.", "host:port"},
+    {"max-connections", "Refuse connections beyond <count> open ones.", "count"},
+    {"connection-rate", "Requests per second allowed on one connection (default: 0, unlimited).", "rate"},
+    {"account-rate", "Requests per second allowed for one account (default: 0, unlimited).", "rate"},
+    {"max-active-requests", "Requests running at once.", "count"},
+    {"max-queued-requests", "Requests waiting to run before new ones are refused as busy.", "count"},
+    {"idle-timeout", "Close client connections idle for <seconds> (default: 300, 0: never).", "seconds"},
+    {"drain-timeout", "On SIGTERM or Ctrl+C, wait at most <seconds> for running requests (default: 10).", "seconds"},
+};
+
+// Constructor: Defines one command-line option per setting
+ServerConfig::ServerConfig()
+{
+    parser.setApplicationDescription("Bank management server\n\n"
+                                     "Every option can also be set with the environment variable BANK_<OPTION>\n"
+                                     "(e.g. BANK_DATA_DIR) or as <option>=<value> in the --config file.\n"
+                                     "The command line wins over the environment, which wins over the file.");
+    parser.addHelpOption();
+
+    for (const SettingInfo &info : settingInfos)
+    {
+        keys.append(info.key);
+        parser.addOption(QCommandLineOption(info.key, info.description, info.valueName));
+    }
+}
+
+// Parses the command line and opens the configuration file
+void ServerConfig::load(const QCoreApplication &app)
+{
+    parser.process(app); // Prints the help or the error and exits when needed
+
+    QString configFile = parser.isSet("config") ? parser.value("config")
+                                                : qEnvironmentVariable("BANK_CONFIG");
+    if (configFile.isEmpty())
+    {
+        return;
+    }
+
+    // A missing file is an error, the server should not silently start with the defaults
+    if (!QFileInfo::exists(configFile))
+    {
+        qCritical() << "Configuration file" << configFile << "does not exist";
+        std::exit(1);
+    }
+
+    file = std::make_unique<QSettings>(configFile, QSettings::IniFormat);
+    if (file->status() != QSettings::NoError)
+    {
+        qCritical() << "Cannot read the configuration file" << configFile;
+        std::exit(1);
+    }
+
+    // Catch typing errors in the file instead of ignoring them
+    for (const QString &key : file->allKeys())
+    {
+        if (!keys.contains(key))
+        {
+            qWarning() << "Ignoring unknown setting" << key << "in" << configFile;
+        }
+    }
+}
+
+// Checks if a setting was given on the command line, in the environment or in the file
+bool ServerConfig::isSet(const QString &key) const
+{
+    return parser.isSet(key)
+           || qEnvironmentVariableIsSet(environmentName(key).toUtf8().constData())
+           || (file && file->contains(key));
+}
+
+// Returns a setting from the first source that has it
+QString ServerConfig::value(const QString &key, const QString &defaultValue) const
+{
+    if (parser.isSet(key))
+    {
+        return parser.value(key);
+    }
+
+    QByteArray environmentKey = environmentName(key).toUtf8();
+    if (qEnvironmentVariableIsSet(environmentKey.constData()))
+    {
+        return qEnvironmentVariable(environmentKey.constData());
+    }
+
+    if (file && file->contains(key))
+    {
+        return file->value(key).toString();
+    }
+
+    return defaultValue;
+}
+
+// Returns a whole-number setting
+qint32 ServerConfig::intValue(const QString &key, qint32 defaultValue) const
+{
+    if (!isSet(key))
+    {
+        return defaultValue;
+    }
+
+    bool ok;
+    qint32 number = value(key).trimmed().toInt(&ok);
+    if (!ok)
+    {
+        qWarning() << "Invalid value" << value(key) << "for" << key << "- using" << defaultValue;
+        return defaultValue;
+    }
+    return number;
+}
+
+// Returns a decimal-number setting
+double ServerConfig::doubleValue(const QString &key, double defaultValue) const
+{
+    if (!isSet(key))
+    {
+        return defaultValue;
+    }
+
+    bool ok;
+    double number = value(key).trimmed().toDouble(&ok);
+    if (!ok)
+    {
+        qWarning() << "Invalid value" << value(key) << "for" << key << "- using" << defaultValue;
+        return defaultValue;
+    }
+    return number;
+}
+
+// Returns the environment variable of a setting
+QString ServerConfig::environmentName(const QString &key)
+{
+    return "BANK_" + key.toUpper().replace('-', '_');
+}
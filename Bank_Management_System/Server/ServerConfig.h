@@ -0,0 +1,42 @@
+#ifndef SERVERCONFIG_H
+#define SERVERCONFIG_H
+
+#include <QCoreApplication>   // Includes the QCoreApplication class for the command-line arguments
+#include <QCommandLineParser> // Includes the parser for the command-line options
+#include <QSettings>          // Includes the QSettings class for reading the configuration file
+#include <QStringList>        // Includes the QStringList class for the list of setting names
+#include <memory>             // Includes smart pointers such as std::unique_ptr
+
+// The ServerConfig class collects the server settings so the server can start without anyone at
+// the terminal, e.g. under a service manager or in a container.
+// Every setting can be given as a command-line option (--data-dir), as an environment variable
+// (BANK_DATA_DIR) or as a key of an INI configuration file (data-dir=...) passed with --config or
+// BANK_CONFIG. The command line wins over the environment, which wins over the file.
+class ServerConfig
+{
+public:
+    // Constructor to define the command-line options of every setting.
+    ServerConfig();
+
+    // Method to parse the command line and open the configuration file; exits on invalid options.
+    void load(const QCoreApplication &app);
+
+    // Method to check if a setting was given anywhere.
+    bool isSet(const QString &key) const;
+
+    // Methods to get a setting, or the default value when it was not given.
+    // Numbers that cannot be parsed are reported and replaced by the default value.
+    QString value(const QString &key, const QString &defaultValue = QString()) const;
+    qint32 intValue(const QString &key, qint32 defaultValue) const;
+    double doubleValue(const QString &key, double defaultValue) const;
+
+    // Method to get the environment variable of a setting, e.g. BANK_DATA_DIR for data-dir.
+    static QString environmentName(const QString &key);
+
+private:
+    QCommandLineParser parser; // Parser of the command-line options
+    QStringList keys; // Names of the settings
+    std::unique_ptr<QSettings> file; // Configuration file, if one was given
+};
+
+#endif // SERVERCONFIG_H
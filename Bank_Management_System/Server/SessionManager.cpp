@@ -0,0 +1,223 @@
+#include "SessionManager.h"
+
+// Constructor: Sessions last 8 hours unless setTimeout() is called
+SessionManager::SessionManager()
+    : timeout{8 * 60 * 60}, creations{0}
+{
+    // A random key serves a server without followers
+    quint32 words[8];
+    QRandomGenerator::system()->fillRange(words);
+    digestKey = QByteArray(reinterpret_cast<const char*>(words), sizeof(words));
+}
+
+// Static method to get the singleton instance of SessionManager
+std::shared_ptr<SessionManager> SessionManager::getInstance()
+{
+    static std::shared_ptr<SessionManager> instance(new SessionManager());
+    return instance;
+}
+
+// Returns the HMAC-SHA256 of a token keyed by the digest key
+QByteArray SessionManager::digestOf(const QString &token) const
+{
+    return QMessageAuthenticationCode::hash(token.toLatin1(), digestKey, QCryptographicHash::Sha256);
+}
+
+// Returns the stripe holding a token digest
+SessionManager::Stripe &SessionManager::stripeFor(const QByteArray &digest)
+{
+    return stripes[qHash(digest) % StripeCount];
+}
+
+// Opens a session with a random 256-bit token
+QString SessionManager::createSession(const QString &userName, const QString &accountNumber, bool isAdmin)
+{
+    quint32 words[8];
+    QRandomGenerator::system()->fillRange(words);
+    QString token = QString::fromLatin1(QByteArray(reinterpret_cast<const char*>(words), sizeof(words)).toHex());
+
+    Session session{userName, accountNumber, isAdmin, QDateTime::currentMSecsSinceEpoch() + qint64(timeout) * 1000};
+    storeSession(digestOf(token), session);
+
+    // Sessions are never logged out, so expired ones are swept from time to time
+    if ((++creations % 1024) == 0)
+    {
+        purgeExpired();
+    }
+
+    return token;
+}
+
+// Finds an unexpired session with a single hash lookup
+bool SessionManager::findSession(const QString &token, Session &session)
+{
+    if (token.isEmpty())
+    {
+        return false;
+    }
+
+    QByteArray digest = digestOf(token);
+    Stripe &stripe = stripeFor(digest);
+    QReadLocker locker(&stripe.lock);
+
+    auto it = stripe.sessions.constFind(digest);
+    if ((it == stripe.sessions.constEnd()) || (it->expiry < QDateTime::currentMSecsSinceEpoch()))
+    {
+        return false;
+    }
+
+    session = *it;
+    return true;
+}
+
+// Closes all sessions of an account
+void SessionManager::endSessionsOf(const QString &accountNumber)
+{
+    for (Stripe &stripe : stripes)
+    {
+        QWriteLocker locker(&stripe.lock);
+        for (auto it = stripe.sessions.begin(); it != stripe.sessions.end();)
+        {
+            if (it->accountNumber == accountNumber)
+            {
+                it = stripe.sessions.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    QJsonObject record;
+    record["Op"] = "EndSessions";
+    record["AccountNumber"] = accountNumber;
+    notify(record);
+}
+
+// Sets the lifetime of new sessions
+void SessionManager::setTimeout(qint32 seconds)
+{
+    timeout = qMax(seconds, 1);
+}
+
+// Sets the key of the token digests
+void SessionManager::setDigestKey(const QByteArray &key)
+{
+    digestKey = key;
+}
+
+// Registers the callback receiving the session records
+void SessionManager::setListener(std::function<void(const QJsonObject &)> callback)
+{
+    QMutexLocker locker(&listenerMutex);
+    listener = callback;
+}
+
+// Returns all unexpired sessions as a replication snapshot record
+QJsonObject SessionManager::snapshot()
+{
+    QJsonArray sessions;
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    for (Stripe &stripe : stripes)
+    {
+        QReadLocker locker(&stripe.lock);
+        for (auto it = stripe.sessions.constBegin(); it != stripe.sessions.constEnd(); ++it)
+        {
+            if (it->expiry >= now)
+            {
+                QJsonObject session;
+                session["TokenDigest"] = QString::fromLatin1(it.key().toHex());
+                session["UserName"] = it->userName;
+                session["AccountNumber"] = it->accountNumber;
+                session["IsAdmin"] = it->isAdmin;
+                session["Expiry"] = QString::number(it->expiry);
+                sessions.append(session);
+            }
+        }
+    }
+
+    QJsonObject record;
+    record["Op"] = "Sessions";
+    record["Sessions"] = sessions;
+    return record;
+}
+
+// Applies a session record or snapshot streamed by the replication leader
+void SessionManager::applyReplication(const QJsonObject &record)
+{
+    QString op = record.value("Op").toString();
+
+    // Records of a leader still sending raw tokens carry no digest and are ignored
+    if ((op == "Session") && record.contains("TokenDigest"))
+    {
+        Session session{record.value("UserName").toString(), record.value("AccountNumber").toString(),
+                        record.value("IsAdmin").toBool(), record.value("Expiry").toString().toLongLong()};
+        storeSession(QByteArray::fromHex(record.value("TokenDigest").toString().toLatin1()), session);
+    }
+    else if (op == "EndSessions")
+    {
+        endSessionsOf(record.value("AccountNumber").toString());
+    }
+    else if (op == "Sessions")
+    {
+        for (const QJsonValue &value : record.value("Sessions").toArray())
+        {
+            QJsonObject session = value.toObject();
+            session["Op"] = "Session";
+            applyReplication(session);
+        }
+    }
+}
+
+// Stores a session in its stripe and reports it
+void SessionManager::storeSession(const QByteArray &digest, const Session &session)
+{
+    {
+        Stripe &stripe = stripeFor(digest);
+        QWriteLocker locker(&stripe.lock);
+        stripe.sessions.insert(digest, session);
+    }
+
+    QJsonObject record;
+    record["Op"] = "Session";
+    record["TokenDigest"] = QString::fromLatin1(digest.toHex());
+    record["UserName"] = session.userName;
+    record["AccountNumber"] = session.accountNumber;
+    record["IsAdmin"] = session.isAdmin;
+    record["Expiry"] = QString::number(session.expiry);
+    notify(record);
+}
+
+// Removes the expired sessions of all stripes
+void SessionManager::purgeExpired()
+{
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    for (Stripe &stripe : stripes)
+    {
+        QWriteLocker locker(&stripe.lock);
+        for (auto it = stripe.sessions.begin(); it != stripe.sessions.end();)
+        {
+            if (it->expiry < now)
+            {
+                it = stripe.sessions.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+}
+
+// Reports a record to the listener
+void SessionManager::notify(const QJsonObject &record)
+{
+    QMutexLocker locker(&listenerMutex);
+    if (listener)
+    {
+        listener(record);
+    }
+}
@@ -0,0 +1,104 @@
+#ifndef SESSIONMANAGER_H
+#define SESSIONMANAGER_H
+
+#include <QString>          // Includes the QString class for the session tokens
+#include <QHash>            // Includes the QHash class for the session table
+#include <QReadWriteLock>   // Includes the QReadWriteLock class for protecting the session table
+#include <QMutex>           // Includes the QMutex class for protecting the listener
+#include <QJsonObject>      // Includes the QJsonObject class for the replication records
+#include <QJsonArray>       // Includes the QJsonArray class for the session snapshot
+#include <QDateTime>        // Includes the QDateTime class for the session expiry
+#include <QRandomGenerator> // Includes the QRandomGenerator class for generating tokens
+#include <QMessageAuthenticationCode> // Includes the HMAC of the token digests
+#include <memory>           // Includes smart pointers such as std::shared_ptr
+#include <functional>       // Includes std::function for the replication listener
+#include <atomic>           // Includes std::atomic for the timeout and the creation counter
+
+// The SessionManager class keeps the sessions opened by LogIn in memory.
+// A session token identifies the user of every later request with one hash lookup,
+// without checking the credentials again or reading the database.
+// The table is split into stripes, each with its own lock, so lookups from
+// different client threads rarely contend.
+// Sessions are kept under a keyed digest of their token, never the token itself, so neither the
+// table nor the replication records sent to the followers reveal a usable token. Followers sharing
+// the digest key find a session from the token of a request the same way.
+class SessionManager
+{
+public:
+    // Data known about the user of a session.
+    struct Session
+    {
+        QString userName;
+        QString accountNumber;
+        bool isAdmin;
+        qint64 expiry; // Expiry time in milliseconds since the epoch.
+    };
+
+    // Method to get the singleton instance of SessionManager.
+    static std::shared_ptr<SessionManager> getInstance();
+
+    // Delete the copy constructor and the assignment operator to prevent copying.
+    SessionManager(const SessionManager&) = delete;
+    SessionManager& operator=(const SessionManager&) = delete;
+
+    // Method to open a session and return its token.
+    QString createSession(const QString &userName, const QString &accountNumber, bool isAdmin);
+
+    // Method to find an unexpired session. Returns false if the token is unknown or expired.
+    bool findSession(const QString &token, Session &session);
+
+    // Method to close all sessions of an account, e.g. after it was updated or deleted.
+    void endSessionsOf(const QString &accountNumber);
+
+    // Method to set the lifetime of new sessions in seconds.
+    void setTimeout(qint32 seconds);
+
+    // Method to set the key of the token digests; leader and followers must use the same one.
+    // Must be called before any session is opened; without it a random key is used.
+    void setDigestKey(const QByteArray &key);
+
+    // Method to register a callback receiving a record for every session change (used by replication).
+    void setListener(std::function<void(const QJsonObject &)> callback);
+
+    // Method to get all unexpired sessions as a replication snapshot record.
+    QJsonObject snapshot();
+
+    // Method to apply a session record or snapshot streamed by the replication leader.
+    void applyReplication(const QJsonObject &record);
+
+private:
+    // Constructor to initialize the SessionManager object.
+    SessionManager();
+
+    // One part of the session table with its own lock.
+    struct Stripe
+    {
+        QReadWriteLock lock;
+        QHash<QByteArray, Session> sessions; // Sessions by token digest.
+    };
+
+    // Method to get the keyed digest of a token.
+    QByteArray digestOf(const QString &token) const;
+
+    // Method to get the stripe holding a token digest.
+    Stripe &stripeFor(const QByteArray &digest);
+
+    // Method to store a session under its token digest and report it to the listener.
+    void storeSession(const QByteArray &digest, const Session &session);
+
+    // Method to remove the expired sessions of all stripes.
+    void purgeExpired();
+
+    // Method to report a record to the listener, if any.
+    void notify(const QJsonObject &record);
+
+    static constexpr qint32 StripeCount = 16; // Number of stripes of the session table.
+    Stripe stripes[StripeCount]; // The session table.
+    std::atomic<qint32> timeout; // Lifetime of new sessions in seconds.
+    std::atomic<quint32> creations; // Number of sessions created, used to purge periodically.
+    QByteArray digestKey; // Key of the token digests.
+    std::function<void(const QJsonObject &)> listener; // Callback receiving the session records.
+    QMutex listenerMutex; // Mutex protecting the listener.
+};
+
+#endif // SESSIONMANAGER_H
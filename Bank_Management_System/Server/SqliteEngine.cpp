@@ -0,0 +1,165 @@
+#include "SqliteEngine.h"
+
+// Constructor for SqliteEngine
+SqliteEngine::SqliteEngine(const QString &fileName, qint32 shardID, Logger *logs)
+    : fileName{fileName}, id{shardID}, existed{QFile::exists(fileName)}, DBLogs{logs}
+{
+}
+
+// Opens a connection to the shard's database for the calling thread
+QString SqliteEngine::openConnection()
+{
+    QString name = QString("BankShard_%1_%2").arg(id).arg(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", name);
+    db.setDatabaseName(fileName);
+
+    if (!db.open())
+    {
+        DBLogs->log("Cannot open " + fileName + ": " + db.lastError().text(), Logger::Error);
+        return QString();
+    }
+
+    // Each commit is durable once it reaches the write-ahead log; the log is synced at its own checkpoints
+    QSqlQuery pragma(db);
+    pragma.exec("PRAGMA synchronous = NORMAL");
+    pragma.exec("PRAGMA busy_timeout = 5000");
+    return name;
+}
+
+// Closes a connection; its QSqlDatabase and QSqlQuery objects must be gone already
+void SqliteEngine::closeConnection(const QString &name)
+{
+    {
+        QSqlDatabase db = QSqlDatabase::database(name, false);
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(name);
+}
+
+// Switches the database to WAL mode and creates the accounts table and its indexes
+bool SqliteEngine::createSchema(QSqlDatabase &db)
+{
+    QSqlQuery query(db);
+
+    // The journal mode is stored in the database file, so it only needs to be set once
+    if (!query.exec("PRAGMA journal_mode = WAL"))
+    {
+        return false;
+    }
+
+    // The primary key indexes the usernames; the unique index serves lookups by account number
+    return query.exec("CREATE TABLE IF NOT EXISTS accounts ("
+                      "user_name TEXT PRIMARY KEY NOT NULL, "
+                      "account_number TEXT NOT NULL, "
+                      "data TEXT NOT NULL)")
+           && query.exec("CREATE UNIQUE INDEX IF NOT EXISTS accounts_account_number ON accounts (account_number)");
+}
+
+// Reads every account row into the account table
+qint32 SqliteEngine::load(QJsonObject &accounts)
+{
+    QString name = openConnection();
+    if (name.isEmpty())
+    {
+        return -4; // Failed to open the database
+    }
+
+    qint32 reason = 0;
+    {
+        QSqlDatabase db = QSqlDatabase::database(name, false);
+        QSqlQuery query(db);
+        query.setForwardOnly(true); // Rows are read once, so they need not be cached
+
+        if (!createSchema(db) || !query.exec("SELECT user_name, data FROM accounts"))
+        {
+            DBLogs->log("Shard " + QString::number(id) + " cannot read " + fileName + ": " + query.lastError().text(), Logger::Error);
+            reason = -4;
+        }
+
+        while ((reason == 0) && query.next())
+        {
+            QJsonParseError jError;
+            QJsonDocument account = QJsonDocument::fromJson(query.value(1).toByteArray(), &jError);
+            if (jError.error != QJsonParseError::NoError)
+            {
+                DBLogs->log("Shard " + QString::number(id) + " account " + query.value(0).toString() + " is corrupted.", Logger::Error);
+                reason = -3; // Corrupted database
+                break;
+            }
+            accounts.insert(query.value(0).toString(), account.object());
+        }
+    }
+
+    closeConnection(name);
+    return reason;
+}
+
+// Checks if the database file existed when the shard was created
+bool SqliteEngine::exists() const
+{
+    return existed;
+}
+
+// Writes the changed accounts in one transaction; accounts no longer in the table are deleted
+bool SqliteEngine::save(const QJsonObject &accounts, const QSet<QString> &changed)
+{
+    if (changed.isEmpty())
+    {
+        return true;
+    }
+
+    QString name = openConnection();
+    if (name.isEmpty())
+    {
+        return false;
+    }
+
+    bool ok;
+    {
+        QSqlDatabase db = QSqlDatabase::database(name, false);
+        ok = db.transaction();
+
+        // Prepared once, executed for every changed account
+        QSqlQuery upsert(db);
+        QSqlQuery remove(db);
+        ok = ok && upsert.prepare("INSERT OR REPLACE INTO accounts (user_name, account_number, data) VALUES (?, ?, ?)");
+        ok = ok && remove.prepare("DELETE FROM accounts WHERE user_name = ?");
+
+        // Deletions go first, so a renamed user never collides with its old row on the account number
+        for (auto it = changed.constBegin(); ok && (it != changed.constEnd()); ++it)
+        {
+            if (!accounts.contains(*it))
+            {
+                remove.addBindValue(*it);
+                ok = remove.exec();
+            }
+        }
+
+        for (auto it = changed.constBegin(); ok && (it != changed.constEnd()); ++it)
+        {
+            if (accounts.contains(*it))
+            {
+                QJsonObject account = accounts.value(*it).toObject();
+                upsert.addBindValue(*it);
+                upsert.addBindValue(account.value("AccountNumber").toString());
+                upsert.addBindValue(QString::fromUtf8(QJsonDocument(account).toJson(QJsonDocument::Compact)));
+                ok = upsert.exec();
+            }
+        }
+
+        if (ok)
+        {
+            ok = db.commit();
+        }
+        if (!ok)
+        {
+            QSqlError error = upsert.lastError().isValid() ? upsert.lastError()
+                              : remove.lastError().isValid() ? remove.lastError() : db.lastError();
+            DBLogs->log("Shard " + QString::number(id) + " cannot write " + fileName + ": " + error.text(), Logger::Error);
+            db.rollback();
+        }
+    }
+
+    closeConnection(name);
+    return ok;
+}
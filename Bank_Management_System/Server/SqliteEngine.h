@@ -0,0 +1,51 @@
+#ifndef SQLITEENGINE_H
+#define SQLITEENGINE_H
+
+#include <QSqlDatabase>  // Includes the QSqlDatabase class for the SQLite connections
+#include <QSqlQuery>     // Includes the QSqlQuery class for the prepared statements
+#include <QSqlError>     // Includes the QSqlError class for reporting database errors
+#include <QJsonDocument> // Includes the QJsonDocument class for serializing single accounts
+#include <QFile>         // Includes the QFile class for checking if the database exists
+#include <QThread>       // Includes the QThread class for naming the connection of each thread
+#include "StorageEngine.h"
+#include "Logger.h"
+
+// The SqliteEngine class is a persistence format for a shard: an embedded SQLite database
+// written through Qt SQL. It is not a query engine. The shard still loads every account into
+// its in-memory table at start-up and serves all reads from that table, so memory use and
+// start-up time grow with the shard as they do with the JSON files; the database is only
+// written, at each checkpoint, and read back on the next start.
+// Every account is one row (username, account number, account as compact JSON), indexed by
+// username (the primary key) and by account number. A checkpoint only writes the accounts
+// changed since the previous one, in a single transaction with prepared statements, so its
+// cost follows the number of changes instead of the size of the shard. The database runs in
+// WAL mode, so a checkpoint never blocks readers of the file such as backup tools.
+class SqliteEngine : public StorageEngine
+{
+public:
+    // Constructor to keep the accounts of a shard in the given database file.
+    SqliteEngine(const QString &fileName, qint32 shardID, Logger *logs);
+
+    qint32 load(QJsonObject &accounts) override;
+    bool exists() const override;
+    bool save(const QJsonObject &accounts, const QSet<QString> &changed) override;
+
+private:
+    // Method to open a connection for the calling thread under a new name.
+    // Qt SQL connections may only be used on the thread that opened them, and a shard is
+    // loaded, checkpointed and closed from different threads, so each use opens its own.
+    QString openConnection();
+
+    // Method to close and remove a connection opened by openConnection().
+    void closeConnection(const QString &name);
+
+    // Method to create the table and the index if the database is new.
+    bool createSchema(QSqlDatabase &db);
+
+    QString fileName; // The shard's database file.
+    qint32 id; // Index of the shard, used in the log messages and connection names.
+    bool existed; // Set if the database file existed when the shard was created.
+    Logger *DBLogs; // Database logger shared with the DataBaseHandler.
+};
+
+#endif // SQLITEENGINE_H
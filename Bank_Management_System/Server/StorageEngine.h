@@ -0,0 +1,37 @@
+#ifndef STORAGEENGINE_H
+#define STORAGEENGINE_H
+
+#include <QString>     // Includes the QString class for the usernames
+#include <QJsonObject> // Includes the QJsonObject class for the account table
+#include <QSet>        // Includes the QSet class for the usernames changed since the last checkpoint
+
+// The StorageEngine class is the interface between a shard and the medium its accounts are kept on.
+// A shard serves its requests from its in-memory account table; the engine loads that table at
+// start-up and persists it at every checkpoint. Engines only run on one thread at a time: load()
+// runs while the shard is created, save() under the shard's checkpoint lock.
+class StorageEngine
+{
+public:
+    virtual ~StorageEngine() = default;
+
+    // Method to load the stored accounts, keyed by username.
+    // Returns 0 on success or the negative reason code of the failure.
+    virtual qint32 load(QJsonObject &accounts) = 0;
+
+    // Method to check if the engine found stored data when the shard was created.
+    virtual bool exists() const = 0;
+
+    // Method to persist the account table. changed holds the usernames stored or erased since the
+    // last successful save, so engines able to update single accounts write only those.
+    virtual bool save(const QJsonObject &accounts, const QSet<QString> &changed) = 0;
+
+    // Method to leave a copy of the account table that loads faster on the next start.
+    // Engines without such a copy return false.
+    virtual bool writeRestartSnapshot(const QJsonObject &accounts)
+    {
+        Q_UNUSED(accounts);
+        return false;
+    }
+};
+
+#endif // STORAGEENGINE_H
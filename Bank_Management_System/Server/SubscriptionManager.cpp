@@ -0,0 +1,113 @@
+#include "SubscriptionManager.h"
+
+// Constructor: No connection subscribed yet
+SubscriptionManager::SubscriptionManager()
+    : subscriptionCount{0}
+{
+}
+
+// Static method to get the singleton instance of SubscriptionManager
+std::shared_ptr<SubscriptionManager> SubscriptionManager::getInstance()
+{
+    static std::shared_ptr<SubscriptionManager> instance(new SubscriptionManager());
+    return instance;
+}
+
+// Adds a connection without subscriptions
+void SubscriptionManager::addConnection(quint64 connectionID, QObject *context, std::function<void(const QJsonObject &)> send)
+{
+    QMutexLocker locker(&mutex);
+    connections.insert(connectionID, Connection{context, send, QSet<QString>()});
+}
+
+// Removes a connection and all of its subscriptions
+void SubscriptionManager::removeConnection(quint64 connectionID)
+{
+    unsubscribe(connectionID, QStringList());
+
+    QMutexLocker locker(&mutex);
+    connections.remove(connectionID);
+}
+
+// Subscribes a connection to accounts
+bool SubscriptionManager::subscribe(quint64 connectionID, const QStringList &accountNumbers)
+{
+    QMutexLocker locker(&mutex);
+    auto connection = connections.find(connectionID);
+    if (connection == connections.end())
+    {
+        return false;
+    }
+
+    for (const QString &accountNumber : accountNumbers)
+    {
+        if (!connection->accounts.contains(accountNumber))
+        {
+            connection->accounts.insert(accountNumber);
+            subscribers[accountNumber].insert(connectionID);
+            subscriptionCount++;
+        }
+    }
+    return true;
+}
+
+// Unsubscribes a connection from accounts, or from all of them
+bool SubscriptionManager::unsubscribe(quint64 connectionID, const QStringList &accountNumbers)
+{
+    QMutexLocker locker(&mutex);
+    auto connection = connections.find(connectionID);
+    if (connection == connections.end())
+    {
+        return false;
+    }
+
+    const QStringList accounts = accountNumbers.isEmpty() ? connection->accounts.values() : accountNumbers;
+    for (const QString &accountNumber : accounts)
+    {
+        if (connection->accounts.remove(accountNumber))
+        {
+            auto it = subscribers.find(accountNumber);
+            it->remove(connectionID);
+            if (it->isEmpty())
+            {
+                subscribers.erase(it);
+            }
+            subscriptionCount--;
+        }
+    }
+    return true;
+}
+
+// Queues an event to every connection subscribed to the account
+void SubscriptionManager::publish(const QString &accountNumber, const QString &balance, const QJsonArray &transactions)
+{
+    // Most changes happen without anybody watching
+    if (subscriptionCount == 0)
+    {
+        return;
+    }
+
+    QMutexLocker locker(&mutex);
+    auto it = subscribers.constFind(accountNumber);
+    if (it == subscribers.constEnd())
+    {
+        return;
+    }
+
+    // The event only carries what changed, not the whole account
+    QJsonObject event;
+    event["Event"] = "AccountChanged";
+    event["AccountNumber"] = accountNumber;
+    event["AccountBalance"] = balance;
+    event["Transactions"] = transactions;
+
+    for (quint64 connectionID : *it)
+    {
+        auto connection = connections.constFind(connectionID);
+        if ((connection != connections.constEnd()) && connection->context)
+        {
+            std::function<void(const QJsonObject &)> send = connection->send;
+            QMetaObject::invokeMethod(connection->context.data(), [send, event]() { send(event); }, Qt::QueuedConnection);
+        }
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef SUBSCRIPTIONMANAGER_H
+#define SUBSCRIPTIONMANAGER_H
+
+#include <QObject>      // Includes the QObject class for the thread of a connection
+#include <QPointer>     // Includes the QPointer class for guarding the connection objects
+#include <QString>      // Includes the QString class for the account numbers
+#include <QStringList>  // Includes the QStringList class for the subscribed accounts
+#include <QHash>        // Includes the QHash class for the subscription tables
+#include <QSet>         // Includes the QSet class for the subscribers of an account
+#include <QMutex>       // Includes the QMutex class for protecting the subscription tables
+#include <QJsonObject>  // Includes the QJsonObject class for the change events
+#include <QJsonArray>   // Includes the QJsonArray class for the new transactions of an event
+#include <memory>       // Includes smart pointers such as std::shared_ptr
+#include <functional>   // Includes std::function for sending the events
+#include <atomic>       // Includes std::atomic for the number of subscriptions
+
+// The SubscriptionManager class pushes account changes to the connections that subscribed to them.
+// A connection registers a function sending an event on its socket, together with an object living
+// on its thread; events are queued to that object, so they are written by the connection's own
+// thread between two responses and never block the shard that committed the change.
+class SubscriptionManager
+{
+public:
+    // Method to get the singleton instance of SubscriptionManager.
+    static std::shared_ptr<SubscriptionManager> getInstance();
+
+    // Delete the copy constructor and the assignment operator to prevent copying.
+    SubscriptionManager(const SubscriptionManager&) = delete;
+    SubscriptionManager& operator=(const SubscriptionManager&) = delete;
+
+    // Methods to add and remove a connection. send runs on the thread of context.
+    // A connection must be removed before context is deleted. The connection ID must be unique for the
+    // lifetime of the server; socket descriptors are not, as the system reuses them once closed.
+    void addConnection(quint64 connectionID, QObject *context, std::function<void(const QJsonObject &)> send);
+    void removeConnection(quint64 connectionID);
+
+    // Methods to start and stop the events of accounts on a connection.
+    // Unsubscribing with an empty list stops the events of all accounts.
+    // Returns false if the connection was not added.
+    bool subscribe(quint64 connectionID, const QStringList &accountNumbers);
+    bool unsubscribe(quint64 connectionID, const QStringList &accountNumbers);
+
+    // Method to push the new balance and transactions of an account to its subscribers.
+    // Called by the shard once the change is committed; costs one atomic load without subscribers.
+    void publish(const QString &accountNumber, const QString &balance, const QJsonArray &transactions);
+
+private:
+    // Constructor to initialize the SubscriptionManager object.
+    SubscriptionManager();
+
+    // A connection able to receive events.
+    struct Connection
+    {
+        QPointer<QObject> context; // Object living on the connection's thread.
+        std::function<void(const QJsonObject &)> send; // Function writing an event to the socket.
+        QSet<QString> accounts; // Accounts subscribed to.
+    };
+
+    QHash<quint64, Connection> connections; // Connections, by connection ID.
+    QHash<QString, QSet<quint64>> subscribers; // Connections subscribed to each account number.
+    std::atomic<qint32> subscriptionCount; // Number of subscriptions, so publish() skips the lock when it is 0.
+    QMutex mutex; // Mutex protecting connections and subscribers.
+};
+
+#endif // SUBSCRIPTIONMANAGER_H
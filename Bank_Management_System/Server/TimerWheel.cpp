@@ -0,0 +1,80 @@
+#include "TimerWheel.h"
+
+// Constructor: Creates the slots and starts ticking
+TimerWheel::TimerWheel(qint32 tickMs, qint32 slotCount, Logger *logs, QObject *parent)
+    : QObject{parent}, wheel(qMax(slotCount, 2)), tick{qMax(tickMs, 1)}, current{0}, idleTimeout{300000}, ServerLogs{logs}
+{
+    connect(&ticker, &QTimer::timeout, this, &TimerWheel::onTick);
+    ticker.start(tick);
+}
+
+TimerWheel::~TimerWheel()
+{
+    ticker.stop();
+}
+
+// Sets the idle time after which a connection is closed
+void TimerWheel::setIdleTimeout(qint32 timeoutMs)
+{
+    idleTimeout = qMax(timeoutMs, 0);
+}
+
+// Starts watching a connection
+void TimerWheel::add(ClientHandler *client)
+{
+    place(client, QDateTime::currentMSecsSinceEpoch());
+}
+
+// Stops watching a connection
+void TimerWheel::remove(ClientHandler *client)
+{
+    auto it = slotOf.find(client);
+    if (it != slotOf.end())
+    {
+        wheel[it.value()].remove(client);
+        slotOf.erase(it);
+    }
+}
+
+// Looks at the connections due in the current slot
+void TimerWheel::onTick()
+{
+    current = (current + 1) % wheel.size();
+    if (idleTimeout == 0)
+    {
+        return; // Reaping disabled
+    }
+
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QSet<ClientHandler*> due;
+    due.swap(wheel[current]);
+
+    for (ClientHandler *client : due)
+    {
+        slotOf.remove(client);
+
+        if (client->lastActivityMs() + idleTimeout <= now)
+        {
+            // Ending the thread closes the socket and frees the connection slot
+            ServerLogs->log("Closing connection " + QString::number(client->clientID()) + " idle for " + QString::number(now - client->lastActivityMs()) + " ms");
+            client->quit();
+        }
+        else
+        {
+            place(client, now); // Active since it was placed; wait for its new deadline
+        }
+    }
+}
+
+// Puts a connection in the slot its deadline falls into
+void TimerWheel::place(ClientHandler *client, qint64 now)
+{
+    qint64 deadline = client->lastActivityMs() + idleTimeout;
+
+    // At least one tick ahead, at most one turn of the wheel ahead
+    qint64 ticks = qBound<qint64>(1, (deadline - now + tick - 1) / tick, wheel.size() - 1);
+    qint32 index = static_cast<qint32>((current + ticks) % wheel.size());
+
+    wheel[index].insert(client);
+    slotOf.insert(client, index);
+}
@@ -0,0 +1,51 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <QObject>   // Includes the base class for all Qt objects
+#include <QTimer>    // Includes the QTimer class driving the wheel
+#include <QVector>   // Includes the QVector class for the slots of the wheel
+#include <QSet>      // Includes the QSet class for the connections of a slot
+#include <QHash>     // Includes the QHash class for finding the slot of a connection
+#include <QDateTime> // Includes the QDateTime class for the current time
+#include "ClientHandler.h"
+#include "Logger.h"
+
+// The TimerWheel class closes client connections that stayed idle for too long.
+// Connections are kept in a ring of slots, one per tick, by the tick of their idle deadline.
+// Every tick only the connections of the current slot are looked at: those idle for the whole
+// timeout are closed, the others are moved to the slot of their new deadline. Client activity
+// only updates a timestamp in the ClientHandler, so busy connections cost nothing between ticks.
+class TimerWheel : public QObject
+{
+    Q_OBJECT // Macro to enable Qt's meta-object system, including signals and slots
+
+public:
+    // Constructor to create a wheel of slotCount slots advancing every tickMs milliseconds.
+    TimerWheel(qint32 tickMs, qint32 slotCount, Logger *logs, QObject *parent = nullptr);
+    ~TimerWheel();
+
+    // Method to set the idle time after which a connection is closed; 0 disables the reaping.
+    void setIdleTimeout(qint32 timeoutMs);
+
+    // Methods to start and stop watching a connection.
+    void add(ClientHandler *client);
+    void remove(ClientHandler *client);
+
+private slots:
+    // Slot advancing the wheel by one tick.
+    void onTick();
+
+private:
+    // Method to put a connection in the slot of its deadline, or the last slot if it lies beyond the wheel.
+    void place(ClientHandler *client, qint64 now);
+
+    QTimer ticker; // Timer advancing the wheel.
+    QVector<QSet<ClientHandler*>> wheel; // Connections by the slot of their deadline.
+    QHash<ClientHandler*, qint32> slotOf; // Slot of every watched connection.
+    qint32 tick; // Length of a tick in milliseconds.
+    qint32 current; // Slot of the current tick.
+    qint32 idleTimeout; // Idle time after which a connection is closed, in milliseconds.
+    Logger *ServerLogs; // Server logger shared with the BankServer.
+};
+
+#endif // TIMERWHEEL_H
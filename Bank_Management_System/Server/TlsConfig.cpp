@@ -0,0 +1,93 @@
+#include "TlsConfig.h"
+#include <QFile>
+
+#ifdef BANK_SHARED_TICKET_KEYS
+#include <openssl/ssl.h> // Includes SSL_CTX_set_tlsext_ticket_keys for sharing the session ticket keys
+#endif
+
+bool TlsConfig::enabled = false;
+QSslConfiguration TlsConfig::sslConfiguration;
+QByteArray TlsConfig::ticketKeys;
+
+// Reads the certificate and key and prepares the settings of the client connections
+bool TlsConfig::load(const QString &certificateFile, const QString &keyFile, QString *error)
+{
+    if (!QSslSocket::supportsSsl())
+    {
+        *error = "No TLS backend is available";
+        return false;
+    }
+
+    // The first certificate is the server's own, the rest complete its chain
+    QList<QSslCertificate> chain = QSslCertificate::fromPath(certificateFile, QSsl::Pem);
+    if (chain.isEmpty())
+    {
+        *error = "Cannot read a certificate from " + certificateFile;
+        return false;
+    }
+
+    QFile file(keyFile);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        *error = "Cannot open the key file " + keyFile;
+        return false;
+    }
+
+    // Both RSA and EC keys are accepted
+    QSslKey key(&file, QSsl::Rsa, QSsl::Pem);
+    if (key.isNull())
+    {
+        file.seek(0);
+        key = QSslKey(&file, QSsl::Ec, QSsl::Pem);
+    }
+    if (key.isNull())
+    {
+        *error = "Cannot read a private key from " + keyFile;
+        return false;
+    }
+
+    QSslConfiguration config = QSslConfiguration::defaultConfiguration();
+    config.setLocalCertificateChain(chain);
+    config.setPrivateKey(key);
+    config.setProtocol(QSsl::TlsV1_2OrLater);
+
+    // Clients are authenticated by their session token, not by a certificate
+    config.setPeerVerifyMode(QSslSocket::VerifyNone);
+
+    // Hand out session tickets so reconnecting clients can resume instead of doing a full handshake.
+    // The tickets are encrypted with keys made once per process, see shareSessionTickets().
+    config.setSslOption(QSsl::SslOptionDisableSessionTickets, false);
+    quint32 words[20];
+    QRandomGenerator::system()->fillRange(words);
+    ticketKeys = QByteArray(reinterpret_cast<const char*>(words), sizeof(words));
+
+    sslConfiguration = config;
+    enabled = true;
+    return true;
+}
+
+// Returns true once load() succeeded
+bool TlsConfig::isEnabled()
+{
+    return enabled;
+}
+
+// Returns the settings shared by every client connection
+QSslConfiguration TlsConfig::configuration()
+{
+    return sslConfiguration;
+}
+
+// Gives the OpenSSL context of a client connection the session ticket keys of all connections
+void TlsConfig::shareSessionTickets(QSslSocket *socket)
+{
+#ifdef BANK_SHARED_TICKET_KEYS
+    if ((QSslSocket::activeBackend() == QLatin1String("openssl")) && socket->nativeHandle())
+    {
+        SSL *ssl = static_cast<SSL*>(socket->nativeHandle());
+        SSL_CTX_set_tlsext_ticket_keys(SSL_get_SSL_CTX(ssl), ticketKeys.data(), ticketKeys.size());
+    }
+#else
+    Q_UNUSED(socket);
+#endif
+}
@@ -0,0 +1,41 @@
+#ifndef TLSCONFIG_H
+#define TLSCONFIG_H
+
+#include <QString>            // Includes the QString class for the file names and errors
+#include <QSslConfiguration>  // Includes the QSslConfiguration class for the server's TLS settings
+#include <QSslCertificate>    // Includes the QSslCertificate class for the server certificate
+#include <QSslKey>            // Includes the QSslKey class for the private key
+#include <QSslSocket>         // Includes the QSslSocket class for checking TLS support
+#include <QByteArray>         // Includes the QByteArray class for the session ticket keys
+#include <QRandomGenerator>   // Includes the QRandomGenerator class for generating the session ticket keys
+
+// The TlsConfig class holds the TLS settings of the client connections.
+// TLS is off until load() succeeds; it is called once at start-up, before any client connects,
+// so the client threads read the settings without locking.
+class TlsConfig
+{
+public:
+    // Method to enable TLS with a PEM certificate (chain) and private key.
+    // Returns false and fills error if TLS is not available or the files cannot be used.
+    static bool load(const QString &certificateFile, const QString &keyFile, QString *error);
+
+    // Method to check if the client connections use TLS.
+    static bool isEnabled();
+
+    // Method to get the TLS settings of a client connection.
+    static QSslConfiguration configuration();
+
+    // Method to let a client connection resume the TLS sessions of the other connections.
+    // Qt gives every server socket its own OpenSSL context with its own random session ticket keys,
+    // so a ticket could only be decrypted by the connection that issued it. This gives the context of
+    // the socket the keys shared by all connections. Must be called right after startServerEncryption(),
+    // before the event loop reads the client's hello; does nothing without the OpenSSL backend.
+    static void shareSessionTickets(QSslSocket *socket);
+
+private:
+    static bool enabled; // Set once load() succeeded.
+    static QSslConfiguration sslConfiguration; // Settings shared by every client connection.
+    static QByteArray ticketKeys; // Session ticket keys of all connections: key name, HMAC key and AES key.
+};
+
+#endif // TLSCONFIG_H
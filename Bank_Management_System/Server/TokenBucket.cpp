@@ -0,0 +1,40 @@
+#include "TokenBucket.h"
+
+// Constructor: Starts with a full bucket
+TokenBucket::TokenBucket(double rate, double burst)
+    : rate{rate}, capacity{qMax(burst, 1.0)}, tokens{qMax(burst, 1.0)}
+{
+    clock.start();
+}
+
+// Takes a token if one is available
+bool TokenBucket::tryTake()
+{
+    if (rate <= 0)
+    {
+        return true; // No limit configured
+    }
+
+    refill();
+    if (tokens < 1)
+    {
+        return false;
+    }
+
+    tokens -= 1;
+    return true;
+}
+
+// Checks if the bucket refilled completely
+bool TokenBucket::isFull()
+{
+    refill();
+    return tokens >= capacity;
+}
+
+// Adds the tokens earned since the last refill, up to the capacity
+void TokenBucket::refill()
+{
+    qint64 elapsed = clock.restart();
+    tokens = qMin(capacity, tokens + elapsed * rate / 1000);
+}
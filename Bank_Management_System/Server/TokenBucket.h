@@ -0,0 +1,33 @@
+#ifndef TOKENBUCKET_H
+#define TOKENBUCKET_H
+
+#include <QElapsedTimer> // Includes the QElapsedTimer class for refilling the bucket over time
+#include <QtGlobal>      // Includes the Qt integer types
+
+// The TokenBucket class limits the rate of requests.
+// The bucket holds up to "burst" tokens and refills at "rate" tokens per second;
+// every request takes one token and is refused if the bucket is empty.
+// A bucket is not thread safe; its owner serializes the calls.
+class TokenBucket
+{
+public:
+    // Constructor to create a full bucket. A rate of 0 or less disables the limit.
+    TokenBucket(double rate = 0, double burst = 1);
+
+    // Method to take a token. Returns false if the bucket is empty.
+    bool tryTake();
+
+    // Method to check if the bucket refilled completely, i.e. it was not used for a while.
+    bool isFull();
+
+private:
+    // Method to add the tokens earned since the last call.
+    void refill();
+
+    double rate; // Tokens added per second.
+    double capacity; // Maximum number of tokens.
+    double tokens; // Tokens currently in the bucket.
+    QElapsedTimer clock; // Time of the last refill.
+};
+
+#endif // TOKENBUCKET_H
@@ -1,16 +1,186 @@
 #include <QCoreApplication> // Includes core application functionalities for non-GUI applications
+#include <QHostAddress> // Includes the QHostAddress class for the bind address
+#include <QDir> // Includes the QDir class for creating the data directory
 #include "BankServer.h"
+#include "ServerConfig.h"
+#include "AdmissionControl.h"
+#include "DataBaseHandler.h"
+#include "IdempotencyCache.h"
+#include "PasswordHasher.h"
+#include "SessionManager.h"
+#include "TlsConfig.h"
 
 int main(int argc, char *argv[])
 {
     // Create the QCoreApplication object, which manages application-wide resources
     QCoreApplication a(argc, argv);
 
+    // Read the settings from the command line, the environment and the configuration file
+    ServerConfig config;
+    config.load(a);
+
+    // Place the files before anything opens them
+    QString dataDir = config.value("data-dir", ".");
+    if (!QDir().mkpath(dataDir))
+    {
+        qCritical() << "Cannot create the data directory" << dataDir;
+        return 1;
+    }
+    DataBaseHandler::setDataDirectory(dataDir);
+    Logger::setDirectory(config.value("log-dir", QDir(dataDir).filePath("Logs")));
+
+    if (config.isSet("log-level"))
+    {
+        bool ok;
+        Logger::Level level = Logger::levelFromString(config.value("log-level"), &ok);
+        if (!ok)
+        {
+            qWarning() << "Invalid log level" << config.value("log-level") << "- using info";
+        }
+        Logger::setLevel(level);
+    }
+
+    if (config.isSet("storage"))
+    {
+        static const QStringList engines = {"json", "memory", "sqlite"};
+        qsizetype engine = engines.indexOf(config.value("storage").trimmed().toLower());
+        if (engine < 0)
+        {
+            qCritical() << "Unknown storage engine" << config.value("storage");
+            return 1;
+        }
+        DataBaseHandler::setStorageEngine(static_cast<DataBaseHandler::StorageKind>(engine));
+    }
+    if (config.isSet("shards"))
+    {
+        DataBaseHandler::setShardCount(config.intValue("shards", 4));
+    }
+    if (config.isSet("password-iterations"))
+    {
+        PasswordHasher::setIterations(config.intValue("password-iterations", 10000));
+    }
+    if (config.isSet("session-timeout"))
+    {
+        SessionManager::getInstance()->setTimeout(config.intValue("session-timeout", 8 * 3600));
+    }
+    if (config.isSet("idempotency-entries") || config.isSet("idempotency-ttl"))
+    {
+        IdempotencyCache::getInstance()->configure(config.intValue("idempotency-entries", 100000),
+                                                   config.intValue("idempotency-ttl", 600));
+    }
+
+    // TLS needs both the certificate and its key
+    if (config.isSet("tls-cert") || config.isSet("tls-key"))
+    {
+        QString error;
+        if (!TlsConfig::load(config.value("tls-cert"), config.value("tls-key"), &error))
+        {
+            qCritical() << "Cannot enable TLS:" << error;
+            return 1;
+        }
+    }
+
+    // Overload limits; unset settings keep the defaults of AdmissionControl
+    AdmissionControl::Limits limits = AdmissionControl::getInstance()->limits();
+    limits.maxConnections = config.intValue("max-connections", limits.maxConnections);
+    if (config.isSet("connection-rate"))
+    {
+        limits.connectionRate = config.doubleValue("connection-rate", limits.connectionRate);
+        limits.connectionBurst = limits.connectionRate * 2; // Allow short bursts of twice the rate
+    }
+    if (config.isSet("account-rate"))
+    {
+        limits.accountRate = config.doubleValue("account-rate", limits.accountRate);
+        limits.accountBurst = limits.accountRate * 2;
+    }
+    limits.maxActiveRequests = config.intValue("max-active-requests", limits.maxActiveRequests);
+    limits.maxQueuedRequests = config.intValue("max-queued-requests", limits.maxQueuedRequests);
+    AdmissionControl::getInstance()->configure(limits);
+
     // Instantiate the BankServer object, which is responsible for handling server operations
     BankServer server;
 
-    // Start the server by calling its StartServer method
-    server.StartServer();
+    // Load the shards now, once the log directory exists and before the server listens,
+    // so the first clients do not wait for the database to load
+    std::shared_ptr<DataBaseHandler> db_handler = DataBaseHandler::getInstance();
+
+    if (config.isSet("checkpoint-interval") || config.isSet("checkpoint-changes"))
+    {
+        db_handler->configureCheckpoint(config.intValue("checkpoint-interval", 5000),
+                                        config.intValue("checkpoint-changes", 100));
+    }
+    if (config.isSet("change-log-entries"))
+    {
+        db_handler->configureChangeLog(config.intValue("change-log-entries", 10000));
+    }
+
+    // Drain and persist on SIGTERM or Ctrl+C instead of dying mid-request
+    server.EnableGracefulShutdown(config.intValue("drain-timeout", 10));
+
+    if (config.isSet("acceptors"))
+    {
+        server.SetAcceptorCount(config.intValue("acceptors", 1));
+    }
+
+    if (config.isSet("idle-timeout"))
+    {
+        server.SetIdleTimeout(config.intValue("idle-timeout", 300));
+    }
+
+    // Set up the replication role before serving any client
+    // The replication stream carries every account, so it is never served without a shared secret
+    if ((config.isSet("follow") || config.isSet("replication-port")) && config.value("replication-secret").isEmpty())
+    {
+        qCritical() << "Replication needs a shared secret (--replication-secret)";
+        return 1;
+    }
+    QByteArray replicationSecret = config.value("replication-secret").toUtf8();
+
+    // Leader and followers derive the same key for the session token digests they exchange
+    if (!replicationSecret.isEmpty())
+    {
+        SessionManager::getInstance()->setDigestKey(QMessageAuthenticationCode::hash("SessionTokenDigest", replicationSecret, QCryptographicHash::Sha256));
+    }
+
+    if (config.isSet("follow"))
+    {
+        QStringList leader = config.value("follow").split(':');
+        server.FollowLeader(leader.value(0), leader.value(1).toUShort(), replicationSecret);
+    }
+    else if (config.isSet("replication-port"))
+    {
+        // Followers are only accepted on the loopback interface unless another address is configured
+        QHostAddress replicationAddress(QHostAddress::LocalHost);
+        if (config.isSet("replication-address") && !replicationAddress.setAddress(config.value("replication-address")))
+        {
+            qCritical() << "Invalid replication address" << config.value("replication-address");
+            return 1;
+        }
+        server.StartReplication(replicationAddress, config.intValue("replication-port", 0), replicationSecret);
+    }
+
+    // Without a configured port the server asks for it, as it always did
+    bool listening;
+    if (config.isSet("port"))
+    {
+        QHostAddress address(QHostAddress::Any);
+        if (config.isSet("bind-address") && !address.setAddress(config.value("bind-address")))
+        {
+            qCritical() << "Invalid bind address" << config.value("bind-address");
+            return 1;
+        }
+        listening = server.StartServer(address, config.intValue("port", 0));
+    }
+    else
+    {
+        listening = server.StartServer();
+    }
+
+    // A supervisor restarts the server; running without a listening socket would hide the problem
+    if (!listening)
+    {
+        return 1;
+    }
 
     // Enter the event loop. This call blocks until the application exits, processing events and handling asynchronous tasks.
     return a.exec();